@@ -0,0 +1,133 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+// EXPLAINER:
+// This benchmark uses JIT assembly instead of UME::SIMD as a code generation layer.
+// The 'y' and 'x' updates of a single RK4 step are generated as one loop that loads
+// both vectors once and stores both results. Buffers do not change between steps,
+// so the kernel is compiled once in 'initialize()' and re-run for every step. The
+// evaluator only generates single precision AVX2/FMA3 code, so double precision
+// tests are reported as disabled.
+
+#pragma once
+
+#include "../utilities/MeasurementHarness.h"
+
+#include "RK4Test.h"
+
+template<typename FLOAT_T>
+class AsmjitTest : public Test {
+public:
+    int problem_size;
+    int step_count;
+    int thread_count;
+
+    // The default class will be called when the JIT evaluator is disabled
+    AsmjitTest(int problem_size, int step_count, int thread_count) :
+        Test(false), problem_size(problem_size), step_count(step_count), thread_count(thread_count) {}
+
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "AsmJIT evaluator (X*X+Y), threads " + std::to_string(thread_count);
+        return retval;
+    }
+};
+
+#if defined (USE_ASMJIT)
+
+#include "../utilities/AsmjitMonadicEvaluator.h"
+
+template<>
+class AsmjitTest<float> : public RK4Test<float> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<float>::value> EVALUATOR_T;
+
+    int thread_count;
+    EVALUATOR_T *evaluator;
+
+    template<typename USER_LAMBDA_T>
+    UME_FORCE_INLINE auto rk4_vectorized(
+        UME::VECTOR::Vector<float> x,
+        UME::VECTOR::Vector<float> y,
+        float dx,
+        USER_LAMBDA_T & f)
+    {
+        float halfdx = dx * 0.5f;
+
+        auto k1 = dx * f(x, y);
+        auto k2 = dx * f(x + halfdx, y + k1 * halfdx);
+        auto k3 = dx * f(x + halfdx, y + k2 * halfdx);
+        auto k4 = dx * f(x + dx, y + k3 * dx);
+
+        return y + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+    }
+
+public:
+    AsmjitTest(int problem_size, int step_count, int thread_count) :
+        RK4Test<float>(problem_size, step_count), thread_count(thread_count), evaluator(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        RK4Test<float>::initialize();
+
+        float timestep = 0.001f;
+        auto userFunction = [](auto X, auto Y) { return X*X + Y; };
+
+        UME::VECTOR::Vector<float> y_vec(this->problem_size, this->y);
+        UME::VECTOR::Vector<float> x_vec(this->problem_size, this->x);
+
+        auto t0 = rk4_vectorized(x_vec, y_vec, timestep, userFunction);
+        auto t1 = x_vec + timestep;
+
+        // Only compile here. Code generation is not part of the measured region.
+        evaluator = new EVALUATOR_T(y_vec, t0, x_vec, t1, thread_count, false);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int i = 0; i < this->step_count; i++) {
+            evaluator->run(thread_count);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete evaluator;
+        evaluator = nullptr;
+        RK4Test<float>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "AsmJIT evaluator (X*X+Y), threads " + std::to_string(thread_count);
+        return retval;
+    }
+};
+
+#endif
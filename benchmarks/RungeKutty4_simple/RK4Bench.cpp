@@ -31,10 +31,13 @@
 #include <umevector/UMEVector.h>
 
 #include <random>
+#include <thread>
+#include <algorithm>
 
 #include "ScalarTest.h"
 #include "UMESimdTest.h"
 #include "UMEVectorTest.h"
+#include "AsmjitTest.h"
 
 int main(int argc, char** argv)
 {
@@ -43,6 +46,7 @@ int main(int argc, char** argv)
     int MAX_SIZE = 10000000;
     int STEP_COUNT = 1000;
     int PROGRESSION = 10;
+    int THREAD_COUNT = std::max(1, (int)std::thread::hardware_concurrency());
 
     for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION)
     {
@@ -70,6 +74,8 @@ int main(int argc, char** argv)
         newCategory->registerTest(new ScalarTest<float>(i, STEP_COUNT));
         newCategory->registerTest(new UMESimdTest<float, DefaultStride<float>::value>(i, STEP_COUNT));
         newCategory->registerTest(new UMEVectorTest<float>(i, STEP_COUNT));
+        newCategory->registerTest(new AsmjitTest<float>(i, STEP_COUNT, 1));
+        newCategory->registerTest(new AsmjitTest<float>(i, STEP_COUNT, THREAD_COUNT));
 
         harness.registerTestCategory(newCategory);
     }
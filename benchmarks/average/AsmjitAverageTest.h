@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#pragma once
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+#include "AverageTest.h"
+
+#include <umevector/UMEVector.h>
+
+template<typename FLOAT_T>
+class AsmjitAverageTest : public AverageTest<FLOAT_T> {
+public:
+    // The default class will be called when the JIT evaluator is disabled. Only
+    // single precision is supported by the evaluator.
+    AsmjitAverageTest(int problem_size, bool) : AverageTest<FLOAT_T>(false, problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "AsmJIT evaluator, " + ScalarToString<FLOAT_T>::value() + " " + std::to_string(this->problem_size);
+        return retval;
+    }
+};
+
+#if defined(USE_ASMJIT)
+
+#include "../utilities/AsmjitMonadicEvaluator.h"
+
+template<>
+class AsmjitAverageTest<float> : public AverageTest<float> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<float>::value> EVALUATOR_T;
+
+    bool deterministic;
+    float sum;
+    // Compiled in 'initialize()' so that JIT compilation is not measured.
+    EVALUATOR_T *eval;
+
+public:
+    AsmjitAverageTest(int problem_size, bool deterministic) :
+        AverageTest<float>(true, problem_size), deterministic(deterministic), sum(0.0f), eval(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize()
+    {
+        AverageTest<float>::initialize();
+
+        UME::VECTOR::Vector<float> x_vec(this->problem_size, this->x);
+        auto t0 = x_vec.hadd();
+        eval = new EVALUATOR_T(&sum, t0, 8, deterministic, 1, false);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        eval->run();
+        this->calculated_average = sum/(float)this->problem_size;
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        delete eval;
+        eval = nullptr;
+        AverageTest<float>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "AsmJIT evaluator";
+        if (deterministic) retval += " (deterministic)";
+        retval += ", " + ScalarToString<float>::value() + " " + std::to_string(this->problem_size);
+        return retval;
+    }
+};
+
+#endif
@@ -42,12 +42,8 @@ protected:
 
     FLOAT_T *x;     // The input data.    
     FLOAT_T calculated_average; // The average should be stored here.
-public:
-    AverageTest(bool test_enabled, int problem_size) : Test(test_enabled), problem_size(problem_size) {}
-
-    UME_NEVER_INLINE virtual void initialize() {
-        x = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(problem_size*sizeof(FLOAT_T), 64);
 
+    void fill_random() {
         // Initialize arrays with random data
         for(int i = 0; i < problem_size; i++)
         {
@@ -56,6 +52,15 @@ public:
         }
     }
 
+public:
+    AverageTest(bool test_enabled, int problem_size) : Test(test_enabled), problem_size(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        x = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(problem_size*sizeof(FLOAT_T), 64);
+
+        fill_random();
+    }
+
     UME_NEVER_INLINE virtual void benchmarked_code() = 0;
 
     UME_NEVER_INLINE virtual void cleanup() {
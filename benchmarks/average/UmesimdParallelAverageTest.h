@@ -0,0 +1,304 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+#include "../utilities/UMEThreadPinning.h"
+
+#include "AverageTest.h"
+
+#include <umesimd/UMESimd.h>
+
+// Multi-threaded sum of an array. The array is split into blocks of BLOCK elements
+// and every thread owns a contiguous range of blocks. Threads come from the OpenMP
+// runtime and should be pinned by the caller (see 'ThreadPinning'); 'first_touch'
+// writes every block from its owner, so that on NUMA systems pages are allocated on
+// the node of the thread that later reads them. Without OpenMP a single thread is used.
+//
+// Two modes are available:
+//  - fast: every thread accumulates its range in SIMD registers and partial sums of
+//    threads are added in thread order. The result depends on the thread count.
+//  - reproducible: every block is summed separately with a fixed SIMD schedule and
+//    block sums are merged with a pairwise tree over block indices. Neither depends
+//    on the thread count, so the result is bitwise identical for any thread count.
+template<typename FLOAT_T, int SIMD_STRIDE>
+class UMESimdParallelSum {
+public:
+    static const int BLOCK = 4096;
+    static_assert(BLOCK % (4 * SIMD_STRIDE) == 0, "Block has to be a multiple of the unrolled SIMD stride");
+
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, SIMD_STRIDE> FLOAT_VEC_T;
+
+    int threadCount;
+    std::vector<double> partialSums;    // per thread
+    std::vector<double> blockSums;      // per block
+
+    // Blocks [first, last) are owned by thread 'threadId'
+    static UME_FORCE_INLINE void block_range(int threadId, int threads, int blocks, int & first, int & last) {
+        first = (int)((long long)blocks * threadId / threads);
+        last = (int)((long long)blocks * (threadId + 1) / threads);
+    }
+
+    // Sum of 'count' elements, starting at an aligned address. Four accumulators
+    // hide the latency of additions, the order of all operations is fixed.
+    static UME_FORCE_INLINE FLOAT_VEC_T vector_sum(FLOAT_T const *x, int count, FLOAT_T & remainder) {
+        const int UNROLL = 4 * SIMD_STRIDE;
+        FLOAT_VEC_T acc0(FLOAT_T(0)), acc1(FLOAT_T(0)), acc2(FLOAT_T(0)), acc3(FLOAT_T(0));
+        FLOAT_VEC_T t0, t1, t2, t3;
+
+        int LOOP_PEEL_OFFSET = (count / UNROLL) * UNROLL;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += UNROLL) {
+            t0.loada(&x[i]);
+            t1.loada(&x[i + SIMD_STRIDE]);
+            t2.loada(&x[i + 2 * SIMD_STRIDE]);
+            t3.loada(&x[i + 3 * SIMD_STRIDE]);
+            acc0.adda(t0);
+            acc1.adda(t1);
+            acc2.adda(t2);
+            acc3.adda(t3);
+        }
+
+        int VEC_PEEL_OFFSET = (count / SIMD_STRIDE) * SIMD_STRIDE;
+        for (int i = LOOP_PEEL_OFFSET; i < VEC_PEEL_OFFSET; i += SIMD_STRIDE) {
+            t0.loada(&x[i]);
+            acc0.adda(t0);
+        }
+
+        // Calculating loop reminder
+        for (int i = VEC_PEEL_OFFSET; i < count; i++) {
+            remainder += x[i];
+        }
+
+        return (acc0 + acc1) + (acc2 + acc3);
+    }
+
+    static UME_FORCE_INLINE FLOAT_T block_sum(FLOAT_T const *x, int count) {
+        FLOAT_T remainder = FLOAT_T(0);
+        FLOAT_VEC_T acc = vector_sum(x, count, remainder);
+        return acc.hadd() + remainder;
+    }
+
+    // Pairwise reduction: at level 'width', sums[i] += sums[i + width] for i multiple of 2 * width
+    static double tree_sum(double *sums, int count) {
+        for (int width = 1; width < count; width *= 2) {
+            for (int i = 0; i + width < count; i += 2 * width) {
+                sums[i] += sums[i + width];
+            }
+        }
+        return count > 0 ? sums[0] : 0.0;
+    }
+
+    void thread_sum(int threadId, FLOAT_T const *x, int count, bool reproducible) {
+        int blocks = (count + BLOCK - 1) / BLOCK;
+        int first, last;
+        block_range(threadId, threadCount, blocks, first, last);
+
+        if (reproducible) {
+            for (int b = first; b < last; b++) {
+                int offset = b * BLOCK;
+                blockSums[b] = double(block_sum(&x[offset], std::min(BLOCK, count - offset)));
+            }
+        }
+        else {
+            int begin = first * BLOCK;
+            int end = std::min(last * BLOCK, count);
+            FLOAT_T remainder = FLOAT_T(0);
+            FLOAT_VEC_T acc(FLOAT_T(0));
+            if (end > begin) acc = vector_sum(&x[begin], end - begin, remainder);
+            partialSums[threadId] = double(acc.hadd() + remainder);
+        }
+    }
+
+public:
+    // Number of threads actually used, when 'threads' are requested
+    static int effective_threads(int threads) {
+#if defined(_OPENMP)
+        return std::max(1, threads);
+#else
+        (void)threads;
+        return 1;
+#endif
+    }
+
+    UMESimdParallelSum(int threads, int max_count) {
+        threadCount = effective_threads(threads);
+        partialSums.resize(threadCount);
+        blockSums.resize((max_count + BLOCK - 1) / BLOCK);
+    }
+
+    int thread_count() const { return threadCount; }
+
+    // Writes zeros to the blocks of every thread, from the owning thread.
+    void first_touch(FLOAT_T *x, int count) {
+        int blocks = (count + BLOCK - 1) / BLOCK;
+#if defined(_OPENMP)
+        #pragma omp parallel num_threads(threadCount)
+#endif
+        {
+#if defined(_OPENMP)
+            int threadId = omp_get_thread_num();
+#else
+            int threadId = 0;
+#endif
+            int first, last;
+            block_range(threadId, threadCount, blocks, first, last);
+            int begin = first * BLOCK;
+            int end = std::min(last * BLOCK, count);
+            if (end > begin) std::memset(&x[begin], 0, (end - begin) * sizeof(FLOAT_T));
+        }
+    }
+
+    double sum(FLOAT_T const *x, int count, bool reproducible) {
+        if (threadCount == 1) {
+            thread_sum(0, x, count, reproducible);
+        }
+        else {
+#if defined(_OPENMP)
+            #pragma omp parallel num_threads(threadCount)
+            {
+                thread_sum(omp_get_thread_num(), x, count, reproducible);
+            }
+#endif
+        }
+
+        if (reproducible) {
+            return tree_sum(&blockSums[0], (count + BLOCK - 1) / BLOCK);
+        }
+
+        double retval = 0.0;
+        for (int i = 0; i < threadCount; i++) retval += partialSums[i];
+        return retval;
+    }
+};
+
+// Average computed by 'threads' threads. The bandwidth of the measured runs is
+// reported as a test metric. With verification enabled, results of the reproducible
+// mode are also compared bitwise with a single-threaded evaluation. The outcome is
+// reported as the 'bitwise_equal' metric and any difference is added to the error.
+template<typename FLOAT_T, int SIMD_STRIDE>
+class UmesimdParallelAverageTest : public AverageTest<FLOAT_T> {
+private:
+    typedef UMESimdParallelSum<FLOAT_T, SIMD_STRIDE> KERNEL_T;
+
+    int threads;
+    bool reproducible;
+    KERNEL_T *kernel;
+    ThreadPinning *pinning;
+    int bitwise_equal;      // Result of the reproducibility check, -1 if not checked
+
+public:
+    UmesimdParallelAverageTest(int problem_size, int threads, bool reproducible) :
+        AverageTest<FLOAT_T>(true, problem_size), threads(threads), reproducible(reproducible),
+        kernel(nullptr), pinning(nullptr), bitwise_equal(-1) {}
+
+    // Threads keep their CPUs, and so the NUMA nodes of their blocks, for all iterations
+    UME_NEVER_INLINE virtual void test_init() {
+        pinning = new ThreadPinning(KERNEL_T::effective_threads(threads));
+    }
+
+    UME_NEVER_INLINE virtual void test_cleanup() {
+        delete pinning;
+        pinning = nullptr;
+    }
+
+    UME_NEVER_INLINE virtual void initialize() {
+        kernel = new KERNEL_T(threads, this->problem_size);
+
+        // Page aligned, so that blocks of different threads share as few pages as possible
+        this->x = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(this->problem_size*sizeof(FLOAT_T), 4096);
+        kernel->first_touch(this->x, this->problem_size);
+        this->fill_random();
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        double sum = kernel->sum(this->x, this->problem_size, reproducible);
+        this->calculated_average = FLOAT_T(sum / double(this->problem_size));
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        AverageTest<FLOAT_T>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        AverageTest<FLOAT_T>::verify();
+
+        if (reproducible) {
+            KERNEL_T serial(1, this->problem_size);
+            FLOAT_T serial_average = FLOAT_T(serial.sum(this->x, this->problem_size, true) / double(this->problem_size));
+            bool equal = std::memcmp(&serial_average, &this->calculated_average, sizeof(FLOAT_T)) == 0;
+            bitwise_equal = equal ? 1 : 0;
+
+            // A difference from the single-threaded result is an error of the test
+            if (!equal) {
+                double difference = std::abs(double(serial_average) - double(this->calculated_average));
+                this->error_norm_bignum = this->error_norm_bignum.ToDouble() + difference;
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+
+        retval += "UME::SIMD parallel<" + ScalarToString<FLOAT_T>::value() + ", " + std::to_string(SIMD_STRIDE) + "> " +
+            std::to_string(this->problem_size) +
+            " (threads: " + std::to_string(KERNEL_T::effective_threads(threads)) +
+            (reproducible ? ", reproducible" : ", fast");
+
+        retval += ")";
+        return retval;
+    }
+
+    // Elapsed time is given in ns, so bytes per elapsed time is the bandwidth in GB/s
+    UME_NEVER_INLINE virtual Test::TestMetrics get_test_metrics() {
+        Test::TestMetrics metrics;
+        double elapsed = this->stats.getAverage();
+        if (elapsed > 0.0) {
+            double bytes = double(this->problem_size) * sizeof(FLOAT_T);
+            metrics.push_back(std::make_pair(std::string("GB/s"), bytes / elapsed));
+        }
+        if (bitwise_equal >= 0) {
+            metrics.push_back(std::make_pair(std::string("bitwise_equal"), double(bitwise_equal)));
+        }
+        return metrics;
+    }
+};
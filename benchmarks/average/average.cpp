@@ -35,6 +35,8 @@
 #include <time.h>
 #include <stdlib.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <umesimd/utilities/ignore_warnings_push.h>
 #include <umesimd/utilities/ignore_warnings_unused_but_set.h>
@@ -45,6 +47,8 @@
 #include "AVX512IntrinsicsAverageTest.h"
 #include "UmesimdAverageTest.h"
 #include "UmevectorAverageTest.h"
+#include "AsmjitAverageTest.h"
+#include "UmesimdParallelAverageTest.h"
 
 int main(int argc, char **argv)
 {
@@ -64,7 +68,11 @@ int main(int argc, char **argv)
         "All timing results in nanoseconds. \n"
         "Speedup calculated with scalar floating point result as reference.\n\n"
         "SIMD version uses following operations: \n"
-        " ZERO-CONSTR, SET-CONSTR, LOAD, ADDA, STORE\n";
+        " ZERO-CONSTR, SET-CONSTR, LOAD, ADDA, STORE\n\n"
+        "[Compile with OpenMP (e.g. make USE_OPENMP=ON) to enable multi-threaded reductions]\n"
+        "Category 'average_parallel' reports bandwidth of multi-threaded reductions\n"
+        "with NUMA-local (first touch) data, in fast and reproducible mode.\n"
+        "Reproducible results do not depend on the thread count (checked with -v).\n";
 
     for(int i = MIN_PROBLEM_SIZE; i < MAX_PROBLEM_SIZE; i*=PROGRESSION) {
         std::string categoryName = std::string("average");
@@ -82,6 +90,8 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UmesimdAverageTest<float, 16>(i+PROBLEM_SIZE_OFFSET));
         newCategory->registerTest(new UmesimdAverageTest<float, 32>(i+PROBLEM_SIZE_OFFSET));
         newCategory->registerTest(new UmevectorAverageTest<float>(i+PROBLEM_SIZE_OFFSET));
+        newCategory->registerTest(new AsmjitAverageTest<float>(i+PROBLEM_SIZE_OFFSET, false));
+        newCategory->registerTest(new AsmjitAverageTest<float>(i+PROBLEM_SIZE_OFFSET, true));
 
         harness.registerTestCategory(newCategory);
     }
@@ -100,10 +110,53 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UmesimdAverageTest<double, 8>(i+PROBLEM_SIZE_OFFSET));
         newCategory->registerTest(new UmesimdAverageTest<double, 16>(i+PROBLEM_SIZE_OFFSET));
         newCategory->registerTest(new UmevectorAverageTest<double>(i+PROBLEM_SIZE_OFFSET));
+        newCategory->registerTest(new AsmjitAverageTest<double>(i+PROBLEM_SIZE_OFFSET, false));
 
         harness.registerTestCategory(newCategory);
     }
 
+    // Thread counts: powers of 2 up to the number of hardware threads, and that number
+    std::vector<int> threadCounts;
+#if defined(_OPENMP)
+    int HW_THREADS = std::max(1, (int)std::thread::hardware_concurrency());
+#else
+    int HW_THREADS = 1;
+#endif
+    for (int t = 1; t < HW_THREADS; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(HW_THREADS);
+
+    // Large arrays only, so that the reduction is memory bound
+    const int PARALLEL_ITERATIONS = 3;
+    for (int i : { 1 << 24, 1 << 28 }) {
+        std::string categoryName = std::string("average_parallel");
+        TestCategory *newCategory = new TestCategory(categoryName);
+        newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 32));
+        newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), i+PROBLEM_SIZE_OFFSET));
+
+        newCategory->registerTest(new UmesimdAverageTest<float, 8>(i+PROBLEM_SIZE_OFFSET));
+        for (int threads : threadCounts) {
+            newCategory->registerTest(new UmesimdParallelAverageTest<float, 8>(i+PROBLEM_SIZE_OFFSET, threads, false));
+            newCategory->registerTest(new UmesimdParallelAverageTest<float, 8>(i+PROBLEM_SIZE_OFFSET, threads, true));
+        }
+
+        harness.registerTestCategory(newCategory, PARALLEL_ITERATIONS);
+    }
+
+    for (int i : { 1 << 24, 1 << 27 }) {
+        std::string categoryName = std::string("average_parallel");
+        TestCategory *newCategory = new TestCategory(categoryName);
+        newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 64));
+        newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), i+PROBLEM_SIZE_OFFSET));
+
+        newCategory->registerTest(new UmesimdAverageTest<double, 4>(i+PROBLEM_SIZE_OFFSET));
+        for (int threads : threadCounts) {
+            newCategory->registerTest(new UmesimdParallelAverageTest<double, 4>(i+PROBLEM_SIZE_OFFSET, threads, false));
+            newCategory->registerTest(new UmesimdParallelAverageTest<double, 4>(i+PROBLEM_SIZE_OFFSET, threads, true));
+        }
+
+        harness.registerTestCategory(newCategory, PARALLEL_ITERATIONS);
+    }
+
     harness.runTests(ITERATIONS);
 
     return 0;
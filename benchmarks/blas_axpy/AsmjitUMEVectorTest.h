@@ -129,6 +129,75 @@ public:
     }
 };
 
+// The expression is compiled once in 'initialize()', so only the evaluation is
+// measured. Evaluation is split into chunks, processed by 'thread_count' threads.
+template<typename FLOAT_T>
+class UMEVectorAsmjitParallelChainedTest : public AxpyChainedTest<FLOAT_T> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<FLOAT_T>::value> EVALUATOR_T;
+
+    int thread_count;
+    EVALUATOR_T *evaluator;
+
+public:
+    UMEVectorAsmjitParallelChainedTest(int problem_size, int thread_count) :
+        AxpyChainedTest<FLOAT_T>(problem_size), thread_count(thread_count), evaluator(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize()
+    {
+        AxpyChainedTest<FLOAT_T>::initialize();
+
+        UME::VECTOR::Vector<FLOAT_T> x0_vec(this->problem_size, this->x0);
+        UME::VECTOR::Vector<FLOAT_T> x1_vec(this->problem_size, this->x1);
+        UME::VECTOR::Vector<FLOAT_T> x2_vec(this->problem_size, this->x2);
+        UME::VECTOR::Vector<FLOAT_T> x3_vec(this->problem_size, this->x3);
+        UME::VECTOR::Vector<FLOAT_T> x4_vec(this->problem_size, this->x4);
+        UME::VECTOR::Vector<FLOAT_T> x5_vec(this->problem_size, this->x5);
+        UME::VECTOR::Vector<FLOAT_T> x6_vec(this->problem_size, this->x6);
+        UME::VECTOR::Vector<FLOAT_T> x7_vec(this->problem_size, this->x7);
+        UME::VECTOR::Vector<FLOAT_T> x8_vec(this->problem_size, this->x8);
+        UME::VECTOR::Vector<FLOAT_T> x9_vec(this->problem_size, this->x9);
+        UME::VECTOR::Vector<FLOAT_T> y_vec(this->problem_size, this->y);
+
+        UME::VECTOR::Scalar<FLOAT_T> alpha0(this->alpha[0]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha1(this->alpha[1]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha2(this->alpha[2]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha3(this->alpha[3]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha4(this->alpha[4]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha5(this->alpha[5]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha6(this->alpha[6]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha7(this->alpha[7]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha8(this->alpha[8]);
+        UME::VECTOR::Scalar<FLOAT_T> alpha9(this->alpha[9]);
+
+        auto t0 = y_vec + alpha0*x0_vec + alpha1*x1_vec +
+            alpha2*x2_vec + alpha3*x3_vec +
+            alpha4*x4_vec + alpha5*x5_vec +
+            alpha6*x6_vec + alpha7*x7_vec +
+            alpha8*x8_vec + alpha9*x9_vec;
+
+        // Compile only, the destination has to stay unmodified until measurement.
+        evaluator = new EVALUATOR_T(y_vec, t0, thread_count, false);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        evaluator->run(thread_count);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        delete evaluator;
+        AxpyChainedTest<FLOAT_T>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "AsmJIT evaluator chained, precompiled (threads: " + std::to_string(thread_count) + ")";
+        return retval;
+    }
+};
+
 #else
 
 template<typename FLOAT_T>
@@ -168,5 +237,25 @@ public:
     }
 };
 
+template<typename FLOAT_T>
+class UMEVectorAsmjitParallelChainedTest : public Test {
+public:
+    int problem_size;
+    int thread_count;
+
+    UMEVectorAsmjitParallelChainedTest(int problem_size, int thread_count) :
+        Test(false), problem_size(problem_size), thread_count(thread_count) {}
+
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "Asmjit evaluator chained, precompiled (threads: " + std::to_string(thread_count) + ")";
+        return retval;
+    }
+};
+
 
 #endif
\ No newline at end of file
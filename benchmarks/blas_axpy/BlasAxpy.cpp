@@ -35,6 +35,8 @@
 #include <time.h>
 #include <stdlib.h>
 #include <string>
+#include <thread>
+#include <algorithm>
 
 #include <umesimd/UMESimd.h>
 
@@ -44,6 +46,7 @@
 #include "ScalarTest.h"
 #include "BlasTest.h"
 #include "UMESimdTest.h"
+#include "UMESimdReducedTest.h"
 #include "UMEVectorTest.h"
 #include "AsmjitTest.h"
 #include "AsmjitUMEVectorTest.h"
@@ -54,11 +57,14 @@ int main(int argc, char **argv)
     int MAX_SIZE = 268435456;
     int ITERATIONS = 3;
     int PROGRESSION = 2;
+    // Chained AXPY is bandwidth bound, so it is also measured using all hardware threads.
+    int THREAD_COUNT = std::max(1, (int)std::thread::hardware_concurrency());
 
     BenchmarkHarness harness(argc, argv);
 
     std::cout <<
         "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
+        "[Compile with F16C/AVX2 (e.g. -march=native) for hardware fp16/bf16 conversion, scalar conversion is used otherwise]\n"
         "\n"
         "This benchmark measures execution of Y = a * X + Y (AXPY) kernel.\n"
         "Two modes are being measured:\n"
@@ -68,7 +74,9 @@ int main(int argc, char **argv)
         "implementation in mind. However what is ommited is the ability to exploit\n"
         "data locality in context of more than a single BLAS call.\n"
         "UME::VECTOR version shows that treatment of vector programs using\n"
-        "expressions instead of kernels can give additional performance boost.\n\n";
+        "expressions instead of kernels can give additional performance boost.\n"
+        "UME::SIMD fused version applies all updates to cache-sized tiles of Y and\n"
+        "reports modelled memory traffic next to the one of 10 separate passes.\n\n";
 
     // Single execution (single precision)
     for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
@@ -86,6 +94,8 @@ int main(int argc, char **argv)
         //newCategory->registerTest(new UMESimdSingleTest<float, 2>(i));
         //newCategory->registerTest(new UMESimdSingleTest<float, 4>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 8>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<float16_t, 8>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<bfloat16_t, 8>(i));
         //newCategory->registerTest(new UMESimdSingleTest<float, 16>(i));
         //newCategory->registerTest(new UMESimdSingleTest<float, 32>(i));
 
@@ -102,12 +112,15 @@ int main(int argc, char **argv)
         newCategory->registerTest(new ScalarChainedTest<float>(i));
         //harness.registerTest(new UMEAsmjitChainedTest<float>(i));
         //newCategory->registerTest(new UMEVectorAsmjitChainedTest<float>(i));
+        newCategory->registerTest(new UMEVectorAsmjitParallelChainedTest<float>(i, 1));
+        newCategory->registerTest(new UMEVectorAsmjitParallelChainedTest<float>(i, THREAD_COUNT));
         newCategory->registerTest(new BlasChainedTest<float>(i));
         newCategory->registerTest(new UMEVectorChainedTest<float>(i));
         //newCategory->registerTest(new UMESimdChainedTest<float, 1>(i));
         //newCategory->registerTest(new UMESimdChainedTest<float, 2>(i));
         //newCategory->registerTest(new UMESimdChainedTest<float, 4>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 8>(i));
+        newCategory->registerTest(new UMESimdFusedChainedTest<float, 8>(i));
         //newCategory->registerTest(new UMESimdChainedTest<float, 16>(i));
         //newCategory->registerTest(new UMESimdChainedTest<float, 32>(i));
 
@@ -146,6 +159,7 @@ int main(int argc, char **argv)
         //newCategory->registerTest(new UMESimdChainedTest<double, 1>(i));
         //newCategory->registerTest(new UMESimdChainedTest<double, 2>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 4>(i));
+        newCategory->registerTest(new UMESimdFusedChainedTest<double, 4>(i));
         //newCategory->registerTest(new UMESimdChainedTest<double, 8>(i));
         //newCategory->registerTest(new UMESimdChainedTest<double, 16>(i));
 
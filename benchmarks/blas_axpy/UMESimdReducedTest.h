@@ -0,0 +1,117 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#pragma once
+
+#include <algorithm>
+
+#include <umesimd/UMESimd.h>
+
+#include "AxpyTest.h"
+#include "../utilities/UMEReducedPrecision.h"
+
+// AXPY on vectors stored in 16-bit precision (STORAGE_T: float16_t or bfloat16_t).
+// Tiles of x and y are converted to 'float', updated in single precision and
+// rounded back to storage precision.
+template<typename STORAGE_T, int STRIDE>
+class UMESimdReducedSingleTest : public AxpySingleTest<float> {
+private:
+    static const int TILE = REDUCED_PRECISION_TILE;
+    static_assert(TILE % STRIDE == 0, "TILE has to be a multiple of STRIDE");
+
+    typedef ReducedPrecision<STORAGE_T> CONVERT_T;
+
+    STORAGE_T *x_storage, *y_storage;
+    float *x_tile, *y_tile;
+
+public:
+    UMESimdReducedSingleTest(int problem_size) : AxpySingleTest<float>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize()
+    {
+        AxpySingleTest<float>::initialize();
+
+        x_storage = (STORAGE_T *)UME::DynamicMemory::AlignedMalloc(sizeof(STORAGE_T)*problem_size, OPTIMAL_ALIGNMENT);
+        y_storage = (STORAGE_T *)UME::DynamicMemory::AlignedMalloc(sizeof(STORAGE_T)*problem_size, OPTIMAL_ALIGNMENT);
+        x_tile = (float *)UME::DynamicMemory::AlignedMalloc(sizeof(float)*TILE, OPTIMAL_ALIGNMENT);
+        y_tile = (float *)UME::DynamicMemory::AlignedMalloc(sizeof(float)*TILE, OPTIMAL_ALIGNMENT);
+
+        CONVERT_T::convert_from_float(problem_size, x, x_storage);
+        CONVERT_T::convert_from_float(problem_size, y, y_storage);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::SIMD::SIMDVec<float, STRIDE> x_vec, y_vec;
+
+        for (int i = 0; i < problem_size; i += TILE) {
+            int length = std::min(TILE, problem_size - i);
+            int LOOP_PEEL_OFFSET = (length / STRIDE) * STRIDE;
+
+            CONVERT_T::convert_to_float(length, &x_storage[i], x_tile);
+            CONVERT_T::convert_to_float(length, &y_storage[i], y_tile);
+
+            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+                x_vec.loada(&x_tile[j]);
+                y_vec.loada(&y_tile[j]);
+                y_vec = alpha * x_vec + y_vec;
+                y_vec.storea(&y_tile[j]);
+            }
+
+            // Use scalar code to handle the reminder of elements.
+            for (int j = LOOP_PEEL_OFFSET; j < length; j++) {
+                y_tile[j] += alpha * x_tile[j];
+            }
+
+            CONVERT_T::convert_from_float(length, y_tile, &y_storage[i]);
+        }
+    }
+
+    // Expose the result to 'verify'.
+    UME_NEVER_INLINE virtual void optional_cleanup()
+    {
+        CONVERT_T::convert_to_float(problem_size, y_storage, y);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        UME::DynamicMemory::AlignedFree(x_storage);
+        UME::DynamicMemory::AlignedFree(y_storage);
+        UME::DynamicMemory::AlignedFree(x_tile);
+        UME::DynamicMemory::AlignedFree(y_tile);
+        AxpySingleTest<float>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD single, " + CONVERT_T::name() + " storage (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
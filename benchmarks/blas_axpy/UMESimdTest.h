@@ -33,6 +33,7 @@
 #include <umesimd/UMESimd.h>
 
 #include "AxpyTest.h"
+#include "../utilities/UMESimdFusedAxpy.h"
 
 template<typename FLOAT_T, int STRIDE>
 class UMESimdSingleTest : public AxpySingleTest<FLOAT_T> {
@@ -120,3 +121,46 @@ public:
         return retval;
     }
 };
+
+// Chained AXPY evaluated with the fused, cache-tiled routine. The modelled memory
+// traffic of the fused and of the naive (10 separate passes) evaluation, and the
+// bandwidth achieved for the fused traffic, are reported as test metrics.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdFusedChainedTest : public AxpyChainedTest<FLOAT_T> {
+private:
+    typedef UMESimdFusedAxpy<FLOAT_T, STRIDE> FUSED_T;
+
+public:
+    UMESimdFusedChainedTest(int problem_size) : AxpyChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        FLOAT_T const *x[10] = {
+            this->x0, this->x1, this->x2, this->x3, this->x4,
+            this->x5, this->x6, this->x7, this->x8, this->x9 };
+
+        FUSED_T::apply(this->problem_size, 10, this->alpha, x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD fused tiled chained (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+
+    // Elapsed time is given in ns, so bytes per elapsed time is the bandwidth in GB/s
+    UME_NEVER_INLINE virtual Test::TestMetrics get_test_metrics()
+    {
+        double bytes = double(FUSED_T::bytes_moved(this->problem_size, 10));
+
+        Test::TestMetrics metrics;
+        metrics.push_back(std::make_pair(std::string("bytes_moved"), bytes));
+        metrics.push_back(std::make_pair(std::string("naive_bytes_moved"), double(FUSED_T::naive_bytes_moved(this->problem_size, 10))));
+
+        double elapsed = this->stats.getAverage();
+        if (elapsed > 0.0) {
+            metrics.push_back(std::make_pair(std::string("GB/s"), bytes / elapsed));
+        }
+        return metrics;
+    }
+};
@@ -0,0 +1,212 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef BATCHED_BENCH_H_
+#define BATCHED_BENCH_H_
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+#include "../utilities/ttmath/ttmath/ttmath.h"
+
+// Batches are allocated with a padding, so that SIMD kernels with any stride up to
+// MAX_BATCH_STRIDE can process whole groups of matrices without a remainder loop.
+static const int MAX_BATCH_STRIDE = 32;
+
+inline int padded_batch_size(int batch_size) {
+    return ((batch_size + MAX_BATCH_STRIDE - 1) / MAX_BATCH_STRIDE) * MAX_BATCH_STRIDE;
+}
+
+// Convert a batch of objects, each having ELEMENTS elements stored contiguously
+// ('array of structures'), into 'interleaved' layout: element 'e' of STRIDE
+// consecutive objects is stored contiguously, so a single SIMD vector holds
+// the same element of STRIDE objects.
+//
+//   AoS:         src[object * ELEMENTS + e]
+//   interleaved: dst[(object / STRIDE) * ELEMENTS * STRIDE + e * STRIDE + object % STRIDE]
+template<typename FLOAT_T, int ELEMENTS, int STRIDE>
+void aos_to_interleaved(int count, FLOAT_T const *src, FLOAT_T *dst) {
+    for (int m = 0; m < count; m++) {
+        FLOAT_T *group = &dst[(m / STRIDE) * ELEMENTS * STRIDE + m % STRIDE];
+        for (int e = 0; e < ELEMENTS; e++) {
+            group[e * STRIDE] = src[m * ELEMENTS + e];
+        }
+    }
+}
+
+template<typename FLOAT_T, int ELEMENTS, int STRIDE>
+void interleaved_to_aos(int count, FLOAT_T const *src, FLOAT_T *dst) {
+    for (int m = 0; m < count; m++) {
+        FLOAT_T const *group = &src[(m / STRIDE) * ELEMENTS * STRIDE + m % STRIDE];
+        for (int e = 0; e < ELEMENTS; e++) {
+            dst[m * ELEMENTS + e] = group[e * STRIDE];
+        }
+    }
+}
+
+// Batch of 'batch_size' independent C = A * B products of DIMxDIM row-major matrices.
+// Input and output are stored as an array of matrices. Tests using other layouts
+// convert the data in 'initialize'/'optional_cleanup', outside of the measured code.
+template<typename FLOAT_T, int DIM>
+class BatchedGemmTest : public Test {
+protected:
+    static const int OPTIMAL_ALIGNMENT = 64;
+    static const int MATRIX_SIZE = DIM * DIM;
+    typedef ttmath::Big<2, 2> BigFloat;
+
+    FLOAT_T *A, *B, *C;
+
+    int batch_size;
+
+public:
+    BatchedGemmTest(int batch_size) : Test(true), batch_size(batch_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        int padded = padded_batch_size(batch_size);
+        A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        B = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        C = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data. Padding is zeroed.
+        for (int i = 0; i < padded * MATRIX_SIZE; i++) {
+            bool valid = i < batch_size * MATRIX_SIZE;
+            // Generate random numbers in range (0.0;1.0)
+            A[i] = valid ? static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) : FLOAT_T(0.0f);
+            B[i] = valid ? static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) : FLOAT_T(0.0f);
+            C[i] = FLOAT_T(0.0f);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(A);
+        UME::DynamicMemory::AlignedFree(B);
+        UME::DynamicMemory::AlignedFree(C);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        BigFloat max_err = 0;
+        BigFloat norm = 0;
+
+        for (int m = 0; m < batch_size; m++) {
+            FLOAT_T const *a = &A[m * MATRIX_SIZE];
+            FLOAT_T const *b = &B[m * MATRIX_SIZE];
+            FLOAT_T const *c = &C[m * MATRIX_SIZE];
+            for (int i = 0; i < DIM; i++) {
+                for (int j = 0; j < DIM; j++) {
+                    BigFloat expected = 0;
+                    for (int k = 0; k < DIM; k++) {
+                        expected += BigFloat(a[i*DIM + k]) * BigFloat(b[k*DIM + j]);
+                    }
+                    BigFloat diff = ttmath::Abs(BigFloat(c[i*DIM + j]) - expected);
+                    max_err = max_err > diff ? max_err : diff;
+                    BigFloat c_abs = ttmath::Abs(expected);
+                    norm = c_abs > norm ? c_abs : norm;
+                }
+            }
+        }
+
+        error_norm_bignum = max_err / norm;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+// Batch of 'batch_size' independent y = A * x products, with DIMxDIM row-major
+// matrices and DIM element vectors.
+template<typename FLOAT_T, int DIM>
+class BatchedGemvTest : public Test {
+protected:
+    static const int OPTIMAL_ALIGNMENT = 64;
+    static const int MATRIX_SIZE = DIM * DIM;
+    typedef ttmath::Big<2, 2> BigFloat;
+
+    FLOAT_T *A, *x, *y;
+
+    int batch_size;
+
+public:
+    BatchedGemvTest(int batch_size) : Test(true), batch_size(batch_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        int padded = padded_batch_size(batch_size);
+        A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * DIM * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * DIM * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data. Padding is zeroed.
+        for (int i = 0; i < padded * MATRIX_SIZE; i++) {
+            bool valid = i < batch_size * MATRIX_SIZE;
+            // Generate random numbers in range (0.0;1.0)
+            A[i] = valid ? static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) : FLOAT_T(0.0f);
+        }
+        for (int i = 0; i < padded * DIM; i++) {
+            bool valid = i < batch_size * DIM;
+            x[i] = valid ? static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) : FLOAT_T(0.0f);
+            y[i] = FLOAT_T(0.0f);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(A);
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        BigFloat max_err = 0;
+        BigFloat norm = 0;
+
+        for (int m = 0; m < batch_size; m++) {
+            for (int i = 0; i < DIM; i++) {
+                BigFloat expected = 0;
+                for (int k = 0; k < DIM; k++) {
+                    expected += BigFloat(A[m*MATRIX_SIZE + i*DIM + k]) * BigFloat(x[m*DIM + k]);
+                }
+                BigFloat diff = ttmath::Abs(BigFloat(y[m*DIM + i]) - expected);
+                max_err = max_err > diff ? max_err : diff;
+                BigFloat y_abs = ttmath::Abs(expected);
+                norm = y_abs > norm ? y_abs : norm;
+            }
+        }
+
+        error_norm_bignum = max_err / norm;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+#endif
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#include <iostream>
+#include <memory>
+
+#include <cmath>
+#include <time.h>
+#include <stdlib.h>
+#include <string>
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/TimingStatistics.h"
+#include "../utilities/MeasurementHarness.h"
+
+#include "ScalarTest.h"
+#include "UMESimdTest.h"
+
+template<typename FLOAT_T, int DIM>
+void register_gemm_category(BenchmarkHarness & harness, int batch_size) {
+    TestCategory *newCategory = new TestCategory(std::string("BATCHED_GEMM"));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("dim"), DIM));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("batch_size"), batch_size));
+
+    newCategory->registerTest(new ScalarBatchedGemmTest<FLOAT_T, DIM>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemmTest<FLOAT_T, DIM, 32 / sizeof(FLOAT_T) / 2>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemmTest<FLOAT_T, DIM, 32 / sizeof(FLOAT_T)>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemmTest<FLOAT_T, DIM, 64 / sizeof(FLOAT_T)>(batch_size));
+
+    harness.registerTestCategory(newCategory);
+}
+
+template<typename FLOAT_T, int DIM>
+void register_gemv_category(BenchmarkHarness & harness, int batch_size) {
+    TestCategory *newCategory = new TestCategory(std::string("BATCHED_GEMV"));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("dim"), DIM));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("batch_size"), batch_size));
+
+    newCategory->registerTest(new ScalarBatchedGemvTest<FLOAT_T, DIM>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemvTest<FLOAT_T, DIM, 32 / sizeof(FLOAT_T) / 2>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemvTest<FLOAT_T, DIM, 32 / sizeof(FLOAT_T)>(batch_size));
+    newCategory->registerTest(new UMESimdBatchedGemvTest<FLOAT_T, DIM, 64 / sizeof(FLOAT_T)>(batch_size));
+
+    harness.registerTestCategory(newCategory);
+}
+
+template<typename FLOAT_T>
+void register_categories(BenchmarkHarness & harness, int batch_size) {
+    register_gemm_category<FLOAT_T, 3>(harness, batch_size);
+    register_gemm_category<FLOAT_T, 4>(harness, batch_size);
+    register_gemm_category<FLOAT_T, 5>(harness, batch_size);
+    register_gemm_category<FLOAT_T, 6>(harness, batch_size);
+    register_gemv_category<FLOAT_T, 3>(harness, batch_size);
+    register_gemv_category<FLOAT_T, 4>(harness, batch_size);
+    register_gemv_category<FLOAT_T, 5>(harness, batch_size);
+    register_gemv_category<FLOAT_T, 6>(harness, batch_size);
+}
+
+int main(int argc, char **argv)
+{
+    int MIN_BATCH = 16;
+    int MAX_BATCH = 1048576;
+    int ITERATIONS = 10;
+    int PROGRESSION = 4;
+
+    BenchmarkHarness harness(argc, argv);
+
+    std::cout <<
+        "This benchmark measures batches of small, independent matrix products:\n"
+        " - C = A * B (gemm) and y = A * x (gemv) for DIMxDIM matrices, DIM = 3..6.\n\n"
+        "Scalar version processes one matrix at a time, with matrices stored one after\n"
+        "another. UME::SIMD version stores the batch 'across lanes': element (i,j) of\n"
+        "SIMD_STRIDE matrices is stored contiguously, so that every vector instruction\n"
+        "advances SIMD_STRIDE independent products. Layout conversion is not measured.\n\n";
+
+    for (int i = MIN_BATCH; i <= MAX_BATCH; i *= PROGRESSION) {
+        register_categories<float>(harness, i);
+    }
+
+    for (int i = MIN_BATCH; i <= MAX_BATCH; i *= PROGRESSION) {
+        register_categories<double>(harness, i);
+    }
+
+    harness.runTests(ITERATIONS);
+}
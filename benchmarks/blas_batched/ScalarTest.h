@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef SCALAR_BATCHED_BENCH_H_
+#define SCALAR_BATCHED_BENCH_H_
+
+#include "BatchedTest.h"
+
+// Reference implementation: every matrix of the batch is processed separately.
+template<typename FLOAT_T, int DIM>
+class ScalarBatchedGemmTest : public BatchedGemmTest<FLOAT_T, DIM> {
+public:
+    ScalarBatchedGemmTest(int batch_size) : BatchedGemmTest<FLOAT_T, DIM>(batch_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int m = 0; m < this->batch_size; m++) {
+            FLOAT_T const *a = &this->A[m * DIM * DIM];
+            FLOAT_T const *b = &this->B[m * DIM * DIM];
+            FLOAT_T *c = &this->C[m * DIM * DIM];
+            for (int i = 0; i < DIM; i++) {
+                for (int j = 0; j < DIM; j++) {
+                    FLOAT_T t0 = FLOAT_T(0.0f);
+                    for (int k = 0; k < DIM; k++) {
+                        t0 += a[i*DIM + k] * b[k*DIM + j];
+                    }
+                    c[i*DIM + j] = t0;
+                }
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar batched gemm, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(DIM) + "x" + std::to_string(DIM) + ", " +
+            std::to_string(this->batch_size);
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int DIM>
+class ScalarBatchedGemvTest : public BatchedGemvTest<FLOAT_T, DIM> {
+public:
+    ScalarBatchedGemvTest(int batch_size) : BatchedGemvTest<FLOAT_T, DIM>(batch_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int m = 0; m < this->batch_size; m++) {
+            FLOAT_T const *a = &this->A[m * DIM * DIM];
+            FLOAT_T const *x = &this->x[m * DIM];
+            FLOAT_T *y = &this->y[m * DIM];
+            for (int i = 0; i < DIM; i++) {
+                FLOAT_T t0 = FLOAT_T(0.0f);
+                for (int k = 0; k < DIM; k++) {
+                    t0 += a[i*DIM + k] * x[k];
+                }
+                y[i] = t0;
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar batched gemv, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(DIM) + "x" + std::to_string(DIM) + ", " +
+            std::to_string(this->batch_size);
+        return retval;
+    }
+};
+
+#endif
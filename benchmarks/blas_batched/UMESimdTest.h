@@ -0,0 +1,190 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_SIMD_BATCHED_BENCH_H_
+#define UME_SIMD_BATCHED_BENCH_H_
+
+#include <umesimd/UMESimd.h>
+
+#include "BatchedTest.h"
+
+// Batched kernels working on interleaved data: a SIMD vector holds the same element
+// of STRIDE matrices, so every instruction advances STRIDE independent products and
+// no horizontal operations or shuffles are needed. DIM is known at compile time, so
+// all loops over matrix elements are fully unrolled.
+template<typename FLOAT_T, int DIM, int STRIDE>
+struct UMESimdBatchedKernels {
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+
+    static const int MATRIX_SIZE = DIM * DIM;
+
+    // C = A * B for 'group_count' groups of STRIDE interleaved matrices
+    static UME_FORCE_INLINE void gemm(int group_count, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T *C) {
+        for (int g = 0; g < group_count; g++) {
+            FLOAT_T const *a = &A[g * MATRIX_SIZE * STRIDE];
+            FLOAT_T const *b = &B[g * MATRIX_SIZE * STRIDE];
+            FLOAT_T *c = &C[g * MATRIX_SIZE * STRIDE];
+
+            VEC_T b_vec[MATRIX_SIZE];
+            for (int e = 0; e < MATRIX_SIZE; e++) b_vec[e].loada(&b[e * STRIDE]);
+
+            for (int i = 0; i < DIM; i++) {
+                VEC_T a_vec[DIM];
+                for (int k = 0; k < DIM; k++) a_vec[k].loada(&a[(i*DIM + k) * STRIDE]);
+
+                for (int j = 0; j < DIM; j++) {
+                    VEC_T t0 = a_vec[0] * b_vec[j];
+                    for (int k = 1; k < DIM; k++) t0 = a_vec[k].fmuladd(b_vec[k*DIM + j], t0);
+                    t0.storea(&c[(i*DIM + j) * STRIDE]);
+                }
+            }
+        }
+    }
+
+    // y = A * x for 'group_count' groups of STRIDE interleaved matrices and vectors
+    static UME_FORCE_INLINE void gemv(int group_count, FLOAT_T const *A, FLOAT_T const *x, FLOAT_T *y) {
+        for (int g = 0; g < group_count; g++) {
+            FLOAT_T const *a = &A[g * MATRIX_SIZE * STRIDE];
+            FLOAT_T const *xg = &x[g * DIM * STRIDE];
+            FLOAT_T *yg = &y[g * DIM * STRIDE];
+
+            VEC_T x_vec[DIM];
+            for (int k = 0; k < DIM; k++) x_vec[k].loada(&xg[k * STRIDE]);
+
+            for (int i = 0; i < DIM; i++) {
+                VEC_T a_vec;
+                a_vec.loada(&a[(i*DIM) * STRIDE]);
+                VEC_T t0 = a_vec * x_vec[0];
+                for (int k = 1; k < DIM; k++) {
+                    a_vec.loada(&a[(i*DIM + k) * STRIDE]);
+                    t0 = a_vec.fmuladd(x_vec[k], t0);
+                }
+                t0.storea(&yg[i * STRIDE]);
+            }
+        }
+    }
+};
+
+template<typename FLOAT_T, int DIM, int STRIDE>
+class UMESimdBatchedGemmTest : public BatchedGemmTest<FLOAT_T, DIM> {
+private:
+    static_assert(MAX_BATCH_STRIDE % STRIDE == 0, "STRIDE has to divide MAX_BATCH_STRIDE");
+    static const int MATRIX_SIZE = DIM * DIM;
+
+    FLOAT_T *A_interleaved, *B_interleaved, *C_interleaved;
+
+public:
+    UMESimdBatchedGemmTest(int batch_size) : BatchedGemmTest<FLOAT_T, DIM>(batch_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        BatchedGemmTest<FLOAT_T, DIM>::initialize();
+
+        int padded = padded_batch_size(this->batch_size);
+        A_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+        B_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+        C_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+
+        aos_to_interleaved<FLOAT_T, MATRIX_SIZE, STRIDE>(padded, this->A, A_interleaved);
+        aos_to_interleaved<FLOAT_T, MATRIX_SIZE, STRIDE>(padded, this->B, B_interleaved);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        int group_count = (this->batch_size + STRIDE - 1) / STRIDE;
+        UMESimdBatchedKernels<FLOAT_T, DIM, STRIDE>::gemm(group_count, A_interleaved, B_interleaved, C_interleaved);
+    }
+
+    UME_NEVER_INLINE virtual void optional_cleanup() {
+        interleaved_to_aos<FLOAT_T, MATRIX_SIZE, STRIDE>(this->batch_size, C_interleaved, this->C);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(A_interleaved);
+        UME::DynamicMemory::AlignedFree(B_interleaved);
+        UME::DynamicMemory::AlignedFree(C_interleaved);
+        BatchedGemmTest<FLOAT_T, DIM>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD batched gemm, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(DIM) + "x" + std::to_string(DIM) + ", " +
+            std::to_string(this->batch_size) + " (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int DIM, int STRIDE>
+class UMESimdBatchedGemvTest : public BatchedGemvTest<FLOAT_T, DIM> {
+private:
+    static_assert(MAX_BATCH_STRIDE % STRIDE == 0, "STRIDE has to divide MAX_BATCH_STRIDE");
+    static const int MATRIX_SIZE = DIM * DIM;
+
+    FLOAT_T *A_interleaved, *x_interleaved, *y_interleaved;
+
+public:
+    UMESimdBatchedGemvTest(int batch_size) : BatchedGemvTest<FLOAT_T, DIM>(batch_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        BatchedGemvTest<FLOAT_T, DIM>::initialize();
+
+        int padded = padded_batch_size(this->batch_size);
+        A_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * MATRIX_SIZE * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+        x_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * DIM * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+        y_interleaved = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded * DIM * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+
+        aos_to_interleaved<FLOAT_T, MATRIX_SIZE, STRIDE>(padded, this->A, A_interleaved);
+        aos_to_interleaved<FLOAT_T, DIM, STRIDE>(padded, this->x, x_interleaved);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        int group_count = (this->batch_size + STRIDE - 1) / STRIDE;
+        UMESimdBatchedKernels<FLOAT_T, DIM, STRIDE>::gemv(group_count, A_interleaved, x_interleaved, y_interleaved);
+    }
+
+    UME_NEVER_INLINE virtual void optional_cleanup() {
+        interleaved_to_aos<FLOAT_T, DIM, STRIDE>(this->batch_size, y_interleaved, this->y);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(A_interleaved);
+        UME::DynamicMemory::AlignedFree(x_interleaved);
+        UME::DynamicMemory::AlignedFree(y_interleaved);
+        BatchedGemvTest<FLOAT_T, DIM>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD batched gemv, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(DIM) + "x" + std::to_string(DIM) + ", " +
+            std::to_string(this->batch_size) + " (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+#endif
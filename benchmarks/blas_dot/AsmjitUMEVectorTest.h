@@ -28,106 +28,151 @@
 //  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
 //
 
+// EXPLAINER:
+// This benchmark uses JIT assembly instead of UME::SIMD as a code generation layer.
+// Reductions are evaluated using multiple vector accumulators and a final tree
+// reduction. The evaluator only generates single precision AVX2/FMA3 code, so double
+// precision tests are reported as disabled.
+
 #pragma once
 
 #include <umevector/UMEVector.h>
 #include "../utilities/MeasurementHarness.h"
 
-#include "../utilities/AsmjitMonadicEvaluator.h"
-
-#define USE_ASMJIT
-#if defined (USE_ASMJIT)
+#include "DotTest.h"
 
 template<typename FLOAT_T>
-class UMEVectorSingleTest : public DotSingleTest<FLOAT_T> {
+class UMEVectorAsmjitSingleTest : public Test {
 public:
-    UMEVectorSingleTest(int problem_size) : DotSingleTest<FLOAT_T>(problem_size) {}
+    int problem_size;
 
-    UME_NEVER_INLINE virtual void benchmarked_code()
+    // The default class will be called when the JIT evaluator is disabled
+    UMEVectorAsmjitSingleTest(int problem_size) : Test(false), problem_size(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
     {
-        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
-        UME::VECTOR::Vector<FLOAT_T> y_vec(this->problem_size, this->y);
+        std::string retval = "AsmJIT evaluator single";
+        return retval;
+    }
+};
 
-        this->dot_result = (x_vec * y_vec).hadd();
+template<typename FLOAT_T>
+class UMEVectorAsmjitChainedTest : public Test {
+public:
+    int problem_size;
 
-        AsmjitEvaluator eval(this->dot_result, )
-    }
+    UMEVectorAsmjitChainedTest(int problem_size) : Test(false), problem_size(problem_size) {}
 
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
     UME_NEVER_INLINE virtual std::string get_test_identifier()
     {
-        std::string retval = "";
-        retval += "UME::VECTOR single, (" +
-            ScalarToString<FLOAT_T>::value() + ") " +
-            std::to_string(this->problem_size);
+        std::string retval = "AsmJIT evaluator chained";
         return retval;
     }
 };
 
-template<typename FLOAT_T>
-class UMEVectorChainedTest : public DotChainedTest<FLOAT_T> {
+#if defined (USE_ASMJIT)
+
+#include "../utilities/AsmjitMonadicEvaluator.h"
+
+template<>
+class UMEVectorAsmjitSingleTest<float> : public DotSingleTest<float> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<float>::value> EVALUATOR_T;
+
+    // The evaluator is compiled outside of the measured region, so that only
+    // the generated code is timed.
+    EVALUATOR_T *eval;
+
 public:
-    UMEVectorChainedTest(int problem_size) : DotChainedTest<FLOAT_T>(problem_size) {}
+    UMEVectorAsmjitSingleTest(int problem_size) : DotSingleTest<float>(problem_size), eval(nullptr) {}
 
-    UME_NEVER_INLINE virtual void benchmarked_code()
+    UME_NEVER_INLINE virtual void initialize()
     {
-        UME::VECTOR::Vector<FLOAT_T> x0_vec(this->problem_size, this->x0);
-        UME::VECTOR::Vector<FLOAT_T> x1_vec(this->problem_size, this->x1);
-        UME::VECTOR::Vector<FLOAT_T> y0_vec(this->problem_size, this->y0);
-        UME::VECTOR::Vector<FLOAT_T> y1_vec(this->problem_size, this->y1);
+        DotSingleTest<float>::initialize();
+
+        UME::VECTOR::Vector<float> x_vec(this->problem_size, this->x);
+        UME::VECTOR::Vector<float> y_vec(this->problem_size, this->y);
 
-        auto t0 = y0_vec.adda(this->alpha0*x0_vec); // equivalent of Y = aX + Y (AXPY)
-        auto t1 = y1_vec.adda(this->alpha1*x1_vec);
-        auto t2 = (t0 * t1).hadd();
+        auto t0 = (x_vec * y_vec).hadd();
+        eval = new EVALUATOR_T(&this->dot_result, t0, 8, false, 1, false);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        eval->run();
+    }
 
-        AsmjitEvaluator eval(this->dot_result, t2);
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        delete eval;
+        eval = nullptr;
+        DotSingleTest<float>::cleanup();
     }
 
     UME_NEVER_INLINE virtual std::string get_test_identifier()
     {
-        std::string retval = "";
-        retval += "UME::VECTOR dot(axpy(x0, y0), axpy(x1, y1)), (" +
-            ScalarToString<FLOAT_T>::value() + ") " +
-            std::to_string(this->problem_size);
+        std::string retval = "AsmJIT evaluator single";
         return retval;
     }
 };
 
-#else
+template<>
+class UMEVectorAsmjitChainedTest<float> : public DotChainedTest<float> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<float>::value> EVALUATOR_T;
+
+    // The evaluator cannot store intermediate results of a reduction, so the
+    // AXPY write-back and the dot product are compiled as two separate passes.
+    EVALUATOR_T *axpy_eval;
+    EVALUATOR_T *dot_eval;
 
-template<typename FLOAT_T>
-class UMEVectorSingleTest : public DotSingleTest<FLOAT_T> {
 public:
-    UMEVectorSingleTest(int problem_size) : DotSingleTest<FLOAT_T>(problem_size) {}
+    UMEVectorAsmjitChainedTest(int problem_size) :
+        DotChainedTest<float>(problem_size), axpy_eval(nullptr), dot_eval(nullptr) {}
 
-    UME_NEVER_INLINE virtual void initialize() {}
-    UME_NEVER_INLINE virtual void benchmarked_code() {}
-    UME_NEVER_INLINE virtual void cleanup() {}
-    UME_NEVER_INLINE virtual void verify() {}
-    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    UME_NEVER_INLINE virtual void initialize()
     {
-        std::string retval = "";
-        retval += "UME::VECTOR single, (" +
-            ScalarToString<FLOAT_T>::value() + ") " +
-            std::to_string(this->problem_size);
-        return retval;
+        DotChainedTest<float>::initialize();
+
+        UME::VECTOR::Vector<float> x0_vec(this->problem_size, this->x0);
+        UME::VECTOR::Vector<float> x1_vec(this->problem_size, this->x1);
+        UME::VECTOR::Vector<float> y0_vec(this->problem_size, this->y0);
+        UME::VECTOR::Vector<float> y1_vec(this->problem_size, this->y1);
+
+        auto t0 = this->alpha0*x0_vec + y0_vec;
+        auto t1 = this->alpha1*x1_vec + y1_vec;
+        axpy_eval = new EVALUATOR_T(y0_vec, t0, y1_vec, t1, 1, false);
+
+        auto t2 = (y0_vec * y1_vec).hadd();
+        dot_eval = new EVALUATOR_T(&this->dot_result, t2, 8, false, 1, false);
     }
-};
 
-template<typename FLOAT_T>
-class UMEVectorChainedTest : public DotChainedTest<FLOAT_T> {
-public:
-    UMEVectorChainedTest(int problem_size) : DotChainedTest<FLOAT_T>(problem_size) {}
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        axpy_eval->run();
+        dot_eval->run();
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        delete dot_eval;
+        delete axpy_eval;
+        dot_eval = nullptr;
+        axpy_eval = nullptr;
+        DotChainedTest<float>::cleanup();
+    }
 
-    UME_NEVER_INLINE virtual void initialize() {}
-    UME_NEVER_INLINE virtual void benchmarked_code() {}
-    UME_NEVER_INLINE virtual void cleanup() {}
-    UME_NEVER_INLINE virtual void verify() {}
     UME_NEVER_INLINE virtual std::string get_test_identifier()
     {
-        std::string retval = "";
-        retval += "UME::VECTOR dot(axpy(x0, y0), axpy(x1, y1)), (" +
-            ScalarToString<FLOAT_T>::value() + ") " +
-            std::to_string(this->problem_size);
+        std::string retval = "AsmJIT evaluator chained";
         return retval;
     }
 };
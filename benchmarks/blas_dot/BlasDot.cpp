@@ -44,7 +44,10 @@
 #include "ScalarTest.h"
 #include "BlasTest.h"
 #include "UMESimdTest.h"
+#include "UMESimdAccurateTest.h"
+#include "UMESimdReducedTest.h"
 #include "UMEVectorTest.h"
+#include "AsmjitUMEVectorTest.h"
 
 int main(int argc, char** argv)
 {
@@ -57,6 +60,9 @@ int main(int argc, char** argv)
 
     std::cout <<
         "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
+        "[Compile with -DUSE_ASMJIT -DASMJIT_STATIC and asmjit sources to enable JIT benchmarks (requires AVX2 and FMA3)]\n"
+        "[Run with -v to verify results and report the error of each variant]\n"
+        "[Compile with F16C/AVX2 (e.g. -march=native) for hardware fp16/bf16 conversion, scalar conversion is used otherwise]\n"
         "\n"
         "This benchmark measures execution of a = dot_prod(X, Y) (DOT) kernel.\n"
         "Two modes are being measured:\n"
@@ -78,12 +84,20 @@ int main(int argc, char** argv)
         newCategory->registerTest(new ScalarSingleTest<float>(i));
         newCategory->registerTest(new BlasSingleTest<float>(i));
         newCategory->registerTest(new UMEVectorSingleTest<float>(i));
+        newCategory->registerTest(new UMEVectorAsmjitSingleTest<float>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 1>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 2>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 4>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 8>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 16>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 32>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<float, 8, 4>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<float, 8, 8>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<float, 16, 4>(i));
+        newCategory->registerTest(new UMESimdCompensatedSingleTest<float, 8>(i));
+        newCategory->registerTest(new UMESimdPairwiseSingleTest<float, 8, 1024>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<float16_t, 8>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<bfloat16_t, 8>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -98,6 +112,7 @@ int main(int argc, char** argv)
         newCategory->registerTest(new ScalarChainedTest<float>(i));
         newCategory->registerTest(new BlasChainedTest<float>(i));
         newCategory->registerTest(new UMEVectorChainedTest<float>(i));
+        newCategory->registerTest(new UMEVectorAsmjitChainedTest<float>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 1>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 2>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 4>(i));
@@ -118,11 +133,17 @@ int main(int argc, char** argv)
         newCategory->registerTest(new ScalarSingleTest<double>(i));
         newCategory->registerTest(new BlasSingleTest<double>(i));
         newCategory->registerTest(new UMEVectorSingleTest<double>(i));
+        newCategory->registerTest(new UMEVectorAsmjitSingleTest<double>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 1>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 2>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 4>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 8>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 16>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<double, 4, 4>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<double, 4, 8>(i));
+        newCategory->registerTest(new UMESimdMultiAccSingleTest<double, 8, 4>(i));
+        newCategory->registerTest(new UMESimdCompensatedSingleTest<double, 4>(i));
+        newCategory->registerTest(new UMESimdPairwiseSingleTest<double, 4, 512>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -137,6 +158,7 @@ int main(int argc, char** argv)
         newCategory->registerTest(new ScalarChainedTest<double>(i));
         newCategory->registerTest(new BlasChainedTest<double>(i));
         newCategory->registerTest(new UMEVectorChainedTest<double>(i));
+        newCategory->registerTest(new UMEVectorAsmjitChainedTest<double>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 1>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 2>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 4>(i));
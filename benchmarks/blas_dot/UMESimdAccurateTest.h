@@ -0,0 +1,246 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <umesimd/UMESimd.h>
+
+#include "DotTest.h"
+
+// Dot product using ACCUMULATORS independent vector accumulators. With a single
+// accumulator every FMA depends on the previous one, so the loop runs at FMA latency
+// instead of FMA throughput. Independent accumulators also split the sum into
+// ACCUMULATORS*STRIDE partial sums, which slightly reduces the rounding error.
+template<typename FLOAT_T, int STRIDE, int ACCUMULATORS>
+struct UMESimdMultiAccDot {
+    static_assert((ACCUMULATORS & (ACCUMULATORS - 1)) == 0, "Accumulator count has to be a power of 2");
+
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+
+    // Vector part of the dot product for 'length' elements (multiple of STRIDE).
+    static UME_FORCE_INLINE VEC_T dot_vec(FLOAT_T const *x, FLOAT_T const *y, int length) {
+        int BLOCK_PEEL_OFFSET = (length / (ACCUMULATORS * STRIDE)) * (ACCUMULATORS * STRIDE);
+
+        VEC_T x_vec, y_vec;
+        VEC_T acc[ACCUMULATORS];
+        for (int r = 0; r < ACCUMULATORS; r++) acc[r] = FLOAT_T(0.0f);
+
+        for (int i = 0; i < BLOCK_PEEL_OFFSET; i += ACCUMULATORS * STRIDE) {
+            for (int r = 0; r < ACCUMULATORS; r++) {
+                x_vec.loada(&x[i + r*STRIDE]);
+                y_vec.loada(&y[i + r*STRIDE]);
+                acc[r] = x_vec.fmuladd(y_vec, acc[r]);
+            }
+        }
+        for (int i = BLOCK_PEEL_OFFSET; i < length; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            y_vec.loada(&y[i]);
+            acc[0] = x_vec.fmuladd(y_vec, acc[0]);
+        }
+
+        // Tree reduction of accumulators
+        for (int width = ACCUMULATORS / 2; width > 0; width /= 2) {
+            for (int r = 0; r < width; r++) acc[r] += acc[r + width];
+        }
+        return acc[0];
+    }
+
+    static UME_FORCE_INLINE FLOAT_T dot(FLOAT_T const *x, FLOAT_T const *y, int N) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+        FLOAT_T result = dot_vec(x, y, LOOP_PEEL_OFFSET).hadd();
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) {
+            result += x[i] * y[i];
+        }
+        return result;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int ACCUMULATORS>
+class UMESimdMultiAccSingleTest : public DotSingleTest<FLOAT_T> {
+public:
+    UMESimdMultiAccSingleTest(int problem_size) : DotSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        this->dot_result = UMESimdMultiAccDot<FLOAT_T, STRIDE, ACCUMULATORS>::dot(this->x, this->y, this->problem_size);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD single, " + std::to_string(ACCUMULATORS) +
+            " accumulators (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+// Compensated dot product. Every lane keeps a running sum and a running compensation
+// term. Rounding error of each addition is recovered with Knuth's TwoSum, which gives
+// the same error term as Neumaier's variant of Kahan summation, but does not need
+// a per-lane comparison of magnitudes. The rounding error of each product is recovered
+// with 'fmulsub' (exact when FMA is available in hardware), so the result is as
+// accurate as if it was computed in twice the working precision (Ogita, Rump, Oishi).
+//
+// Note: this code must not be compiled with value-unsafe optimizations (e.g. -ffast-math),
+// which would remove the error terms.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdCompensatedSingleTest : public DotSingleTest<FLOAT_T> {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+
+    // Neumaier summation step for scalars
+    static UME_FORCE_INLINE void neumaier_add(FLOAT_T & sum, FLOAT_T & comp, FLOAT_T value) {
+        FLOAT_T t = sum + value;
+        if (std::abs(sum) >= std::abs(value)) comp += (sum - t) + value;
+        else comp += (value - t) + sum;
+        sum = t;
+    }
+
+public:
+    UMESimdCompensatedSingleTest(int problem_size) : DotSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        int LOOP_PEEL_OFFSET = (this->problem_size / STRIDE) * STRIDE;
+
+        VEC_T x_vec, y_vec, p_vec, t_vec, z_vec;
+        VEC_T sum_vec(FLOAT_T(0.0f)), comp_vec(FLOAT_T(0.0f));
+
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE)
+        {
+            x_vec.loada(&this->x[i]);
+            y_vec.loada(&this->y[i]);
+
+            // p + (x*y - p) == x*y
+            p_vec = x_vec * y_vec;
+            comp_vec += x_vec.fmulsub(y_vec, p_vec);
+
+            // TwoSum: t + ((sum - (t - z)) + (p - z)) == sum + p
+            t_vec = sum_vec + p_vec;
+            z_vec = t_vec - sum_vec;
+            comp_vec += (sum_vec - (t_vec - z_vec)) + (p_vec - z_vec);
+            sum_vec = t_vec;
+        }
+
+        // Reduce the lanes, keeping the compensation
+        alignas(64) FLOAT_T sums[STRIDE];
+        alignas(64) FLOAT_T comps[STRIDE];
+        sum_vec.store(sums);
+        comp_vec.store(comps);
+
+        FLOAT_T sum = FLOAT_T(0.0f), comp = FLOAT_T(0.0f);
+        for (int l = 0; l < STRIDE; l++) {
+            neumaier_add(sum, comp, sums[l]);
+            comp += comps[l];
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < this->problem_size; i++)
+        {
+            neumaier_add(sum, comp, this->x[i] * this->y[i]);
+        }
+
+        this->dot_result = sum + comp;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD single, compensated (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+// Pairwise (cascade) dot product. Blocks of BLOCK_SIZE elements are reduced with the
+// multi-accumulator kernel, and partial results of blocks are combined in a binary
+// tree. The tree is built incrementally with a stack of partial sums: partial sums of
+// equal level are merged as soon as both are available, so only log2(N/BLOCK_SIZE)
+// vectors are kept. Rounding error grows with log(N) instead of N, at nearly the cost
+// of the plain multi-accumulator loop.
+template<typename FLOAT_T, int STRIDE, int BLOCK_SIZE>
+class UMESimdPairwiseSingleTest : public DotSingleTest<FLOAT_T> {
+private:
+    static const int ACCUMULATORS = 4;
+    static_assert(BLOCK_SIZE % (ACCUMULATORS * STRIDE) == 0, "Block size has to be a multiple of 4*STRIDE");
+
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+    typedef UMESimdMultiAccDot<FLOAT_T, STRIDE, ACCUMULATORS> BLOCK_T;
+
+public:
+    UMESimdPairwiseSingleTest(int problem_size) : DotSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        int LOOP_PEEL_OFFSET = (this->problem_size / STRIDE) * STRIDE;
+
+        // 32 levels are enough for any 'int' problem size.
+        VEC_T stack[32];
+        int level[32];
+        int depth = 0;
+
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += BLOCK_SIZE) {
+            int length = std::min(BLOCK_SIZE, LOOP_PEEL_OFFSET - i);
+            VEC_T partial = BLOCK_T::dot_vec(&this->x[i], &this->y[i], length);
+            int partial_level = 0;
+
+            while (depth > 0 && level[depth - 1] == partial_level) {
+                partial = stack[depth - 1] + partial;
+                partial_level++;
+                depth--;
+            }
+            stack[depth] = partial;
+            level[depth] = partial_level;
+            depth++;
+        }
+
+        VEC_T total(FLOAT_T(0.0f));
+        while (depth > 0) {
+            total = stack[depth - 1] + total;
+            depth--;
+        }
+
+        this->dot_result = total.hadd();
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < this->problem_size; i++)
+        {
+            this->dot_result += this->x[i] * this->y[i];
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD single, pairwise " + std::to_string(BLOCK_SIZE) +
+            " (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
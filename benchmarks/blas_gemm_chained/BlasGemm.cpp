@@ -35,6 +35,9 @@
 #include <time.h>
 #include <stdlib.h>
 #include <string>
+#include <thread>
+#include <algorithm>
+#include <vector>
 
 #include <umesimd/UMESimd.h>
 
@@ -44,7 +47,7 @@
 #include "ScalarTest.h"
 #include "BlasTest.h"
 #include "BlasSplitTest.h"
-//#include "UMESimdTest.h"
+#include "UMESimdTest.h"
 //#include "UMEVectorTest.h"
 
 int main(int argc, char **argv)
@@ -53,12 +56,19 @@ int main(int argc, char **argv)
     int MAX_SIZE = 2048;
     int PROGRESSION = 2;
     int ITERATIONS = 10;
+    // Thread counts used for the multi-threaded GEMM: powers of two up to the number
+    // of hardware threads, followed by the number of hardware threads itself.
+    int THREAD_COUNT = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<int> THREAD_SWEEP;
+    for (int t = 2; t < THREAD_COUNT; t *= 2) THREAD_SWEEP.push_back(t);
+    if (THREAD_COUNT > 1) THREAD_SWEEP.push_back(THREAD_COUNT);
 
     BenchmarkHarness harness(argc, argv);
 
     std::cout <<
         "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
-        "\nTODO:\n\n";
+        "[UME::SIMD blocked GEMM does not require BLAS]\n"
+        "[Compile with -fopenmp to enable multi-threaded UME::SIMD GEMM]\n\n";
     /*
     // Single execution (single precision)
     for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
@@ -70,6 +80,7 @@ int main(int argc, char **argv)
         newCategory->registerTest(new ScalarSingleTest<float>(i));
         newCategory->registerTest(new BlasSingleTest<float>(i));
         newCategory->registerTest(new BlasSplitSingleTest<float>(i));
+        newCategory->registerTest(new UMESimdSingleTest<float, 8>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -84,6 +95,7 @@ int main(int argc, char **argv)
         newCategory->registerTest(new ScalarSingleTest<double>(i));
         newCategory->registerTest(new BlasSingleTest<double>(i));
         newCategory->registerTest(new BlasSplitSingleTest<double>(i));
+        newCategory->registerTest(new UMESimdSingleTest<double, 4>(i));
 
         harness.registerTestCategory(newCategory);
     }*/
@@ -98,6 +110,12 @@ int main(int argc, char **argv)
         //newCategory->registerTest(new ScalarChainedTest<float>(i));
         newCategory->registerTest(new BlasChainedTest<float>(i));
         newCategory->registerTest(new BlasSplitChainedTest<float>(i));
+        newCategory->registerTest(new UMESimdChainedTest<float, 8>(i));
+        newCategory->registerTest(new UMESimdChainedTest<float, 16>(i));
+        newCategory->registerTest(new UMESimdSplitChainedTest<float, 8>(i));
+        for (int t : THREAD_SWEEP) {
+            newCategory->registerTest(new UMESimdParallelChainedTest<float, 8>(i, t));
+        }
 
         harness.registerTestCategory(newCategory);
     }
@@ -112,6 +130,12 @@ int main(int argc, char **argv)
         //newCategory->registerTest(new ScalarChainedTest<double>(i));
         newCategory->registerTest(new BlasChainedTest<double>(i));
         newCategory->registerTest(new BlasSplitChainedTest<double>(i));
+        newCategory->registerTest(new UMESimdChainedTest<double, 4>(i));
+        newCategory->registerTest(new UMESimdChainedTest<double, 8>(i));
+        newCategory->registerTest(new UMESimdSplitChainedTest<double, 4>(i));
+        for (int t : THREAD_SWEEP) {
+            newCategory->registerTest(new UMESimdParallelChainedTest<double, 4>(i, t));
+        }
 
         harness.registerTestCategory(newCategory);
     }
@@ -35,134 +35,25 @@
 #include <umesimd/UMESimd.h>
 
 #include "MatmulTest.h"
+#include "MatmulSplitTest.h"
 #include "../utilities/UMEScalarToString.h"
 
 #ifdef USE_BLAS
 
 #include "BlasWrapper.h"
 
+// Adapts the static BLAS wrapper to the kernel interface used by split tests.
 template<typename FLOAT_T>
-class BlasSplitSingleTest : public MatmulSingleTest<FLOAT_T> {
-
-    void rearrange(FLOAT_T* src, FLOAT_T *dst, FLOAT_T *temp) {
-        int N = this->problem_size;
-        for (int i = 0; i < N*N; i++) temp[i] = 0;
-
-        // left-upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = 0; j < N / 2; j++) {
-                temp[i*N / 2 + j] = src[i*N + j];
-            }
-        }
-
-        // right upper
-        for (int i = 0; i < N/2; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[N*N / 4 + i*N / 2 + (j - N/2)] = src[i*N + j];
-            }
-        }
-
-        // left lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                temp[N*N / 2 + (i - N/2)*N / 2 + j] = src[i*N + j];
-            }
-        }
-
-        // right lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N/2)] = src[i*N + j];
-            }
-        }
-
-        for (int i = 0; i < N*N; i++) {
-            dst[i] = temp[i];
-        }
-    }
-
-    void inverse_rearrange(FLOAT_T* src, FLOAT_T* dst, FLOAT_T* temp) {
-        int N = this->problem_size;
-        // left upper
-
-
-        // left-upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = 0; j < N / 2; j++) {
-                temp[i*N + j] = src[i*N / 2 + j];
-            }
-        }
-
-        // right upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[i*N + j] = src[N*N / 4 + i*N / 2 + (j - N / 2)];
-            }
-        }
-
-        // left lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                temp[i*N + j] = src[N*N / 2 + (i - N / 2)*N / 2 + j] ;
-            }
-        }
-
-        // right lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[i*N + j] = src[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N / 2)];
-            }
-        }
-
-        for (int i = 0; i < N*N; i++) {
-            dst[i] = temp[i];
-        }
+struct BlasSplitKernel {
+    UME_FORCE_INLINE void gemm(int N, FLOAT_T alpha, FLOAT_T *A, FLOAT_T *B, FLOAT_T beta, FLOAT_T *C) {
+        GEMM_kernel<FLOAT_T>::blas_gemm(N, alpha, A, B, beta, C);
     }
+};
 
+template<typename FLOAT_T>
+class BlasSplitSingleTest : public MatmulSplitSingleTest<FLOAT_T, BlasSplitKernel<FLOAT_T>> {
 public:
-
-
-    BlasSplitSingleTest(int problem_size) : MatmulSingleTest<FLOAT_T>(problem_size) {}
-
-    UME_NEVER_INLINE virtual void optional_init() {
-        rearrange(this->A, this->A, this->temp0);
-        rearrange(this->B, this->B, this->temp0);
-    }
-
-    UME_NEVER_INLINE virtual void benchmarked_code() {
-
-        int N = this->problem_size;
-        FLOAT_T* a0 = this->A;
-        FLOAT_T* a1 = this->A + (N*N / 4);
-        FLOAT_T* a2 = this->A + (N*N / 2);
-        FLOAT_T* a3 = this->A + (3 * N*N / 4);
-        FLOAT_T* b0 = this->B;
-        FLOAT_T* b1 = this->B + (N*N / 4);
-        FLOAT_T* b2 = this->B + (N*N / 2);
-        FLOAT_T* b3 = this->B + (3 * N*N / 4);
-        FLOAT_T* r0 = this->R;
-        FLOAT_T* r1 = this->R + (N*N / 4);
-        FLOAT_T* r2 = this->R + (N*N / 2);
-        FLOAT_T* r3 = this->R + (3 * N*N / 4);
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a0, b0, FLOAT_T(0.0f), r0);
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a1, b2, FLOAT_T(1.0f), r0);
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a0, b1, FLOAT_T(0.0f), r1);
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a1, b3, FLOAT_T(1.0f), r1);
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a2, b0, FLOAT_T(0.0f), r2);
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a3, b2, FLOAT_T(1.0f), r2);
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a2, b1, FLOAT_T(0.0f), r3);
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a3, b3, FLOAT_T(1.0f), r3);
-    }
-
-    UME_NEVER_INLINE virtual void optional_cleanup() {
-        inverse_rearrange(this->A, this->A, this->temp0);
-        inverse_rearrange(this->B, this->B, this->temp0);
-        inverse_rearrange(this->R, this->R, this->temp0);
-    }
+    BlasSplitSingleTest(int problem_size) : MatmulSplitSingleTest<FLOAT_T, BlasSplitKernel<FLOAT_T>>(problem_size) {}
 
     UME_NEVER_INLINE virtual std::string get_test_identifier() {
         std::string retval = "";
@@ -174,185 +65,9 @@ public:
 };
 
 template<typename FLOAT_T>
-class BlasSplitChainedTest : public MatmulChainedTest<FLOAT_T> {
-
-
-    void rearrange(FLOAT_T* src, FLOAT_T *dst, FLOAT_T *temp) {
-        int N = this->problem_size;
-        for (int i = 0; i < N*N; i++) temp[i] = 0;
-
-        // left-upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = 0; j < N / 2; j++) {
-                temp[i*N / 2 + j] = src[i*N + j];
-            }
-        }
-
-        // right upper
-        for (int i = 0; i < N/2; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[N*N / 4 + i*N / 2 + (j - N/2)] = src[i*N + j];
-            }
-        }
-
-        // left lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                temp[N*N / 2 + (i - N/2)*N / 2 + j] = src[i*N + j];
-            }
-        }
-
-        // right lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N/2)] = src[i*N + j];
-            }
-        }
-
-        for (int i = 0; i < N*N; i++) {
-            dst[i] = temp[i];
-        }
-    }
-
-    void inverse_rearrange(FLOAT_T* src, FLOAT_T* dst, FLOAT_T* temp) {
-        int N = this->problem_size;
-        // left-upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = 0; j < N / 2; j++) {
-                temp[i*N + j] = src[i*N / 2 + j];
-            }
-        }
-
-        // right upper
-        for (int i = 0; i < N / 2; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[i*N + j] = src[N*N / 4 + i*N / 2 + (j - N / 2)];
-            }
-        }
-
-        // left lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                temp[i*N + j] = src[N*N / 2 + (i - N / 2)*N / 2 + j];
-            }
-        }
-
-        // right lower
-        for (int i = N / 2; i < N; i++) {
-            for (int j = N / 2; j < N; j++) {
-                temp[i*N + j] = src[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N / 2)];
-            }
-        }
-
-        for (int i = 0; i < N*N; i++) {
-            dst[i] = temp[i];
-        }
-    }
-
-
+class BlasSplitChainedTest : public MatmulSplitChainedTest<FLOAT_T, BlasSplitKernel<FLOAT_T>> {
 public:
-
-    BlasSplitChainedTest(int problem_size) : MatmulChainedTest<FLOAT_T>(problem_size) {
-    }
-    
-    ~BlasSplitChainedTest() {
-    }
-
-    UME_NEVER_INLINE virtual void optional_init() {
-        // Rearrange A matrix
-        //        std::cout << "A:" << std::endl;
-        //      printMatrix(this->problem_size, this->A);
-        //      std::cout << "A After: " << std::endl;
-        rearrange(this->A, this->A, this->temp0);
-        //      printMatrix(this->problem_size, this->A);
-        // Rearrange B matrix
-        //      std::cout << "B:" << std::endl;
-        //      printMatrix(this->problem_size, this->B);
-        rearrange(this->B, this->B, this->temp0);
-        // Rearrange C matrix
-        //      std::cout << "C:" << std::endl;
-        //      printMatrix(this->problem_size, this->C);
-        rearrange(this->C, this->C, this->temp0);
-    }
-
-
-    UME_NEVER_INLINE virtual void benchmarked_code()
-    {
-        int N = this->problem_size;
-        FLOAT_T* a0 = this->A;
-        FLOAT_T* a1 = this->A + (N*N/4);
-        FLOAT_T* a2 = this->A + (N*N /2);
-        FLOAT_T* a3 = this->A + (3* N*N /4);
-        FLOAT_T* b0 = this->B;
-        FLOAT_T* b1 = this->B + (N*N /4);
-        FLOAT_T* b2 = this->B + (N*N /2);
-        FLOAT_T* b3 = this->B + (3* N*N /4);
-        FLOAT_T* c0 = this->C;
-        FLOAT_T* c1 = this->C + (N*N /4);
-        FLOAT_T* c2 = this->C + (N*N /2);
-        FLOAT_T* c3 = this->C + (3* N*N /4);
-        FLOAT_T* t0 = this->temp0;
-        FLOAT_T* t1 = this->temp0 + (N*N /4);
-        FLOAT_T* t2 = this->temp0 + (N*N /2);
-        FLOAT_T* t3 = this->temp0 + (3* N*N /4);
-
-        FLOAT_T* r0 = this->R;
-        FLOAT_T* r1 = this->R + (N*N /4);
-        FLOAT_T* r2 = this->R + (N*N /2);
-        FLOAT_T* r3 = this->R + (3* N*N /4);
-
-//        std::cout << "A0:" << std::endl;
-//        printMatrix(this->problem_size/2, a0);
-
-//        std::cout << "B0:" << std::endl;
-//        printMatrix(this->problem_size/2, b0);
-
-//        std::cout << "A1:" << std::endl;
-//        printMatrix(this->problem_size/2, a1);
-
-//        std::cout << "B2:" << std::endl;
-//        printMatrix(this->problem_size/2, b2);
-
-        // t0 <- a0*b0 + a1*b2  ~= (k0 + k1)
-        // t1 <- a0*b1 
-
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a0, b0, FLOAT_T(0.0f), t0); // k0
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a0, b1, FLOAT_T(0.0f), t1); // k2
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a1, b2, FLOAT_T(1.0f), t0); // t0
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a1, b3, FLOAT_T(1.0f), t1); // t1
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t0, c0, FLOAT_T(0.0f), r0); // k8
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), t0, c1, FLOAT_T(0.0f), r1); // k10
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t1, c2, FLOAT_T(1.0f), r0); // r0
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t1, c3, FLOAT_T(1.0f), r1); // r1
-
-        
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a2, b0, FLOAT_T(0.0f), t2); // k4
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), a2, b1, FLOAT_T(0.0f), t3); // k6
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a3, b2, FLOAT_T(1.0f), t2); // t2
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), a3, b3, FLOAT_T(1.0f), t3); // t3
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t2, c0, FLOAT_T(0.0f), r2); // k12
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size / 2, FLOAT_T(1.0f), t2, c1, FLOAT_T(0.0f), r3); // k14
-
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t3, c2, FLOAT_T(1.0f), r2); // r2
-        GEMM_kernel<FLOAT_T>::blas_gemm(this->problem_size/2, FLOAT_T(1.0f), t3, c3, FLOAT_T(1.0f), r3); // r3
-
-        //std::cout << "Before:" << std::endl;
-        //printMatrix(this->problem_size, this->R);
-//        std::cout << "R:" << std::endl;
-//        printMatrix(this->problem_size, this->R);
-    }
-
-    UME_NEVER_INLINE virtual void optional_cleanup() {
-        inverse_rearrange(this->A, this->A, this->temp0);
-        inverse_rearrange(this->B, this->B, this->temp0);
-        inverse_rearrange(this->C, this->C, this->temp0);
-        inverse_rearrange(this->R, this->R, this->temp0);
-    }
+    BlasSplitChainedTest(int problem_size) : MatmulSplitChainedTest<FLOAT_T, BlasSplitKernel<FLOAT_T>>(problem_size) {}
 
     UME_NEVER_INLINE virtual std::string get_test_identifier() {
         std::string retval = "";
@@ -369,9 +84,9 @@ public:
 // compile time error, allowing the user to decide whether to 
 // enable BLAS interface or not.
 template<typename FLOAT_T>
-class BlasSplitSingleTest : public GemvSingleTest<FLOAT_T> {
+class BlasSplitSingleTest : public MatmulSingleTest<FLOAT_T> {
 public:
-    BlasSplitSingleTest(int problem_size) : GemvSingleTest<FLOAT_T>(problem_size) {}
+    BlasSplitSingleTest(int problem_size) : MatmulSingleTest<FLOAT_T>(problem_size) {}
 
     // All the member functions are forced to never inline,
     // so that the compiler doesn't make any opportunistic guesses.
@@ -390,9 +105,9 @@ public:
 };
 
 template<typename FLOAT_T>
-class BlasSplitChainedTest : public GemvChainedTest<FLOAT_T> {
+class BlasSplitChainedTest : public MatmulChainedTest<FLOAT_T> {
 public:
-    BlasSplitChainedTest(int problem_size) : GemvChainedTest<FLOAT_T>(problem_size) {}
+    BlasSplitChainedTest(int problem_size) : MatmulChainedTest<FLOAT_T>(problem_size) {}
 
     // All the member functions are forced to never inline,
     // so that the compiler doesn't make any opportunistic guesses.
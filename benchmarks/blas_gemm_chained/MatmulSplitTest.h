@@ -0,0 +1,257 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef MATMUL_SPLIT_BENCH_H_
+#define MATMUL_SPLIT_BENCH_H_
+
+#include <umesimd/UMESimd.h>
+
+#include "MatmulTest.h"
+
+// Rearrange NxN matrix so that its four N/2xN/2 quadrants are stored
+// contiguously, one after another: left-upper, right-upper, left-lower, right-lower.
+template<typename FLOAT_T>
+void split_rearrange(int N, FLOAT_T* src, FLOAT_T *dst, FLOAT_T *temp) {
+    for (int i = 0; i < N*N; i++) temp[i] = 0;
+
+    // left-upper
+    for (int i = 0; i < N / 2; i++) {
+        for (int j = 0; j < N / 2; j++) {
+            temp[i*N / 2 + j] = src[i*N + j];
+        }
+    }
+
+    // right upper
+    for (int i = 0; i < N/2; i++) {
+        for (int j = N / 2; j < N; j++) {
+            temp[N*N / 4 + i*N / 2 + (j - N/2)] = src[i*N + j];
+        }
+    }
+
+    // left lower
+    for (int i = N / 2; i < N; i++) {
+        for (int j = 0; j < N / 2; j++) {
+            temp[N*N / 2 + (i - N/2)*N / 2 + j] = src[i*N + j];
+        }
+    }
+
+    // right lower
+    for (int i = N / 2; i < N; i++) {
+        for (int j = N / 2; j < N; j++) {
+            temp[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N/2)] = src[i*N + j];
+        }
+    }
+
+    for (int i = 0; i < N*N; i++) {
+        dst[i] = temp[i];
+    }
+}
+
+template<typename FLOAT_T>
+void split_inverse_rearrange(int N, FLOAT_T* src, FLOAT_T* dst, FLOAT_T* temp) {
+    // left-upper
+    for (int i = 0; i < N / 2; i++) {
+        for (int j = 0; j < N / 2; j++) {
+            temp[i*N + j] = src[i*N / 2 + j];
+        }
+    }
+
+    // right upper
+    for (int i = 0; i < N / 2; i++) {
+        for (int j = N / 2; j < N; j++) {
+            temp[i*N + j] = src[N*N / 4 + i*N / 2 + (j - N / 2)];
+        }
+    }
+
+    // left lower
+    for (int i = N / 2; i < N; i++) {
+        for (int j = 0; j < N / 2; j++) {
+            temp[i*N + j] = src[N*N / 2 + (i - N / 2)*N / 2 + j];
+        }
+    }
+
+    // right lower
+    for (int i = N / 2; i < N; i++) {
+        for (int j = N / 2; j < N; j++) {
+            temp[i*N + j] = src[3 * N*N / 4 + (i - N / 2)*N / 2 + (j - N / 2)];
+        }
+    }
+
+    for (int i = 0; i < N*N; i++) {
+        dst[i] = temp[i];
+    }
+}
+
+// Matrix multiplication split into 2x2 quadrants. Every quadrant product is
+// delegated to 'GEMM_T', which has to provide:
+//
+//     void gemm(int N, FLOAT_T alpha, FLOAT_T *A, FLOAT_T *B, FLOAT_T beta, FLOAT_T *C);
+//
+// The kernel object is created in 'initialize' so that any workspace allocation
+// is not measured.
+template<typename FLOAT_T, typename GEMM_T>
+class MatmulSplitSingleTest : public MatmulSingleTest<FLOAT_T> {
+protected:
+    GEMM_T *kernel;
+
+public:
+    MatmulSplitSingleTest(int problem_size) : MatmulSingleTest<FLOAT_T>(problem_size), kernel(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulSingleTest<FLOAT_T>::initialize();
+        kernel = new GEMM_T();
+    }
+
+    UME_NEVER_INLINE virtual void optional_init() {
+        split_rearrange(this->problem_size, this->A, this->A, this->temp0);
+        split_rearrange(this->problem_size, this->B, this->B, this->temp0);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        int N = this->problem_size;
+        FLOAT_T* a0 = this->A;
+        FLOAT_T* a1 = this->A + (N*N / 4);
+        FLOAT_T* a2 = this->A + (N*N / 2);
+        FLOAT_T* a3 = this->A + (3 * N*N / 4);
+        FLOAT_T* b0 = this->B;
+        FLOAT_T* b1 = this->B + (N*N / 4);
+        FLOAT_T* b2 = this->B + (N*N / 2);
+        FLOAT_T* b3 = this->B + (3 * N*N / 4);
+        FLOAT_T* r0 = this->R;
+        FLOAT_T* r1 = this->R + (N*N / 4);
+        FLOAT_T* r2 = this->R + (N*N / 2);
+        FLOAT_T* r3 = this->R + (3 * N*N / 4);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a0, b0, FLOAT_T(0.0f), r0);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a1, b2, FLOAT_T(1.0f), r0);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a0, b1, FLOAT_T(0.0f), r1);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a1, b3, FLOAT_T(1.0f), r1);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a2, b0, FLOAT_T(0.0f), r2);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a3, b2, FLOAT_T(1.0f), r2);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a2, b1, FLOAT_T(0.0f), r3);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a3, b3, FLOAT_T(1.0f), r3);
+    }
+
+    UME_NEVER_INLINE virtual void optional_cleanup() {
+        split_inverse_rearrange(this->problem_size, this->A, this->A, this->temp0);
+        split_inverse_rearrange(this->problem_size, this->B, this->B, this->temp0);
+        split_inverse_rearrange(this->problem_size, this->R, this->R, this->temp0);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        MatmulSingleTest<FLOAT_T>::cleanup();
+    }
+};
+
+template<typename FLOAT_T, typename GEMM_T>
+class MatmulSplitChainedTest : public MatmulChainedTest<FLOAT_T> {
+protected:
+    GEMM_T *kernel;
+
+public:
+    MatmulSplitChainedTest(int problem_size) : MatmulChainedTest<FLOAT_T>(problem_size), kernel(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulChainedTest<FLOAT_T>::initialize();
+        kernel = new GEMM_T();
+    }
+
+    UME_NEVER_INLINE virtual void optional_init() {
+        split_rearrange(this->problem_size, this->A, this->A, this->temp0);
+        split_rearrange(this->problem_size, this->B, this->B, this->temp0);
+        split_rearrange(this->problem_size, this->C, this->C, this->temp0);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        int N = this->problem_size;
+        FLOAT_T* a0 = this->A;
+        FLOAT_T* a1 = this->A + (N*N / 4);
+        FLOAT_T* a2 = this->A + (N*N / 2);
+        FLOAT_T* a3 = this->A + (3 * N*N / 4);
+        FLOAT_T* b0 = this->B;
+        FLOAT_T* b1 = this->B + (N*N / 4);
+        FLOAT_T* b2 = this->B + (N*N / 2);
+        FLOAT_T* b3 = this->B + (3 * N*N / 4);
+        FLOAT_T* c0 = this->C;
+        FLOAT_T* c1 = this->C + (N*N / 4);
+        FLOAT_T* c2 = this->C + (N*N / 2);
+        FLOAT_T* c3 = this->C + (3 * N*N / 4);
+        FLOAT_T* t0 = this->temp0;
+        FLOAT_T* t1 = this->temp0 + (N*N / 4);
+        FLOAT_T* t2 = this->temp0 + (N*N / 2);
+        FLOAT_T* t3 = this->temp0 + (3 * N*N / 4);
+        FLOAT_T* r0 = this->R;
+        FLOAT_T* r1 = this->R + (N*N / 4);
+        FLOAT_T* r2 = this->R + (N*N / 2);
+        FLOAT_T* r3 = this->R + (3 * N*N / 4);
+
+        // Upper half: t0|t1 <- A_upper * B, r0|r1 <- (t0|t1) * C
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a0, b0, FLOAT_T(0.0f), t0);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a0, b1, FLOAT_T(0.0f), t1);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a1, b2, FLOAT_T(1.0f), t0);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a1, b3, FLOAT_T(1.0f), t1);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t0, c0, FLOAT_T(0.0f), r0);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t0, c1, FLOAT_T(0.0f), r1);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t1, c2, FLOAT_T(1.0f), r0);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t1, c3, FLOAT_T(1.0f), r1);
+
+        // Lower half: t2|t3 <- A_lower * B, r2|r3 <- (t2|t3) * C
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a2, b0, FLOAT_T(0.0f), t2);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a2, b1, FLOAT_T(0.0f), t3);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a3, b2, FLOAT_T(1.0f), t2);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), a3, b3, FLOAT_T(1.0f), t3);
+
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t2, c0, FLOAT_T(0.0f), r2);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t2, c1, FLOAT_T(0.0f), r3);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t3, c2, FLOAT_T(1.0f), r2);
+        kernel->gemm(N / 2, FLOAT_T(1.0f), t3, c3, FLOAT_T(1.0f), r3);
+    }
+
+    UME_NEVER_INLINE virtual void optional_cleanup() {
+        split_inverse_rearrange(this->problem_size, this->A, this->A, this->temp0);
+        split_inverse_rearrange(this->problem_size, this->B, this->B, this->temp0);
+        split_inverse_rearrange(this->problem_size, this->C, this->C, this->temp0);
+        split_inverse_rearrange(this->problem_size, this->R, this->R, this->temp0);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        MatmulChainedTest<FLOAT_T>::cleanup();
+    }
+};
+
+#endif
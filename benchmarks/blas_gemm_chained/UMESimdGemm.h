@@ -0,0 +1,439 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_SIMD_GEMM_H_
+#define UME_SIMD_GEMM_H_
+
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include <umesimd/UMESimd.h>
+
+// Blocked GEMM built on UME::SIMD. The structure follows the usual 'packed panels'
+// scheme (Goto, BLIS):
+//
+//  - 'NC' columns of B and 'KC' rows of B are packed into micro-panels of 'NR'
+//    columns. The packed block of B is reused by all row blocks of A and should stay
+//    in L3 (or in the part of L3 available to a single core).
+//  - 'MC' rows of A are packed into micro-panels of 'MR' rows. The packed block of A
+//    is reused by all micro-panels of B and should stay in L2.
+//  - The micro-kernel computes a 'MR x NR' tile of C in registers, streaming one
+//    micro-panel of A and one micro-panel of B (kept in L1).
+//
+// Register tile is derived from the SIMD stride: every tile row consists of
+// 'NR_VECS' vectors and 'MR' rows are used, so that all accumulators, the B vectors
+// and a broadcast value of A fit in the register file of the target ISA.
+
+// Typical cache sizes of a single x86 core. Only half of each cache is assumed to be
+// available to the packed data.
+struct GemmCacheSizes {
+    static const int L1_SIZE = 32 * 1024;
+    static const int L2_SIZE = 256 * 1024;
+    static const int L3_SIZE = 4 * 1024 * 1024;
+};
+
+template<typename FLOAT_T, int STRIDE>
+struct GemmBlocking {
+#if defined(__AVX512F__) || defined(__MIC__)
+    static const int REGISTER_BYTES = 64;
+    static const int REGISTER_COUNT = 32;
+#elif defined(__AVX__)
+    static const int REGISTER_BYTES = 32;
+    static const int REGISTER_COUNT = 16;
+#else
+    static const int REGISTER_BYTES = 16;
+    static const int REGISTER_COUNT = 16;
+#endif
+    // Number of hardware registers needed to hold a single SIMD vector
+    static const int REGISTERS_PER_VEC =
+        (STRIDE * int(sizeof(FLOAT_T)) + REGISTER_BYTES - 1) / REGISTER_BYTES;
+    // Two vectors per row unless a single vector already spans several registers
+    static const int NR_VECS = REGISTERS_PER_VEC > 1 ? 1 : 2;
+    static const int NR = NR_VECS * STRIDE;
+    // Leave registers for B vectors and the broadcast element of A
+    static const int ACCUMULATOR_REGISTERS = REGISTER_COUNT - (NR_VECS + 1) * REGISTERS_PER_VEC;
+    static const int MR_MAX = ACCUMULATOR_REGISTERS / (NR_VECS * REGISTERS_PER_VEC);
+    static const int MR = MR_MAX < 1 ? 1 : (MR_MAX > 8 ? 8 : MR_MAX);
+
+    // KC: micro-panel of B (KC x NR) fills half of L1
+    static const int KC_RAW = GemmCacheSizes::L1_SIZE / 2 / (NR * int(sizeof(FLOAT_T)));
+    static const int KC = KC_RAW < 16 ? 16 : (KC_RAW / 8) * 8;
+    // MC: packed block of A (MC x KC) fills half of L2
+    static const int MC_RAW = GemmCacheSizes::L2_SIZE / 2 / (KC * int(sizeof(FLOAT_T)));
+    static const int MC = MC_RAW < MR ? MR : (MC_RAW / MR) * MR;
+    // NC: packed block of B (KC x NC) fills half of L3
+    static const int NC_RAW = GemmCacheSizes::L3_SIZE / 2 / (KC * int(sizeof(FLOAT_T)));
+    static const int NC = NC_RAW < NR ? NR : (NC_RAW / NR) * NR;
+};
+
+// C = alpha * A * B + beta * C, for row-major matrices A (M x K), B (K x N) and
+// C (M x N). Packing buffers are allocated once, so that the object can be reused
+// for multiple calls without allocations.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdGemm {
+public:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+    typedef GemmBlocking<FLOAT_T, STRIDE> BLOCKING;
+
+    static const int MR = BLOCKING::MR;
+    static const int NR = BLOCKING::NR;
+    static const int NR_VECS = BLOCKING::NR_VECS;
+    static const int KC = BLOCKING::KC;
+    static const int MC = BLOCKING::MC;
+    static const int NC = BLOCKING::NC;
+
+private:
+    static const int OPTIMAL_ALIGNMENT = 64;
+
+    FLOAT_T *packedA;
+    FLOAT_T *packedB;
+
+public:
+    UMESimdGemm() {
+        packedA = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MC * KC * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        packedB = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(KC * NC * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+    }
+
+    ~UMESimdGemm() {
+        UME::DynamicMemory::AlignedFree(packedA);
+        UME::DynamicMemory::AlignedFree(packedB);
+    }
+
+    UME_NEVER_INLINE void gemm(
+        int M, int N, int K,
+        FLOAT_T alpha,
+        FLOAT_T const *A, int lda,
+        FLOAT_T const *B, int ldb,
+        FLOAT_T beta,
+        FLOAT_T *C, int ldc)
+    {
+        for (int jc = 0; jc < N; jc += NC) {
+            int nc = std::min(NC, N - jc);
+
+            for (int pc = 0; pc < K; pc += KC) {
+                int kc = std::min(KC, K - pc);
+                // 'beta' only applies to the first update of C
+                FLOAT_T beta_block = (pc == 0) ? beta : FLOAT_T(1.0f);
+
+                pack_B(kc, nc, &B[pc*ldb + jc], ldb, packedB);
+
+                for (int ic = 0; ic < M; ic += MC) {
+                    int mc = std::min(MC, M - ic);
+
+                    pack_A(mc, kc, &A[ic*lda + pc], lda, packedA);
+
+                    macro_kernel(mc, nc, kc, alpha, packedA, packedB, beta_block, &C[ic*ldc + jc], ldc);
+                }
+            }
+        }
+    }
+
+    // Square matrices, same interface as 'GEMM_kernel::blas_gemm'
+    UME_FORCE_INLINE void gemm(int N, FLOAT_T alpha, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T beta, FLOAT_T *C) {
+        gemm(N, N, N, alpha, A, N, B, N, beta, C, N);
+    }
+
+    // Multiply a block of packed A by a block of packed B. Packed buffers are
+    // passed explicitly, so that they can also be shared between threads.
+    static UME_FORCE_INLINE void macro_kernel(
+        int mc, int nc, int kc,
+        FLOAT_T alpha,
+        FLOAT_T const *Ap,
+        FLOAT_T const *Bp,
+        FLOAT_T beta,
+        FLOAT_T *C, int ldc)
+    {
+        for (int jr = 0; jr < nc; jr += NR) {
+            int nr = std::min(NR, nc - jr);
+            for (int ir = 0; ir < mc; ir += MR) {
+                int mr = std::min(MR, mc - ir);
+                micro_kernel(kc, alpha, &Ap[ir*kc], &Bp[jr*kc], beta, &C[ir*ldc + jr], ldc, mr, nr);
+            }
+        }
+    }
+
+    // Pack 'mc x kc' block of A into micro-panels of MR rows. Within a micro-panel
+    // elements are stored column by column. Missing rows are padded with zeros.
+    static UME_FORCE_INLINE void pack_A(int mc, int kc, FLOAT_T const *A, int lda, FLOAT_T *Ap) {
+        for (int i = 0; i < mc; i += MR) {
+            int mr = std::min(MR, mc - i);
+            for (int p = 0; p < kc; p++) {
+                for (int r = 0; r < mr; r++) Ap[r] = A[(i + r)*lda + p];
+                for (int r = mr; r < MR; r++) Ap[r] = FLOAT_T(0.0f);
+                Ap += MR;
+            }
+        }
+    }
+
+    // Pack 'kc x nc' block of B into micro-panels of NR columns. Within a micro-panel
+    // elements are stored row by row. Missing columns are padded with zeros.
+    static UME_FORCE_INLINE void pack_B(int kc, int nc, FLOAT_T const *B, int ldb, FLOAT_T *Bp) {
+        for (int j = 0; j < nc; j += NR) {
+            int nr = std::min(NR, nc - j);
+            if (nr == NR) {
+                for (int p = 0; p < kc; p++) {
+                    for (int v = 0; v < NR_VECS; v++) {
+                        // Rows of B are not necessarily aligned
+                        VEC_T t0;
+                        t0.load(&B[p*ldb + j + v*STRIDE]);
+                        t0.storea(&Bp[v*STRIDE]);
+                    }
+                    Bp += NR;
+                }
+            }
+            else {
+                for (int p = 0; p < kc; p++) {
+                    for (int c = 0; c < nr; c++) Bp[c] = B[p*ldb + j + c];
+                    for (int c = nr; c < NR; c++) Bp[c] = FLOAT_T(0.0f);
+                    Bp += NR;
+                }
+            }
+        }
+    }
+
+    // C[0:mr, 0:nr] = alpha * Ap * Bp + beta * C[0:mr, 0:nr]
+    static UME_FORCE_INLINE void micro_kernel(
+        int kc,
+        FLOAT_T alpha,
+        FLOAT_T const *Ap,
+        FLOAT_T const *Bp,
+        FLOAT_T beta,
+        FLOAT_T *C, int ldc,
+        int mr, int nr)
+    {
+        VEC_T acc[MR][NR_VECS];
+        for (int r = 0; r < MR; r++) {
+            for (int v = 0; v < NR_VECS; v++) acc[r][v] = FLOAT_T(0.0f);
+        }
+
+        for (int p = 0; p < kc; p++) {
+            VEC_T b[NR_VECS];
+            for (int v = 0; v < NR_VECS; v++) b[v].loada(&Bp[p*NR + v*STRIDE]);
+
+            for (int r = 0; r < MR; r++) {
+                VEC_T a(Ap[p*MR + r]);
+                for (int v = 0; v < NR_VECS; v++) acc[r][v] = a.fmuladd(b[v], acc[r][v]);
+            }
+        }
+
+        if (mr == MR && nr == NR) {
+            for (int r = 0; r < MR; r++) {
+                for (int v = 0; v < NR_VECS; v++) {
+                    FLOAT_T *c = &C[r*ldc + v*STRIDE];
+                    // C is not read for beta == 0, as in BLAS.
+                    if (beta == FLOAT_T(0.0f)) {
+                        (acc[r][v] * alpha).store(c);
+                    }
+                    else {
+                        VEC_T t0;
+                        t0.load(c);
+                        acc[r][v].fmuladd(VEC_T(alpha), t0 * beta).store(c);
+                    }
+                }
+            }
+        }
+        else {
+            // Edge tile: spill the accumulators and update only the valid part.
+            FLOAT_T tile[MR*NR];
+            for (int r = 0; r < MR; r++) {
+                for (int v = 0; v < NR_VECS; v++) acc[r][v].store(&tile[r*NR + v*STRIDE]);
+            }
+            for (int r = 0; r < mr; r++) {
+                for (int c = 0; c < nr; c++) {
+                    FLOAT_T t0 = alpha * tile[r*NR + c];
+                    C[r*ldc + c] = (beta == FLOAT_T(0.0f)) ? t0 : t0 + beta * C[r*ldc + c];
+                }
+            }
+        }
+    }
+};
+
+// Multi-threaded variant of 'UMESimdGemm'. Threads are arranged in a 2D grid and
+// every thread computes a rectangular part of each 'MC x NC' block of C:
+//
+//  - the 'KC x NC' block of B is packed once per (jc, pc) iteration, cooperatively by
+//    all threads, and the packed panels are then shared by the whole grid. All threads
+//    stream the same B block from the shared L3, instead of keeping private copies,
+//  - every thread packs its own rows of A into a private buffer (L2 resident),
+//  - grid rows split M, grid columns split the NR micro-panels of the B block.
+//
+// Threads are taken from the OpenMP runtime. Callers should pin them (see
+// 'ThreadPinning'), so that the packed A buffers stay in the caches of the core that
+// uses them. Without OpenMP the computation falls back to a single thread.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdParallelGemm {
+public:
+    typedef UMESimdGemm<FLOAT_T, STRIDE> KERNEL_T;
+
+    static const int MR = KERNEL_T::MR;
+    static const int NR = KERNEL_T::NR;
+    static const int KC = KERNEL_T::KC;
+    static const int MC = KERNEL_T::MC;
+    static const int NC = KERNEL_T::NC;
+
+private:
+    static const int OPTIMAL_ALIGNMENT = 64;
+
+    int threadCount;
+
+    std::vector<FLOAT_T *> packedA;
+    FLOAT_T *packedB;
+
+    // Range '[begin, end)' of 'part' when 'length' is split into 'parts' pieces,
+    // each being a multiple of 'granularity'.
+    static UME_FORCE_INLINE void split_range(int length, int parts, int part, int granularity, int & begin, int & end) {
+        int chunk = (length + parts - 1) / parts;
+        chunk = ((chunk + granularity - 1) / granularity) * granularity;
+        begin = std::min(length, part * chunk);
+        end = std::min(length, begin + chunk);
+    }
+
+    // Use a grid that is as square as possible, with more rows than columns. Threads
+    // of different grid rows touch disjoint rows of A and C, while threads of the same
+    // grid row pack the same rows of A.
+    static int grid_columns(int threads) {
+        int columns = 1;
+        for (int i = 1; i * i <= threads; i++) {
+            if (threads % i == 0) columns = i;
+        }
+        return columns;
+    }
+
+    static UME_FORCE_INLINE void barrier() {
+#if defined(_OPENMP)
+        #pragma omp barrier
+#endif
+    }
+
+    void thread_gemm(
+        int threadId, int threads,
+        int M, int N, int K,
+        FLOAT_T alpha,
+        FLOAT_T const *A, int lda,
+        FLOAT_T const *B, int ldb,
+        FLOAT_T beta,
+        FLOAT_T *C, int ldc)
+    {
+        int gridCols = grid_columns(threads);
+        int gridRows = threads / gridCols;
+        int row = threadId / gridCols;
+        int col = threadId % gridCols;
+        int m0, m1;
+        split_range(M, gridRows, row, MR, m0, m1);
+
+        FLOAT_T *Ap = packedA[threadId];
+
+        for (int jc = 0; jc < N; jc += NC) {
+            int nc = std::min(NC, N - jc);
+            int n0, n1;
+            split_range(nc, gridCols, col, NR, n0, n1);
+            int panelCount = (nc + NR - 1) / NR;
+
+            for (int pc = 0; pc < K; pc += KC) {
+                int kc = std::min(KC, K - pc);
+                FLOAT_T beta_block = (pc == 0) ? beta : FLOAT_T(1.0f);
+
+                // Packed B from the previous iteration must no longer be in use.
+                barrier();
+                for (int p = threadId; p < panelCount; p += threads) {
+                    int j = p * NR;
+                    KERNEL_T::pack_B(kc, std::min(NR, nc - j), &B[pc*ldb + jc + j], ldb, &packedB[j*kc]);
+                }
+                barrier();
+
+                if (n0 >= n1) continue;
+
+                for (int ic = m0; ic < m1; ic += MC) {
+                    int mc = std::min(MC, m1 - ic);
+
+                    KERNEL_T::pack_A(mc, kc, &A[ic*lda + pc], lda, Ap);
+
+                    KERNEL_T::macro_kernel(mc, n1 - n0, kc, alpha, Ap, &packedB[n0*kc], beta_block, &C[ic*ldc + jc + n0], ldc);
+                }
+            }
+        }
+    }
+
+public:
+    UMESimdParallelGemm(int threads) {
+#if defined(_OPENMP)
+        threadCount = std::max(1, threads);
+#else
+        (void)threads;
+        threadCount = 1;
+#endif
+        packedA.resize(threadCount);
+        for (int i = 0; i < threadCount; i++) {
+            packedA[i] = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MC * KC * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        }
+        packedB = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(KC * NC * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+    }
+
+    ~UMESimdParallelGemm() {
+        for (int i = 0; i < threadCount; i++) {
+            UME::DynamicMemory::AlignedFree(packedA[i]);
+        }
+        UME::DynamicMemory::AlignedFree(packedB);
+    }
+
+    int thread_count() const { return threadCount; }
+
+    UME_NEVER_INLINE void gemm(
+        int M, int N, int K,
+        FLOAT_T alpha,
+        FLOAT_T const *A, int lda,
+        FLOAT_T const *B, int ldb,
+        FLOAT_T beta,
+        FLOAT_T *C, int ldc)
+    {
+        if (threadCount == 1) {
+            thread_gemm(0, 1, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+            return;
+        }
+#if defined(_OPENMP)
+        #pragma omp parallel num_threads(threadCount)
+        {
+            // The runtime may provide fewer threads than requested (e.g. nested
+            // parallelism), so the grid is built from the actual team size.
+            thread_gemm(omp_get_thread_num(), omp_get_num_threads(), M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+        }
+#endif
+    }
+
+    UME_FORCE_INLINE void gemm(int N, FLOAT_T alpha, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T beta, FLOAT_T *C) {
+        gemm(N, N, N, alpha, A, N, B, N, beta, C, N);
+    }
+};
+
+#endif
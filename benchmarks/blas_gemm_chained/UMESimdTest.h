@@ -27,241 +27,151 @@
 //  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
 //  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
 //
-
-#pragma once
+#ifndef UME_SIMD_GEMM_BENCH_H_
+#define UME_SIMD_GEMM_BENCH_H_
 
 #include <umesimd/UMESimd.h>
 
-#include "GemvTest.h"
+#include "MatmulTest.h"
+#include "MatmulSplitTest.h"
+#include "UMESimdGemm.h"
+#include "../utilities/UMEScalarToString.h"
+#include "../utilities/UMEThreadPinning.h"
 
 template<typename FLOAT_T, int STRIDE>
 class UMESimdSingleTest : public MatmulSingleTest<FLOAT_T> {
-public:
-    UMESimdSingleTest(int problem_size) : MatmulSingleTest<FLOAT_T>(problem_size) {}
-
-    UME_NEVER_INLINE virtual void benchmarked_code()
-    {
-        int LOOP_COUNT = this->problem_size / STRIDE;
-        int LOOP_PEEL_OFFSET = LOOP_COUNT * STRIDE;
-
-        UME::SIMD::SIMDVec<FLOAT_T, STRIDE> x_vec, a_vec, reduction_vec;
-
-        // Traverse rows of A
-        for (int i = 0; i < this->problem_size; i++)
-        {
-            int row_offset = i * this->problem_size;
-            // Traverse columns of A
-            reduction_vec = FLOAT_T(0.0f);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x[j]);
-                a_vec.load(&this->A[row_offset + j]);
+private:
+    UMESimdGemm<FLOAT_T, STRIDE> *kernel;
 
-                reduction_vec += a_vec * x_vec;
-            }
+public:
+    UMESimdSingleTest(int problem_size) : MatmulSingleTest<FLOAT_T>(problem_size), kernel(nullptr) {}
 
-            // Compute the SIMD part of dot product
-            FLOAT_T reduction = reduction_vec.hadd();
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulSingleTest<FLOAT_T>::initialize();
+        kernel = new UMESimdGemm<FLOAT_T, STRIDE>();
+    }
 
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A[row_offset + j] * this->x[j];
-            }
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        kernel->gemm(this->problem_size, FLOAT_T(1.0f), this->A, this->B, FLOAT_T(0.0f), this->R);
+    }
 
-            this->y[i] = this->alpha * reduction + this->beta * this->y[i];
-        }
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        MatmulSingleTest<FLOAT_T>::cleanup();
     }
 
-    UME_NEVER_INLINE virtual std::string get_test_identifier()
-    {
-        std::string retval = "UME::SIMD single";
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD blocked single, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->problem_size) +
+            ", stride " + std::to_string(STRIDE);
         return retval;
     }
 };
 
 template<typename FLOAT_T, int STRIDE>
-class UMESimdChainedTest : public GemvChainedTest<FLOAT_T> {
+class UMESimdChainedTest : public MatmulChainedTest<FLOAT_T> {
 private:
-    UME_FORCE_INLINE void simd_gemv(int N, FLOAT_T *A, FLOAT_T alpha, FLOAT_T* x, FLOAT_T beta, FLOAT_T* y) {
-
-        int LOOP_COUNT = N / STRIDE;
-        int LOOP_PEEL_OFFSET = LOOP_COUNT * STRIDE;
-
-        UME::SIMD::SIMDVec<FLOAT_T, STRIDE> x_vec, a_vec, reduction_vec;
-
-        // Traverse rows of A
-        for (int i = 0; i < N; i++)
-        {
-            int row_offset = i * N;
-            // Traverse columns of A
-            reduction_vec = FLOAT_T(0.0f);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&x[j]);
-                a_vec.load(&A[row_offset + j]);
-
-                reduction_vec += a_vec * x_vec;
-            }
-
-            // Compute the SIMD part of dot product
-            FLOAT_T reduction = reduction_vec.hadd();
-
-
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < N; j++)
-            {
-                reduction += A[row_offset + j] * x[j];
-            }
-
-            y[i] = alpha * reduction + beta * y[i];
-        }
-    }
+    UMESimdGemm<FLOAT_T, STRIDE> *kernel;
 
 public:
-    UMESimdChainedTest(int problem_size) : GemvChainedTest<FLOAT_T>(problem_size) {}
-
-    UME_NEVER_INLINE virtual void benchmarked_code()
-    {
-        int LOOP_COUNT = this->problem_size / STRIDE;
-        int LOOP_PEEL_OFFSET = LOOP_COUNT * STRIDE;
-        // Traverse 'y'
-        for (int i = 0; i < this->problem_size; i++)
-        {
-            int row_offset = i * this->problem_size;
-            UME::SIMD::SIMDVec<FLOAT_T, STRIDE> x_vec, a_vec, reduction_vec;
-            FLOAT_T reduction;
-            // A0
-UME::SIMD::SIMDVec<FLOAT_T, STRIDE>::prefetch0(&this->A1[row_offset]);
-
-            reduction_vec = FLOAT_T(0.0f);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x0[j]);
-                a_vec.load(&this->A0[row_offset + j]);
-
-                reduction_vec += a_vec * x_vec;
-            }
-
-            reduction = reduction_vec.hadd();
-
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A0[row_offset + j] * this->x0[j];
-            }
-
-            FLOAT_T t0 = this->alpha[0] * reduction + this->beta[0] * this->y[i];
-
-            // A1
-            reduction_vec = FLOAT_T(0.0f);
-UME::SIMD::SIMDVec<FLOAT_T, STRIDE>::prefetch0(&this->A2[row_offset]);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x1[j]);
-                a_vec.load(&this->A1[row_offset + j]);
-
-                reduction_vec += a_vec * x_vec;
-            }
+    UMESimdChainedTest(int problem_size) : MatmulChainedTest<FLOAT_T>(problem_size), kernel(nullptr) {}
 
-            reduction = reduction_vec.hadd();
-
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A1[row_offset + j] * this->x1[j];
-            }
-
-            FLOAT_T t1 = this->alpha[1] * reduction + this->beta[1] * t0;
-
-            // A2
-            reduction_vec = FLOAT_T(0.0f);
-UME::SIMD::SIMDVec<FLOAT_T, STRIDE>::prefetch0(&this->A3[row_offset]);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x2[j]);
-                a_vec.load(&this->A2[row_offset + j]);
-
-                reduction_vec += a_vec * x_vec;
-            }
-
-            reduction = reduction_vec.hadd();
-
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A2[row_offset + j] * this->x2[j];
-            }
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulChainedTest<FLOAT_T>::initialize();
+        kernel = new UMESimdGemm<FLOAT_T, STRIDE>();
+    }
 
-            FLOAT_T t2 = this->alpha[2] * reduction + this->beta[2] * t1;
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        // temp0 = A * B
+        kernel->gemm(this->problem_size, FLOAT_T(1.0f), this->A, this->B, FLOAT_T(0.0f), this->temp0);
+        // R = (A*B) * C
+        kernel->gemm(this->problem_size, FLOAT_T(1.0f), this->temp0, this->C, FLOAT_T(0.0f), this->R);
+    }
 
-            // A3
-            reduction_vec = FLOAT_T(0.0f);
-UME::SIMD::SIMDVec<FLOAT_T, STRIDE>::prefetch0(&this->A4[row_offset]);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x3[j]);
-                a_vec.load(&this->A3[row_offset + j]);
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        MatmulChainedTest<FLOAT_T>::cleanup();
+    }
 
-                reduction_vec += a_vec * x_vec;
-            }
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD blocked chained, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->problem_size) +
+            ", stride " + std::to_string(STRIDE);
+        return retval;
+    }
+};
 
-            reduction = reduction_vec.hadd();
+// Chained GEMM computed by 'thread_count' threads. Threads are pinned once in
+// 'test_init' and the kernel is set up in 'initialize', neither is measured.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdParallelChainedTest : public MatmulChainedTest<FLOAT_T> {
+private:
+    UMESimdParallelGemm<FLOAT_T, STRIDE> *kernel;
+    ThreadPinning *pinning;
+    int thread_count;
 
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A3[row_offset + j] * this->x3[j];
-            }
+public:
+    UMESimdParallelChainedTest(int problem_size, int thread_count) :
+        MatmulChainedTest<FLOAT_T>(problem_size), kernel(nullptr), pinning(nullptr), thread_count(thread_count) {}
 
-            FLOAT_T t3 = this->alpha[3] * reduction + this->beta[3] * t2;
+    UME_NEVER_INLINE virtual void test_init() {
+        pinning = new ThreadPinning(thread_count);
+    }
 
-            // A4
-            reduction_vec = FLOAT_T(0.0f);
-UME::SIMD::SIMDVec<FLOAT_T, STRIDE>::prefetch0(&this->A0[row_offset + this->problem_size]);
-            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE)
-            {
-                // Cannot load aligned because there is no guarantee that
-                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
-                x_vec.load(&this->x4[j]);
-                a_vec.load(&this->A4[row_offset + j]);
+    UME_NEVER_INLINE virtual void test_cleanup() {
+        delete pinning;
+        pinning = nullptr;
+    }
 
-                reduction_vec += a_vec * x_vec;
-            }
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulChainedTest<FLOAT_T>::initialize();
+        kernel = new UMESimdParallelGemm<FLOAT_T, STRIDE>(thread_count);
+    }
 
-            reduction = reduction_vec.hadd();
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        // temp0 = A * B
+        kernel->gemm(this->problem_size, FLOAT_T(1.0f), this->A, this->B, FLOAT_T(0.0f), this->temp0);
+        // R = (A*B) * C
+        kernel->gemm(this->problem_size, FLOAT_T(1.0f), this->temp0, this->C, FLOAT_T(0.0f), this->R);
+    }
 
-            // Use scalar code to handle the reminder of elements.
-            for (int j = LOOP_PEEL_OFFSET; j < this->problem_size; j++)
-            {
-                reduction += this->A4[row_offset + j] * this->x4[j];
-            }
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete kernel;
+        kernel = nullptr;
+        MatmulChainedTest<FLOAT_T>::cleanup();
+    }
 
-            this->y[i] = this->alpha[4] * reduction + this->beta[4] * t3;
-        }
-        /*
-        simd_gemv(this->problem_size, this->A0, this->alpha[0], this->x0, this->beta[0], this->y);
-        simd_gemv(this->problem_size, this->A1, this->alpha[1], this->x1, this->beta[1], this->y);
-        simd_gemv(this->problem_size, this->A2, this->alpha[2], this->x2, this->beta[2], this->y);
-        simd_gemv(this->problem_size, this->A3, this->alpha[3], this->x3, this->beta[3], this->y);
-        simd_gemv(this->problem_size, this->A4, this->alpha[4], this->x4, this->beta[4], this->y);*/
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD blocked chained, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->problem_size) +
+            ", stride " + std::to_string(STRIDE) +
+            " (threads: " + std::to_string(thread_count) + ")";
+        return retval;
     }
+};
 
-    UME_NEVER_INLINE virtual std::string get_test_identifier()
-    {
-        std::string retval = "UME::SIMD chained";
+// Same quadrant decomposition as 'BlasSplitChainedTest', using the native kernel.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdSplitChainedTest : public MatmulSplitChainedTest<FLOAT_T, UMESimdGemm<FLOAT_T, STRIDE>> {
+public:
+    UMESimdSplitChainedTest(int problem_size) : MatmulSplitChainedTest<FLOAT_T, UMESimdGemm<FLOAT_T, STRIDE>>(problem_size) {}
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD split chained, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->problem_size) +
+            ", stride " + std::to_string(STRIDE);
         return retval;
     }
 };
+
+#endif
@@ -44,6 +44,8 @@
 #include "ScalarTest.h"
 #include "BlasTest.h"
 #include "UMESimdTest.h"
+#include "UMESimdMultiRowTest.h"
+#include "UMESimdReducedTest.h"
 #include "UMEVectorTest.h"
 
 int main(int argc, char **argv)
@@ -57,6 +59,7 @@ int main(int argc, char **argv)
 
     std::cout <<
         "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
+        "[Compile with F16C/AVX2 (e.g. -march=native) for hardware fp16/bf16 conversion, scalar conversion is used otherwise]\n"
         "\n"
         "This benchmark measures execution of Y = a * A * X + b *Y (GEMV) kernel.\n"
         "Two modes are being measured:\n"
@@ -84,6 +87,13 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UMESimdSingleTest<float, 8>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 16>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 32>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<float, 8, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<float, 8, 8>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<float, 16, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowTransposedTest<float, 8, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowTransposedTest<float, 8, 8>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<float16_t, 8, 4>(i));
+        newCategory->registerTest(new UMESimdReducedSingleTest<bfloat16_t, 8, 4>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -103,6 +113,11 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UMESimdSingleTest<double, 4>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 8>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 16>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<double, 4, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<double, 4, 8>(i));
+        newCategory->registerTest(new UMESimdMultiRowSingleTest<double, 8, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowTransposedTest<double, 4, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowTransposedTest<double, 4, 8>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -123,6 +138,8 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UMESimdChainedTest<float, 8>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 16>(i));
         newCategory->registerTest(new UMESimdChainedTest<float, 32>(i));
+        newCategory->registerTest(new UMESimdMultiRowChainedTest<float, 8, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowChainedTest<float, 8, 8>(i));
 
         harness.registerTestCategory(newCategory);
     }
@@ -142,6 +159,8 @@ int main(int argc, char **argv)
         newCategory->registerTest(new UMESimdChainedTest<double, 4>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 8>(i));
         newCategory->registerTest(new UMESimdChainedTest<double, 16>(i));
+        newCategory->registerTest(new UMESimdMultiRowChainedTest<double, 4, 4>(i));
+        newCategory->registerTest(new UMESimdMultiRowChainedTest<double, 4, 8>(i));
 
         harness.registerTestCategory(newCategory);
     }
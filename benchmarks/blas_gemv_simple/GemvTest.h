@@ -52,9 +52,12 @@ protected:
     BigFloat *y_expected;
 
     int problem_size;
+    // Verify 'y = alpha * A^T * x + beta * y' instead of 'y = alpha * A * x + beta * y'
+    bool transposed;
 
 public:
-    GemvSingleTest(int problem_size) : Test(true), problem_size(problem_size) {}
+    GemvSingleTest(int problem_size, bool transposed = false) :
+        Test(true), problem_size(problem_size), transposed(transposed) {}
 
     UME_NEVER_INLINE virtual void initialize() {
         A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(problem_size * problem_size * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
@@ -96,9 +99,10 @@ public:
             BigFloat prod = 0;
             for (int j = 0; j < problem_size; j++)
             {
-                prod += BigFloat(A[row_offset + j]) *BigFloat(x[j]);
+                FLOAT_T a = transposed ? A[j * problem_size + i] : A[row_offset + j];
+                prod += BigFloat(a) *BigFloat(x[j]);
             }
-            y_expected[i] = BigFloat(alpha) * prod + BigFloat(beta) * BigFloat(y[i]);
+            y_expected[i] = BigFloat(alpha) * prod + BigFloat(beta) * y_expected[i];
         }
 
         // Calculate infinty norm
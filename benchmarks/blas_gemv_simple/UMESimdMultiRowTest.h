@@ -0,0 +1,244 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#pragma once
+
+#include <umesimd/UMESimd.h>
+
+#include "GemvTest.h"
+
+#include "../utilities/UMEScalarToString.h"
+
+// GEMV kernels processing ROWS rows of A at once.
+//
+// y = alpha * A * x + beta * y:
+//   Every loaded chunk of 'x' is multiplied with ROWS chunks of A, accumulating into
+//   ROWS independent accumulators, so 'x' is read only once per block of rows.
+//   At the end of the block the accumulators are transposed into a STRIDE x ROWS tile
+//   which is added column-wise, so the ROWS sums come out of vector additions in one
+//   vector instead of ROWS separate 'hadd' reductions, and the update of 'y' is done
+//   on ROWS elements at once. Leftover rows are reduced with 'hadd'.
+//
+// y = alpha * A^T * x + beta * y:
+//   Rows of A are traversed contiguously. For every chunk of 'y', contributions of
+//   ROWS rows (each scaled by 'alpha * x[i]') are accumulated before 'y' is stored
+//   again, so 'y' is read and written once per block of rows instead of once per row.
+template<typename FLOAT_T, int STRIDE, int ROWS>
+class UMESimdMultiRowGemv {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+    typedef UME::SIMD::SIMDVec<FLOAT_T, ROWS> ROW_VEC_T;
+
+    // acc[r] = sum(A[i+r, j:j+STRIDE] * x[j:j+STRIDE]) over the vectorized part of a row
+    template<int R>
+    static UME_FORCE_INLINE void accumulate_rows(int N, int i, FLOAT_T const *A, FLOAT_T const *x, VEC_T *acc) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec, a_vec;
+        for (int r = 0; r < R; r++) acc[r] = FLOAT_T(0.0f);
+
+        for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+            x_vec.load(&x[j]);
+            for (int r = 0; r < R; r++) {
+                // Cannot load aligned because there is no guarantee that
+                // all rows are aligned to the OPTIMAL_ALIGNMENT boundaries.
+                a_vec.load(&A[(i + r)*N + j]);
+                acc[r] = a_vec.fmuladd(x_vec, acc[r]);
+            }
+        }
+    }
+
+    // y[i:i+ROWS] = alpha * A[i:i+ROWS, :] * x + beta * y[i:i+ROWS]
+    static UME_FORCE_INLINE void rows_block(int N, int i, FLOAT_T const *A, FLOAT_T alpha, FLOAT_T const *x, FLOAT_T beta, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T acc[ROWS];
+        accumulate_rows<ROWS>(N, i, A, x, acc);
+
+        // Transpose the accumulators into a STRIDE x ROWS tile: row 'l' of the tile
+        // holds lane 'l' of every accumulator, so adding the tile column-wise gives
+        // all ROWS sums in a single vector.
+        alignas(64) FLOAT_T lanes[STRIDE];
+        alignas(64) FLOAT_T tile[STRIDE*ROWS];
+        for (int r = 0; r < ROWS; r++) {
+            acc[r].storea(lanes);
+            for (int l = 0; l < STRIDE; l++) tile[l*ROWS + r] = lanes[l];
+        }
+
+        ROW_VEC_T sum_vec, t_vec;
+        sum_vec.loada(&tile[0]);
+        for (int l = 1; l < STRIDE; l++) {
+            t_vec.loada(&tile[l*ROWS]);
+            sum_vec.adda(t_vec);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        if (LOOP_PEEL_OFFSET < N) {
+            alignas(64) FLOAT_T rem[ROWS];
+            for (int r = 0; r < ROWS; r++) rem[r] = FLOAT_T(0.0f);
+            for (int j = LOOP_PEEL_OFFSET; j < N; j++) {
+                for (int r = 0; r < ROWS; r++) rem[r] += A[(i + r)*N + j] * x[j];
+            }
+            t_vec.loada(rem);
+            sum_vec.adda(t_vec);
+        }
+
+        ROW_VEC_T y_vec;
+        y_vec.load(&y[i]);
+        sum_vec.fmuladd(ROW_VEC_T(alpha), y_vec * beta).store(&y[i]);
+    }
+
+    // y[i] = alpha * A[i, :] * x + beta * y[i]
+    static UME_FORCE_INLINE void single_row(int N, int i, FLOAT_T const *A, FLOAT_T alpha, FLOAT_T const *x, FLOAT_T beta, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T acc[1];
+        accumulate_rows<1>(N, i, A, x, acc);
+
+        FLOAT_T sum = acc[0].hadd();
+        for (int j = LOOP_PEEL_OFFSET; j < N; j++) sum += A[i*N + j] * x[j];
+        y[i] = alpha * sum + beta * y[i];
+    }
+
+    // y += sum(alpha * x[i+r] * A[i+r, :]) for r in [0, R)
+    template<int R>
+    static UME_FORCE_INLINE void transposed_rows_block(int N, int i, FLOAT_T const *A, FLOAT_T alpha, FLOAT_T const *x, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T coeff[R];
+        for (int r = 0; r < R; r++) coeff[r] = alpha * x[i + r];
+
+        VEC_T y_vec, a_vec;
+        for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+            y_vec.load(&y[j]);
+            for (int r = 0; r < R; r++) {
+                a_vec.load(&A[(i + r)*N + j]);
+                y_vec = a_vec.fmuladd(coeff[r], y_vec);
+            }
+            y_vec.store(&y[j]);
+        }
+
+        for (int j = LOOP_PEEL_OFFSET; j < N; j++) {
+            FLOAT_T t0 = y[j];
+            for (int r = 0; r < R; r++) t0 += alpha * x[i + r] * A[(i + r)*N + j];
+            y[j] = t0;
+        }
+    }
+
+public:
+    static UME_FORCE_INLINE void gemv(int N, FLOAT_T const *A, FLOAT_T alpha, FLOAT_T const *x, FLOAT_T beta, FLOAT_T *y) {
+        int ROW_PEEL_OFFSET = (N / ROWS) * ROWS;
+        for (int i = 0; i < ROW_PEEL_OFFSET; i += ROWS) {
+            rows_block(N, i, A, alpha, x, beta, y);
+        }
+        for (int i = ROW_PEEL_OFFSET; i < N; i++) {
+            single_row(N, i, A, alpha, x, beta, y);
+        }
+    }
+
+    static UME_FORCE_INLINE void gemv_transposed(int N, FLOAT_T const *A, FLOAT_T alpha, FLOAT_T const *x, FLOAT_T beta, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+        VEC_T y_vec;
+        for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+            y_vec.load(&y[j]);
+            (y_vec * beta).store(&y[j]);
+        }
+        for (int j = LOOP_PEEL_OFFSET; j < N; j++) y[j] *= beta;
+
+        int ROW_PEEL_OFFSET = (N / ROWS) * ROWS;
+        for (int i = 0; i < ROW_PEEL_OFFSET; i += ROWS) {
+            transposed_rows_block<ROWS>(N, i, A, alpha, x, y);
+        }
+        for (int i = ROW_PEEL_OFFSET; i < N; i++) {
+            transposed_rows_block<1>(N, i, A, alpha, x, y);
+        }
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int ROWS>
+class UMESimdMultiRowSingleTest : public GemvSingleTest<FLOAT_T> {
+public:
+    UMESimdMultiRowSingleTest(int problem_size) : GemvSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UMESimdMultiRowGemv<FLOAT_T, STRIDE, ROWS>::gemv(this->problem_size, this->A, this->alpha, this->x, this->beta, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD multi-row single, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(STRIDE) + ", rows: " + std::to_string(ROWS);
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int ROWS>
+class UMESimdMultiRowTransposedTest : public GemvSingleTest<FLOAT_T> {
+public:
+    UMESimdMultiRowTransposedTest(int problem_size) : GemvSingleTest<FLOAT_T>(problem_size, true) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UMESimdMultiRowGemv<FLOAT_T, STRIDE, ROWS>::gemv_transposed(this->problem_size, this->A, this->alpha, this->x, this->beta, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD multi-row transposed, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(STRIDE) + ", rows: " + std::to_string(ROWS);
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int ROWS>
+class UMESimdMultiRowChainedTest : public GemvChainedTest<FLOAT_T> {
+public:
+    UMESimdMultiRowChainedTest(int problem_size) : GemvChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        typedef UMESimdMultiRowGemv<FLOAT_T, STRIDE, ROWS> KERNEL_T;
+        KERNEL_T::gemv(this->problem_size, this->A0, this->alpha[0], this->x0, this->beta[0], this->y);
+        KERNEL_T::gemv(this->problem_size, this->A1, this->alpha[1], this->x1, this->beta[1], this->y);
+        KERNEL_T::gemv(this->problem_size, this->A2, this->alpha[2], this->x2, this->beta[2], this->y);
+        KERNEL_T::gemv(this->problem_size, this->A3, this->alpha[3], this->x3, this->beta[3], this->y);
+        KERNEL_T::gemv(this->problem_size, this->A4, this->alpha[4], this->x4, this->beta[4], this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD multi-row chained, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(STRIDE) + ", rows: " + std::to_string(ROWS);
+        return retval;
+    }
+};
@@ -0,0 +1,157 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#pragma once
+
+#include <algorithm>
+
+#include <umesimd/UMESimd.h>
+
+#include "GemvTest.h"
+
+#include "../utilities/UMEReducedPrecision.h"
+
+// y = alpha * A * x + beta * y with A and x stored in 16-bit precision (STORAGE_T:
+// float16_t or bfloat16_t) and y kept in 'float'. 'x' is converted once per call.
+// A is traversed in blocks of ROWS rows: for every column tile, ROWS tiles of A
+// are converted to 'float' and accumulated in single precision into ROWS
+// independent accumulators, as in 'UMESimdMultiRowGemv'.
+template<typename STORAGE_T, int STRIDE, int ROWS>
+class UMESimdReducedGemv {
+private:
+    static const int TILE = REDUCED_PRECISION_TILE;
+    static_assert(TILE % STRIDE == 0, "TILE has to be a multiple of STRIDE");
+
+    typedef ReducedPrecision<STORAGE_T> CONVERT_T;
+    typedef UME::SIMD::SIMDVec<float, STRIDE> VEC_T;
+
+    // y[i:i+R] = alpha * A[i:i+R, :] * x + beta * y[i:i+R]
+    template<int R>
+    static UME_FORCE_INLINE void rows_block(int N, int i, STORAGE_T const *A, float alpha, float const *x, float beta, float *y, float *a_tile) {
+        VEC_T x_vec, a_vec;
+        VEC_T acc[R];
+        float sums[R];
+        for (int r = 0; r < R; r++) {
+            acc[r] = 0.0f;
+            sums[r] = 0.0f;
+        }
+
+        for (int j = 0; j < N; j += TILE) {
+            int length = std::min(TILE, N - j);
+            int LOOP_PEEL_OFFSET = (length / STRIDE) * STRIDE;
+
+            for (int r = 0; r < R; r++) {
+                CONVERT_T::convert_to_float(length, &A[(i + r)*N + j], &a_tile[r*TILE]);
+            }
+
+            for (int k = 0; k < LOOP_PEEL_OFFSET; k += STRIDE) {
+                x_vec.loada(&x[j + k]);
+                for (int r = 0; r < R; r++) {
+                    a_vec.loada(&a_tile[r*TILE + k]);
+                    acc[r] = a_vec.fmuladd(x_vec, acc[r]);
+                }
+            }
+
+            // Use scalar code to handle the reminder of elements.
+            for (int k = LOOP_PEEL_OFFSET; k < length; k++) {
+                for (int r = 0; r < R; r++) sums[r] += a_tile[r*TILE + k] * x[j + k];
+            }
+        }
+
+        for (int r = 0; r < R; r++) {
+            y[i + r] = alpha * (acc[r].hadd() + sums[r]) + beta * y[i + r];
+        }
+    }
+
+public:
+    static const int A_TILE_SIZE = ROWS * TILE;
+
+    // 'x_float' is a buffer of N elements and 'a_tile' a buffer of ROWS*TILE
+    // elements, aligned to the SIMD vector size.
+    static UME_FORCE_INLINE void gemv(int N, STORAGE_T const *A, float alpha, STORAGE_T const *x, float beta, float *y,
+                                      float *x_float, float *a_tile) {
+        CONVERT_T::convert_to_float(N, x, x_float);
+
+        int ROW_PEEL_OFFSET = (N / ROWS) * ROWS;
+        for (int i = 0; i < ROW_PEEL_OFFSET; i += ROWS) {
+            rows_block<ROWS>(N, i, A, alpha, x_float, beta, y, a_tile);
+        }
+        for (int i = ROW_PEEL_OFFSET; i < N; i++) {
+            rows_block<1>(N, i, A, alpha, x_float, beta, y, a_tile);
+        }
+    }
+};
+
+// Storage copies of A and x are created in 'initialize', outside of the measured
+// code, so only the per-call conversion of tiles is benchmarked.
+template<typename STORAGE_T, int STRIDE, int ROWS>
+class UMESimdReducedSingleTest : public GemvSingleTest<float> {
+private:
+    typedef UMESimdReducedGemv<STORAGE_T, STRIDE, ROWS> GEMV_T;
+
+    STORAGE_T *A_storage, *x_storage;
+    float *x_float, *a_tile;
+
+public:
+    UMESimdReducedSingleTest(int problem_size) : GemvSingleTest<float>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize()
+    {
+        GemvSingleTest<float>::initialize();
+
+        A_storage = (STORAGE_T *)UME::DynamicMemory::AlignedMalloc(sizeof(STORAGE_T)*problem_size*problem_size, OPTIMAL_ALIGNMENT);
+        x_storage = (STORAGE_T *)UME::DynamicMemory::AlignedMalloc(sizeof(STORAGE_T)*problem_size, OPTIMAL_ALIGNMENT);
+        x_float = (float *)UME::DynamicMemory::AlignedMalloc(sizeof(float)*problem_size, OPTIMAL_ALIGNMENT);
+        a_tile = (float *)UME::DynamicMemory::AlignedMalloc(sizeof(float)*GEMV_T::A_TILE_SIZE, OPTIMAL_ALIGNMENT);
+
+        ReducedPrecision<STORAGE_T>::convert_from_float(problem_size*problem_size, A, A_storage);
+        ReducedPrecision<STORAGE_T>::convert_from_float(problem_size, x, x_storage);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        GEMV_T::gemv(problem_size, A_storage, alpha, x_storage, beta, y, x_float, a_tile);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        UME::DynamicMemory::AlignedFree(A_storage);
+        UME::DynamicMemory::AlignedFree(x_storage);
+        UME::DynamicMemory::AlignedFree(x_float);
+        UME::DynamicMemory::AlignedFree(a_tile);
+        GemvSingleTest<float>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD single, " + ReducedPrecision<STORAGE_T>::name() +
+            " storage, " + std::to_string(ROWS) + " rows (SIMD: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
@@ -0,0 +1,156 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#include <iostream>
+#include <memory>
+
+#include <cmath>
+#include <time.h>
+#include <stdlib.h>
+#include <string>
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/TimingStatistics.h"
+#include "../utilities/MeasurementHarness.h"
+
+#include "ScalarTest.h"
+#include "BlasTest.h"
+#include "UMESimdTest.h"
+#include "UMEVectorTest.h"
+
+TestCategory *create_category(std::string name, int precision, int problem_size) {
+    TestCategory *newCategory = new TestCategory(name);
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), precision));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), problem_size));
+    return newCategory;
+}
+
+// STRIDE0 and STRIDE1 are SIMD strides for 256b and 512b registers.
+template<typename FLOAT_T, int STRIDE0, int STRIDE1>
+void register_categories(BenchmarkHarness & harness, int i, FLOAT_T large_magnitude) {
+    int precision = 8 * sizeof(FLOAT_T);
+    TestCategory *newCategory;
+
+    newCategory = create_category("BLAS_SCAL_single", precision, i);
+    newCategory->registerTest(new ScalarScalSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasScalSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorScalSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdScalSingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdScalSingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_COPY_single", precision, i);
+    newCategory->registerTest(new ScalarCopySingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasCopySingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorCopySingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdCopySingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdCopySingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_SWAP_single", precision, i);
+    newCategory->registerTest(new ScalarSwapSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasSwapSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorSwapSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdSwapSingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdSwapSingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_NRM2_single", precision, i);
+    newCategory->registerTest(new ScalarNrm2SingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasNrm2SingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorNrm2SingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdNrm2SingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdNrm2SingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    // Squares of the elements overflow, the scaled path of the kernels is measured.
+    newCategory = create_category("BLAS_NRM2_large", precision, i);
+    newCategory->registerTest(new ScalarNrm2SingleTest<FLOAT_T>(i, large_magnitude));
+    newCategory->registerTest(new BlasNrm2SingleTest<FLOAT_T>(i, large_magnitude));
+    newCategory->registerTest(new UMEVectorNrm2SingleTest<FLOAT_T>(i, large_magnitude));
+    newCategory->registerTest(new UMESimdNrm2SingleTest<FLOAT_T, STRIDE0>(i, large_magnitude));
+    newCategory->registerTest(new UMESimdNrm2SingleTest<FLOAT_T, STRIDE1>(i, large_magnitude));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_ASUM_single", precision, i);
+    newCategory->registerTest(new ScalarAsumSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasAsumSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorAsumSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdAsumSingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdAsumSingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_IAMAX_single", precision, i);
+    newCategory->registerTest(new ScalarIamaxSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasIamaxSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorIamaxSingleTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdIamaxSingleTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdIamaxSingleTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+
+    newCategory = create_category("BLAS_NORMALIZE_chained", precision, i);
+    newCategory->registerTest(new ScalarNormalizeChainedTest<FLOAT_T>(i));
+    newCategory->registerTest(new BlasNormalizeChainedTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMEVectorNormalizeChainedTest<FLOAT_T>(i));
+    newCategory->registerTest(new UMESimdNormalizeChainedTest<FLOAT_T, STRIDE0>(i));
+    newCategory->registerTest(new UMESimdNormalizeChainedTest<FLOAT_T, STRIDE1>(i));
+    harness.registerTestCategory(newCategory);
+}
+
+int main(int argc, char **argv)
+{
+    int MIN_SIZE = 1;
+    int MAX_SIZE = 67108864;
+    int PROGRESSION = 4;
+    int ITERATIONS = 10;
+
+    BenchmarkHarness harness(argc, argv);
+
+    std::cout <<
+        "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
+        "[Run with -v to verify results and report the error of each variant]\n"
+        "\n"
+        "This benchmark measures execution of the remaining level 1 BLAS kernels:\n"
+        " - X = a * X (SCAL), Y = X (COPY), (X, Y) = (Y, X) (SWAP)\n"
+        " - a = ||X||_2 (NRM2), a = sum(|X|) (ASUM), i = argmax(|X|) (IAMAX)\n"
+        "NRM2 is also measured with elements large enough for their squares to\n"
+        "overflow. Chained mode measures Y = X / ||X||_2.\n\n";
+
+    for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
+        register_categories<float, 8, 16>(harness, i, 1.0e30f);
+    }
+
+    for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
+        register_categories<double, 4, 8>(harness, i, 1.0e300);
+    }
+
+    harness.runTests(ITERATIONS);
+}
@@ -0,0 +1,257 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef BLAS_LEVEL1_BENCH_H_
+#define BLAS_LEVEL1_BENCH_H_
+
+#include <assert.h>
+
+#include <umesimd/UMESimd.h>
+
+#include "Level1Test.h"
+#include "../utilities/UMEScalarToString.h"
+
+#ifdef USE_BLAS
+#include <cblas.h>
+
+template<typename FLOAT_T>
+class Level1_kernel {
+    // Only specializations of this class should be allowed.
+private:
+    Level1_kernel() {}
+    ~Level1_kernel() {}
+};
+
+template<>
+class Level1_kernel<float> {
+public:
+    UME_FORCE_INLINE static void blas_scal(int N, float a, float *x) { cblas_sscal(N, a, x, 1); }
+    UME_FORCE_INLINE static void blas_copy(int N, float *x, float *y) { cblas_scopy(N, x, 1, y, 1); }
+    UME_FORCE_INLINE static void blas_swap(int N, float *x, float *y) { cblas_sswap(N, x, 1, y, 1); }
+    UME_FORCE_INLINE static float blas_nrm2(int N, float *x) { return cblas_snrm2(N, x, 1); }
+    UME_FORCE_INLINE static float blas_asum(int N, float *x) { return cblas_sasum(N, x, 1); }
+    UME_FORCE_INLINE static int blas_iamax(int N, float *x) { return (int)cblas_isamax(N, x, 1); }
+};
+
+template<>
+class Level1_kernel<double> {
+public:
+    UME_FORCE_INLINE static void blas_scal(int N, double a, double *x) { cblas_dscal(N, a, x, 1); }
+    UME_FORCE_INLINE static void blas_copy(int N, double *x, double *y) { cblas_dcopy(N, x, 1, y, 1); }
+    UME_FORCE_INLINE static void blas_swap(int N, double *x, double *y) { cblas_dswap(N, x, 1, y, 1); }
+    UME_FORCE_INLINE static double blas_nrm2(int N, double *x) { return cblas_dnrm2(N, x, 1); }
+    UME_FORCE_INLINE static double blas_asum(int N, double *x) { return cblas_dasum(N, x, 1); }
+    UME_FORCE_INLINE static int blas_iamax(int N, double *x) { return (int)cblas_idamax(N, x, 1); }
+};
+
+template<typename FLOAT_T>
+class BlasScalSingleTest : public ScalSingleTest<FLOAT_T> {
+public:
+    BlasScalSingleTest(int problem_size) : ScalSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        Level1_kernel<FLOAT_T>::blas_scal(this->problem_size, this->alpha, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasCopySingleTest : public CopySingleTest<FLOAT_T> {
+public:
+    BlasCopySingleTest(int problem_size) : CopySingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        Level1_kernel<FLOAT_T>::blas_copy(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasSwapSingleTest : public SwapSingleTest<FLOAT_T> {
+public:
+    BlasSwapSingleTest(int problem_size) : SwapSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        Level1_kernel<FLOAT_T>::blas_swap(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasNrm2SingleTest : public Nrm2SingleTest<FLOAT_T> {
+public:
+    BlasNrm2SingleTest(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) : Nrm2SingleTest<FLOAT_T>(problem_size, magnitude) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->nrm2_result = Level1_kernel<FLOAT_T>::blas_nrm2(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasAsumSingleTest : public AsumSingleTest<FLOAT_T> {
+public:
+    BlasAsumSingleTest(int problem_size) : AsumSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->asum_result = Level1_kernel<FLOAT_T>::blas_asum(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasIamaxSingleTest : public IamaxSingleTest<FLOAT_T> {
+public:
+    BlasIamaxSingleTest(int problem_size) : IamaxSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->iamax_result = Level1_kernel<FLOAT_T>::blas_iamax(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasNormalizeChainedTest : public NormalizeChainedTest<FLOAT_T> {
+public:
+    BlasNormalizeChainedTest(int problem_size) : NormalizeChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        Level1_kernel<FLOAT_T>::blas_copy(this->problem_size, this->x, this->y);
+        FLOAT_T nrm2 = Level1_kernel<FLOAT_T>::blas_nrm2(this->problem_size, this->y);
+        Level1_kernel<FLOAT_T>::blas_scal(this->problem_size, FLOAT_T(1.0f) / nrm2, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS scal(1/nrm2(y), copy(x, y))";
+        return retval;
+    }
+};
+
+#else
+
+// Blas requires external dependencies. This fallback prevents
+// compile time error, allowing the user to decide whether to 
+// enable BLAS interface or not.
+template<typename FLOAT_T>
+class BlasDisabledTest : public Test {
+public:
+    int problem_size;
+
+    BlasDisabledTest(int problem_size) : Test(false), problem_size(problem_size) {}
+
+    // All the member functions are forced to never inline,
+    // so that the compiler doesn't make any opportunistic guesses.
+    // Since the cost consuming part of the benchmark, contained
+    // in 'benchmarked_code' is measured all at once, the 
+    // measurement offset caused by virtual function call should be
+    // negligible.
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class BlasScalSingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasScalSingleTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasCopySingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasCopySingleTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasSwapSingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasSwapSingleTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasNrm2SingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasNrm2SingleTest(int problem_size, FLOAT_T = FLOAT_T(1.0f)) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasAsumSingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasAsumSingleTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasIamaxSingleTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasIamaxSingleTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+};
+
+template<typename FLOAT_T>
+class BlasNormalizeChainedTest : public BlasDisabledTest<FLOAT_T> {
+public:
+    BlasNormalizeChainedTest(int problem_size) : BlasDisabledTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "BLAS scal(1/nrm2(y), copy(x, y))";
+        return retval;
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,213 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef LEVEL1_BENCH_H_
+#define LEVEL1_BENCH_H_
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+#include "../utilities/ttmath/ttmath/ttmath.h"
+
+// Common data of level 1 kernels. Vectors are initialized with random numbers in
+// range (-magnitude;magnitude). Initial values are kept for verification.
+template<typename FLOAT_T>
+class Level1Test : public Test {
+protected:
+    static const int OPTIMAL_ALIGNMENT = 64;
+    typedef ttmath::Big<8, 8> BigFloat;
+
+    FLOAT_T *x, *y;
+    FLOAT_T *x_initial, *y_initial;
+    FLOAT_T alpha;
+    FLOAT_T magnitude;
+
+    int problem_size;
+
+    // max|result - factor * source| / max|factor * source|
+    BigFloat vector_error(FLOAT_T const *result, FLOAT_T const *source, BigFloat factor) {
+        BigFloat max_err = 0;
+        BigFloat norm = 0;
+        for (int i = 0; i < problem_size; i++) {
+            BigFloat expected = factor * BigFloat(source[i]);
+            BigFloat diff = ttmath::Abs(BigFloat(result[i]) - expected);
+            max_err = max_err > diff ? max_err : diff;
+            BigFloat expected_abs = ttmath::Abs(expected);
+            norm = norm > expected_abs ? norm : expected_abs;
+        }
+        return norm > 0 ? max_err / norm : max_err;
+    }
+
+    BigFloat expected_nrm2() {
+        BigFloat sum = 0;
+        for (int i = 0; i < problem_size; i++) {
+            sum += BigFloat(x_initial[i]) * BigFloat(x_initial[i]);
+        }
+        return ttmath::Sqrt(sum);
+    }
+
+public:
+    Level1Test(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) :
+        Test(true), magnitude(magnitude), problem_size(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        x = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+        y = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+        x_initial = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+        y_initial = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data
+        for (int i = 0; i < problem_size; i++)
+        {
+            // Generate random numbers in range (-magnitude;magnitude)
+            x[i] = magnitude * (FLOAT_T(2.0f) * static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) - FLOAT_T(1.0f));
+            y[i] = magnitude * (FLOAT_T(2.0f) * static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) - FLOAT_T(1.0f));
+            x_initial[i] = x[i];
+            y_initial[i] = y[i];
+        }
+
+        alpha = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+        UME::DynamicMemory::AlignedFree(x_initial);
+        UME::DynamicMemory::AlignedFree(y_initial);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+// X = alpha * X
+template<typename FLOAT_T>
+class ScalSingleTest : public Level1Test<FLOAT_T> {
+public:
+    ScalSingleTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        this->error_norm_bignum = this->vector_error(this->x, this->x_initial, this->alpha);
+    }
+};
+
+// Y = X
+template<typename FLOAT_T>
+class CopySingleTest : public Level1Test<FLOAT_T> {
+public:
+    CopySingleTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        this->error_norm_bignum = this->vector_error(this->y, this->x_initial, 1);
+    }
+};
+
+// (X, Y) = (Y, X)
+template<typename FLOAT_T>
+class SwapSingleTest : public Level1Test<FLOAT_T> {
+public:
+    SwapSingleTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        typename Level1Test<FLOAT_T>::BigFloat x_err = this->vector_error(this->x, this->y_initial, 1);
+        typename Level1Test<FLOAT_T>::BigFloat y_err = this->vector_error(this->y, this->x_initial, 1);
+        this->error_norm_bignum = x_err > y_err ? x_err : y_err;
+    }
+};
+
+// a = sqrt(sum(X[i]^2)). Kernels have to avoid overflow and underflow of
+// intermediate results, 'magnitude' is used to test that.
+template<typename FLOAT_T>
+class Nrm2SingleTest : public Level1Test<FLOAT_T> {
+protected:
+    FLOAT_T nrm2_result;
+
+public:
+    Nrm2SingleTest(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) : Level1Test<FLOAT_T>(problem_size, magnitude) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        typename Level1Test<FLOAT_T>::BigFloat expected = this->expected_nrm2();
+        this->error_norm_bignum = ttmath::Abs(expected - typename Level1Test<FLOAT_T>::BigFloat(nrm2_result)) / expected;
+    }
+};
+
+// a = sum(|X[i]|)
+template<typename FLOAT_T>
+class AsumSingleTest : public Level1Test<FLOAT_T> {
+protected:
+    FLOAT_T asum_result;
+
+public:
+    AsumSingleTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        typename Level1Test<FLOAT_T>::BigFloat expected = 0;
+        for (int i = 0; i < this->problem_size; i++) {
+            expected += ttmath::Abs(typename Level1Test<FLOAT_T>::BigFloat(this->x_initial[i]));
+        }
+        this->error_norm_bignum = ttmath::Abs(expected - typename Level1Test<FLOAT_T>::BigFloat(asum_result)) / expected;
+    }
+};
+
+// i = first index of max(|X[i]|). The error is 0 for the correct index and 1 otherwise.
+template<typename FLOAT_T>
+class IamaxSingleTest : public Level1Test<FLOAT_T> {
+protected:
+    int iamax_result;
+
+public:
+    IamaxSingleTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        int expected = 0;
+        for (int i = 1; i < this->problem_size; i++) {
+            if (std::abs(this->x_initial[i]) > std::abs(this->x_initial[expected])) expected = i;
+        }
+        this->error_norm_bignum = (iamax_result == expected) ? 0 : 1;
+    }
+};
+
+// Chained execution: Y = X / nrm2(X), implemented with copy, nrm2 and scal kernels.
+template<typename FLOAT_T>
+class NormalizeChainedTest : public Level1Test<FLOAT_T> {
+public:
+    NormalizeChainedTest(int problem_size) : Level1Test<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void verify() {
+        typename Level1Test<FLOAT_T>::BigFloat factor = 1;
+        factor /= this->expected_nrm2();
+        this->error_norm_bignum = this->vector_error(this->y, this->x_initial, factor);
+    }
+};
+
+#endif
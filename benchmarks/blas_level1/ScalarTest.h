@@ -0,0 +1,206 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef SCALAR_LEVEL1_BENCH_H_
+#define SCALAR_LEVEL1_BENCH_H_
+
+#include <cmath>
+
+#include <umesimd/UMESimd.h>
+
+#include "Level1Test.h"
+
+#include "../utilities/UMEScalarToString.h"
+
+// Reference scalar kernels, written as in reference BLAS.
+template<typename FLOAT_T>
+struct ScalarLevel1 {
+    static UME_FORCE_INLINE void scal(int N, FLOAT_T alpha, FLOAT_T *x) {
+        for (int i = 0; i < N; i++) x[i] = alpha * x[i];
+    }
+
+    static UME_FORCE_INLINE void copy(int N, FLOAT_T const *x, FLOAT_T *y) {
+        for (int i = 0; i < N; i++) y[i] = x[i];
+    }
+
+    static UME_FORCE_INLINE void swap(int N, FLOAT_T *x, FLOAT_T *y) {
+        for (int i = 0; i < N; i++) {
+            FLOAT_T t0 = x[i];
+            x[i] = y[i];
+            y[i] = t0;
+        }
+    }
+
+    // Single pass with a running scale: sum of squares is kept as 'scale^2 * ssq'
+    // with 'scale' being the largest absolute value seen so far.
+    static UME_FORCE_INLINE FLOAT_T nrm2(int N, FLOAT_T const *x) {
+        FLOAT_T scale = FLOAT_T(0.0f);
+        FLOAT_T ssq = FLOAT_T(1.0f);
+        for (int i = 0; i < N; i++) {
+            if (x[i] != FLOAT_T(0.0f)) {
+                FLOAT_T t0 = std::abs(x[i]);
+                if (scale < t0) {
+                    ssq = FLOAT_T(1.0f) + ssq * (scale / t0) * (scale / t0);
+                    scale = t0;
+                }
+                else {
+                    ssq += (t0 / scale) * (t0 / scale);
+                }
+            }
+        }
+        return scale * std::sqrt(ssq);
+    }
+
+    static UME_FORCE_INLINE FLOAT_T asum(int N, FLOAT_T const *x) {
+        FLOAT_T sum = FLOAT_T(0.0f);
+        for (int i = 0; i < N; i++) sum += std::abs(x[i]);
+        return sum;
+    }
+
+    static UME_FORCE_INLINE int iamax(int N, FLOAT_T const *x) {
+        int index = 0;
+        FLOAT_T max = std::abs(x[0]);
+        for (int i = 1; i < N; i++) {
+            if (std::abs(x[i]) > max) {
+                index = i;
+                max = std::abs(x[i]);
+            }
+        }
+        return index;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarScalSingleTest : public ScalSingleTest<FLOAT_T> {
+public:
+    ScalarScalSingleTest(int problem_size) : ScalSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        ScalarLevel1<FLOAT_T>::scal(this->problem_size, this->alpha, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarCopySingleTest : public CopySingleTest<FLOAT_T> {
+public:
+    ScalarCopySingleTest(int problem_size) : CopySingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        ScalarLevel1<FLOAT_T>::copy(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarSwapSingleTest : public SwapSingleTest<FLOAT_T> {
+public:
+    ScalarSwapSingleTest(int problem_size) : SwapSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        ScalarLevel1<FLOAT_T>::swap(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarNrm2SingleTest : public Nrm2SingleTest<FLOAT_T> {
+public:
+    ScalarNrm2SingleTest(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) : Nrm2SingleTest<FLOAT_T>(problem_size, magnitude) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->nrm2_result = ScalarLevel1<FLOAT_T>::nrm2(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarAsumSingleTest : public AsumSingleTest<FLOAT_T> {
+public:
+    ScalarAsumSingleTest(int problem_size) : AsumSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->asum_result = ScalarLevel1<FLOAT_T>::asum(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarIamaxSingleTest : public IamaxSingleTest<FLOAT_T> {
+public:
+    ScalarIamaxSingleTest(int problem_size) : IamaxSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->iamax_result = ScalarLevel1<FLOAT_T>::iamax(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class ScalarNormalizeChainedTest : public NormalizeChainedTest<FLOAT_T> {
+public:
+    ScalarNormalizeChainedTest(int problem_size) : NormalizeChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        ScalarLevel1<FLOAT_T>::copy(this->problem_size, this->x, this->y);
+        FLOAT_T nrm2 = ScalarLevel1<FLOAT_T>::nrm2(this->problem_size, this->y);
+        ScalarLevel1<FLOAT_T>::scal(this->problem_size, FLOAT_T(1.0f) / nrm2, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar scal(1/nrm2(y), copy(x, y))";
+        return retval;
+    }
+};
+
+#endif
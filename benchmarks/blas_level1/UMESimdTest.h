@@ -0,0 +1,349 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_SIMD_LEVEL1_BENCH_H_
+#define UME_SIMD_LEVEL1_BENCH_H_
+
+#include <cmath>
+#include <limits>
+
+#include <umesimd/UMESimd.h>
+
+#include "Level1Test.h"
+
+#include "../utilities/UMEScalarToString.h"
+
+template<typename FLOAT_T, int STRIDE>
+struct UMESimdLevel1 {
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+    typedef UME::SIMD::SIMDVec<uint32_t, STRIDE> INDEX_VEC_T;
+    typedef UME::SIMD::SIMDVecMask<STRIDE> MASK_T;
+
+    // Independent accumulators used by reductions, so that the loop is not limited
+    // by the latency of a single accumulator.
+    static const int ACCUMULATORS = 4;
+
+    static UME_FORCE_INLINE void scal(int N, FLOAT_T alpha, FLOAT_T *x) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            x_vec *= alpha;
+            x_vec.storea(&x[i]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) x[i] = alpha * x[i];
+    }
+
+    static UME_FORCE_INLINE void copy(int N, FLOAT_T const *x, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            x_vec.storea(&y[i]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) y[i] = x[i];
+    }
+
+    static UME_FORCE_INLINE void swap(int N, FLOAT_T *x, FLOAT_T *y) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec, y_vec;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            y_vec.loada(&y[i]);
+            y_vec.storea(&x[i]);
+            x_vec.storea(&y[i]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) {
+            FLOAT_T t0 = x[i];
+            x[i] = y[i];
+            y[i] = t0;
+        }
+    }
+
+    // Sum of squares of x[i] * scale, together with max(|x[i]|).
+    static UME_FORCE_INLINE FLOAT_T sum_of_squares(int N, FLOAT_T const *x, FLOAT_T scale, FLOAT_T & max_abs) {
+        int BLOCK_PEEL_OFFSET = (N / (ACCUMULATORS * STRIDE)) * (ACCUMULATORS * STRIDE);
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec, max_vec(FLOAT_T(0.0f));
+        VEC_T acc[ACCUMULATORS];
+        for (int r = 0; r < ACCUMULATORS; r++) acc[r] = FLOAT_T(0.0f);
+
+        for (int i = 0; i < BLOCK_PEEL_OFFSET; i += ACCUMULATORS * STRIDE) {
+            for (int r = 0; r < ACCUMULATORS; r++) {
+                x_vec.loada(&x[i + r*STRIDE]);
+                max_vec = max_vec.max(x_vec.abs());
+                x_vec *= scale;
+                acc[r] = x_vec.fmuladd(x_vec, acc[r]);
+            }
+        }
+        for (int i = BLOCK_PEEL_OFFSET; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            max_vec = max_vec.max(x_vec.abs());
+            x_vec *= scale;
+            acc[0] = x_vec.fmuladd(x_vec, acc[0]);
+        }
+        for (int r = 1; r < ACCUMULATORS; r++) acc[0] += acc[r];
+
+        FLOAT_T sum = acc[0].hadd();
+        max_abs = max_vec.hmax();
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) {
+            FLOAT_T t0 = x[i] * scale;
+            sum += t0 * t0;
+            max_abs = std::max(max_abs, std::abs(x[i]));
+        }
+        return sum;
+    }
+
+    // Overflow and underflow safe Euclidean norm. The sum of squares is computed
+    // directly in a single pass, together with max(|x[i]|). Only when the maximum
+    // shows that squares could have overflowed, or that small values lost precision
+    // to underflow, a second pass is done with x scaled by a power of 2, which
+    // introduces no rounding error.
+    static UME_FORCE_INLINE FLOAT_T nrm2(int N, FLOAT_T const *x) {
+        if (N <= 0) return FLOAT_T(0.0f);
+
+        FLOAT_T max_abs;
+        FLOAT_T sum = sum_of_squares(N, x, FLOAT_T(1.0f), max_abs);
+
+        // Range of max(|x[i]|) for which N squares can be accumulated safely.
+        FLOAT_T lower_limit = std::sqrt(std::numeric_limits<FLOAT_T>::min() / std::numeric_limits<FLOAT_T>::epsilon() * FLOAT_T(N));
+        FLOAT_T upper_limit = std::sqrt(std::numeric_limits<FLOAT_T>::max() / FLOAT_T(N));
+
+        if (max_abs == FLOAT_T(0.0f) || !(max_abs <= std::numeric_limits<FLOAT_T>::max())) {
+            // All zeros, infinity or NaN.
+            return max_abs;
+        }
+        if (max_abs >= lower_limit && max_abs <= upper_limit) {
+            return std::sqrt(sum);
+        }
+
+        int exponent;
+        std::frexp(max_abs, &exponent);
+        FLOAT_T scale = std::ldexp(FLOAT_T(1.0f), -exponent);
+        sum = sum_of_squares(N, x, scale, max_abs);
+        return std::ldexp(std::sqrt(sum), exponent);
+    }
+
+    static UME_FORCE_INLINE FLOAT_T asum(int N, FLOAT_T const *x) {
+        int BLOCK_PEEL_OFFSET = (N / (ACCUMULATORS * STRIDE)) * (ACCUMULATORS * STRIDE);
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        VEC_T x_vec;
+        VEC_T acc[ACCUMULATORS];
+        for (int r = 0; r < ACCUMULATORS; r++) acc[r] = FLOAT_T(0.0f);
+
+        for (int i = 0; i < BLOCK_PEEL_OFFSET; i += ACCUMULATORS * STRIDE) {
+            for (int r = 0; r < ACCUMULATORS; r++) {
+                x_vec.loada(&x[i + r*STRIDE]);
+                acc[r] += x_vec.abs();
+            }
+        }
+        for (int i = BLOCK_PEEL_OFFSET; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&x[i]);
+            acc[0] += x_vec.abs();
+        }
+        for (int r = 1; r < ACCUMULATORS; r++) acc[0] += acc[r];
+
+        FLOAT_T sum = acc[0].hadd();
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) sum += std::abs(x[i]);
+        return sum;
+    }
+
+    // Every lane tracks its own maximum and the index at which it was found. Strict
+    // comparison keeps the first occurrence within a lane. Lanes are combined at
+    // the end, choosing the lowest index among equal maxima, as required by BLAS.
+    static UME_FORCE_INLINE int iamax(int N, FLOAT_T const *x) {
+        int LOOP_PEEL_OFFSET = (N / STRIDE) * STRIDE;
+
+        int index = 0;
+        FLOAT_T max = FLOAT_T(-1.0f);
+
+        if (LOOP_PEEL_OFFSET > 0) {
+            uint32_t lanes[STRIDE];
+            for (int l = 0; l < STRIDE; l++) lanes[l] = uint32_t(l);
+
+            VEC_T x_vec, max_vec(FLOAT_T(-1.0f));
+            INDEX_VEC_T index_vec, max_index_vec(uint32_t(0));
+            MASK_T mask;
+            index_vec.load(lanes);
+
+            for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+                x_vec.loada(&x[i]);
+                x_vec = x_vec.abs();
+                mask = x_vec.cmpgt(max_vec);
+                max_vec.assign(mask, x_vec);
+                max_index_vec.assign(mask, index_vec);
+                index_vec += uint32_t(STRIDE);
+            }
+
+            FLOAT_T max_values[STRIDE];
+            uint32_t max_indices[STRIDE];
+            max_vec.store(max_values);
+            max_index_vec.store(max_indices);
+            for (int l = 0; l < STRIDE; l++) {
+                if (max_values[l] > max || (max_values[l] == max && int(max_indices[l]) < index)) {
+                    max = max_values[l];
+                    index = int(max_indices[l]);
+                }
+            }
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < N; i++) {
+            if (std::abs(x[i]) > max) {
+                max = std::abs(x[i]);
+                index = i;
+            }
+        }
+        return index;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdScalSingleTest : public ScalSingleTest<FLOAT_T> {
+public:
+    UMESimdScalSingleTest(int problem_size) : ScalSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UMESimdLevel1<FLOAT_T, STRIDE>::scal(this->problem_size, this->alpha, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdCopySingleTest : public CopySingleTest<FLOAT_T> {
+public:
+    UMESimdCopySingleTest(int problem_size) : CopySingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UMESimdLevel1<FLOAT_T, STRIDE>::copy(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdSwapSingleTest : public SwapSingleTest<FLOAT_T> {
+public:
+    UMESimdSwapSingleTest(int problem_size) : SwapSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UMESimdLevel1<FLOAT_T, STRIDE>::swap(this->problem_size, this->x, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdNrm2SingleTest : public Nrm2SingleTest<FLOAT_T> {
+public:
+    UMESimdNrm2SingleTest(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) : Nrm2SingleTest<FLOAT_T>(problem_size, magnitude) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->nrm2_result = UMESimdLevel1<FLOAT_T, STRIDE>::nrm2(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdAsumSingleTest : public AsumSingleTest<FLOAT_T> {
+public:
+    UMESimdAsumSingleTest(int problem_size) : AsumSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->asum_result = UMESimdLevel1<FLOAT_T, STRIDE>::asum(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdIamaxSingleTest : public IamaxSingleTest<FLOAT_T> {
+public:
+    UMESimdIamaxSingleTest(int problem_size) : IamaxSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        this->iamax_result = UMESimdLevel1<FLOAT_T, STRIDE>::iamax(this->problem_size, this->x);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD single (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE>
+class UMESimdNormalizeChainedTest : public NormalizeChainedTest<FLOAT_T> {
+public:
+    UMESimdNormalizeChainedTest(int problem_size) : NormalizeChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UMESimdLevel1<FLOAT_T, STRIDE>::copy(this->problem_size, this->x, this->y);
+        FLOAT_T nrm2 = UMESimdLevel1<FLOAT_T, STRIDE>::nrm2(this->problem_size, this->y);
+        UMESimdLevel1<FLOAT_T, STRIDE>::scal(this->problem_size, FLOAT_T(1.0f) / nrm2, this->y);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD scal(1/nrm2(y), copy(x, y)) (SIMD " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+#endif
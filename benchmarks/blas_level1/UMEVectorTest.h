@@ -0,0 +1,220 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_VECTOR_LEVEL1_BENCH_H_
+#define UME_VECTOR_LEVEL1_BENCH_H_
+
+#include <cmath>
+#include <limits>
+
+#include <umevector/UMEVector.h>
+#include <umevector/evaluators/DyadicEvaluator.h>
+
+#include "Level1Test.h"
+
+template<typename FLOAT_T>
+struct UMEVectorLevel1 {
+    typedef UME::VECTOR::Vector<FLOAT_T> VECTOR_T;
+
+    static UME_FORCE_INLINE FLOAT_T amax(VECTOR_T & x_vec) {
+        FLOAT_T max_abs = FLOAT_T(0.0f);
+        auto max_exp = x_vec.abs().hmax();
+        UME::VECTOR::MonadicEvaluator eval(&max_abs, max_exp);
+        return max_abs;
+    }
+
+    // Reductions are evaluated one at a time, so the norm is always computed in two
+    // passes: max(|x[i]|) first, then the sum of squares of x scaled by a power of 2.
+    static UME_FORCE_INLINE FLOAT_T nrm2(VECTOR_T & x_vec) {
+        FLOAT_T max_abs = amax(x_vec);
+        if (max_abs == FLOAT_T(0.0f) || !(max_abs <= std::numeric_limits<FLOAT_T>::max())) {
+            // All zeros, infinity or NaN.
+            return max_abs;
+        }
+
+        int exponent;
+        std::frexp(max_abs, &exponent);
+        FLOAT_T scale = std::ldexp(FLOAT_T(1.0f), -exponent);
+
+        auto t0 = x_vec * scale;
+        FLOAT_T sum = (t0 * t0).hadd();
+        return std::ldexp(std::sqrt(sum), exponent);
+    }
+};
+
+template<typename FLOAT_T>
+class UMEVectorScalSingleTest : public ScalSingleTest<FLOAT_T> {
+public:
+    UMEVectorScalSingleTest(int problem_size) : ScalSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+
+        x_vec = this->alpha * x_vec;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class UMEVectorCopySingleTest : public CopySingleTest<FLOAT_T> {
+public:
+    UMEVectorCopySingleTest(int problem_size) : CopySingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+        UME::VECTOR::Vector<FLOAT_T> y_vec(this->problem_size, this->y);
+
+        UME::VECTOR::MonadicEvaluator eval(y_vec, x_vec);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class UMEVectorSwapSingleTest : public SwapSingleTest<FLOAT_T> {
+public:
+    UMEVectorSwapSingleTest(int problem_size) : SwapSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+        UME::VECTOR::Vector<FLOAT_T> y_vec(this->problem_size, this->y);
+
+        // Both expressions are evaluated before any of the results is stored.
+        UME::VECTOR::DyadicEvaluator eval(x_vec, y_vec, y_vec, x_vec);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class UMEVectorNrm2SingleTest : public Nrm2SingleTest<FLOAT_T> {
+public:
+    UMEVectorNrm2SingleTest(int problem_size, FLOAT_T magnitude = FLOAT_T(1.0f)) : Nrm2SingleTest<FLOAT_T>(problem_size, magnitude) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+
+        this->nrm2_result = UMEVectorLevel1<FLOAT_T>::nrm2(x_vec);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+template<typename FLOAT_T>
+class UMEVectorAsumSingleTest : public AsumSingleTest<FLOAT_T> {
+public:
+    UMEVectorAsumSingleTest(int problem_size) : AsumSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+
+        this->asum_result = x_vec.abs().hadd();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+// UME::VECTOR has no index-tracking reduction. The maximum is found with a vector
+// reduction and its first position with a scalar search, which usually stops early.
+template<typename FLOAT_T>
+class UMEVectorIamaxSingleTest : public IamaxSingleTest<FLOAT_T> {
+public:
+    UMEVectorIamaxSingleTest(int problem_size) : IamaxSingleTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+
+        FLOAT_T max_abs = UMEVectorLevel1<FLOAT_T>::amax(x_vec);
+
+        this->iamax_result = 0;
+        for (int i = 0; i < this->problem_size; i++) {
+            if (std::abs(this->x[i]) == max_abs) {
+                this->iamax_result = i;
+                break;
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR single";
+        return retval;
+    }
+};
+
+// The copy is fused with scaling: Y = X * (1/nrm2(X)).
+template<typename FLOAT_T>
+class UMEVectorNormalizeChainedTest : public NormalizeChainedTest<FLOAT_T> {
+public:
+    UMEVectorNormalizeChainedTest(int problem_size) : NormalizeChainedTest<FLOAT_T>(problem_size) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        UME::VECTOR::Vector<FLOAT_T> x_vec(this->problem_size, this->x);
+        UME::VECTOR::Vector<FLOAT_T> y_vec(this->problem_size, this->y);
+
+        FLOAT_T nrm2 = UMEVectorLevel1<FLOAT_T>::nrm2(x_vec);
+        y_vec = (FLOAT_T(1.0f) / nrm2) * x_vec;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::VECTOR Y = X * (1/nrm2(X))";
+        return retval;
+    }
+};
+
+#endif
@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+// EXPLAINER:
+// This benchmark uses JIT assembly instead of UME::SIMD as a code generation layer.
+// Both rotated vectors are computed in a single loop pass: 'x' and 'y' are loaded
+// once per iteration and both results are stored before the next iteration. The
+// evaluator only generates single precision AVX2/FMA3 code, so double precision
+// tests are reported as disabled.
+
+#pragma once
+
+#include <umevector/UMEVector.h>
+#include "../utilities/MeasurementHarness.h"
+
+#include "RotTest.h"
+
+template<typename FLOAT_T>
+class UMEVectorAsmjitSingleTest : public Test {
+public:
+    int problem_size;
+
+    // The default class will be called when the JIT evaluator is disabled
+    UMEVectorAsmjitSingleTest(int problem_size) : Test(false), problem_size(problem_size) {}
+
+    UME_NEVER_INLINE virtual void initialize() {}
+    UME_NEVER_INLINE virtual void benchmarked_code() {}
+    UME_NEVER_INLINE virtual void cleanup() {}
+    UME_NEVER_INLINE virtual void verify() {}
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "AsmJIT evaluator single";
+        return retval;
+    }
+};
+
+#if defined (USE_ASMJIT)
+
+#include "../utilities/AsmjitMonadicEvaluator.h"
+
+template<>
+class UMEVectorAsmjitSingleTest<float> : public RotSingleTest<float> {
+private:
+    typedef AsmjitEvaluator<UME_DYNAMIC_LENGTH, DefaultStride<float>::value> EVALUATOR_T;
+
+    // Compiled in 'initialize()' so that JIT compilation is not measured.
+    EVALUATOR_T *eval;
+
+public:
+    UMEVectorAsmjitSingleTest(int problem_size) : RotSingleTest<float>(problem_size), eval(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize()
+    {
+        RotSingleTest<float>::initialize();
+
+        UME::VECTOR::Vector<float> x_vec(this->problem_size, this->x);
+        UME::VECTOR::Vector<float> y_vec(this->problem_size, this->y);
+
+        auto t0 = this->c * x_vec + this->s * y_vec;
+        auto t1 = this->c * y_vec - this->s * x_vec;
+
+        eval = new EVALUATOR_T(x_vec, t0, y_vec, t1, 1, false);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        eval->run();
+    }
+
+    UME_NEVER_INLINE virtual void cleanup()
+    {
+        delete eval;
+        eval = nullptr;
+        RotSingleTest<float>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "AsmJIT evaluator single";
+        return retval;
+    }
+};
+
+#endif
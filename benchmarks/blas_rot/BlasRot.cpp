@@ -49,6 +49,7 @@
 #include "BlasTest.h"
 #include "UMESimdTest.h"
 #include "UMEVectorTest.h"
+#include "AsmjitUMEVectorTest.h"
 
 int main(int argc, char **argv)
 {
@@ -56,13 +57,17 @@ int main(int argc, char **argv)
     int MAX_SIZE = 134217728;
     int PROGRESSION = 2;
     int ITERATIONS = 10;
+    int MAX_ROTATIONS = 64;
 
     BenchmarkHarness harness(argc, argv);
 
     std::cout <<
         "[Compile with -DUSE_BLAS to enable blas benchmarks (requires BLAS)]\n"
+        "[Compile with -DUSE_ASMJIT -DASMJIT_STATIC and asmjit sources to enable JIT benchmarks (requires AVX2 and FMA3)]\n"
         "\n"
-        "This benchmark measures execution of (X, Y) = rot(X, Y, s, c) (blas_?rot) kernel.\n\n"
+        "This benchmark measures execution of (X, Y) = rot(X, Y, s, c) (blas_?rot) kernel.\n"
+        "Sequence mode applies K = 1..64 rotations to the same pair of vectors, either\n"
+        "one pass per rotation, or fused: all rotations applied to a register tile at once.\n\n"
         //"Two modes are being measured:\n"
         //" - single kernel execution (as defined by BLAS)\n"
         //" - chained execution, where 10 AXPY kernels are used in a daisy-chain\n\n"
@@ -82,6 +87,7 @@ int main(int argc, char **argv)
         newCategory->registerTest(new ScalarSingleTest<float>(i));
         newCategory->registerTest(new BlasSingleTest<float>(i));
         newCategory->registerTest(new UMEVectorSingleTest<float>(i));
+        newCategory->registerTest(new UMEVectorAsmjitSingleTest<float>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 1>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 2>(i));
         newCategory->registerTest(new UMESimdSingleTest<float, 4>(i));
@@ -102,6 +108,7 @@ int main(int argc, char **argv)
         newCategory->registerTest(new ScalarSingleTest<double>(i));
         newCategory->registerTest(new BlasSingleTest<double>(i));
         newCategory->registerTest(new UMEVectorSingleTest<double>(i));
+        newCategory->registerTest(new UMEVectorAsmjitSingleTest<double>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 1>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 2>(i));
         newCategory->registerTest(new UMESimdSingleTest<double, 4>(i));
@@ -111,6 +118,44 @@ int main(int argc, char **argv)
         harness.registerTestCategory(newCategory);
     }
 
+    // Sequence of rotations (single precision)
+    for (int i = 1024; i <= MAX_SIZE / 8; i *= 4) {
+        for (int k = 1; k <= MAX_ROTATIONS; k *= 2) {
+            std::string categoryName = std::string("BLAS_ROT_sequence");
+            TestCategory *newCategory = new TestCategory(categoryName);
+            newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 32));
+            newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), i));
+            newCategory->registerParameter(new ValueParameter<int>(std::string("rotations"), k));
+
+            newCategory->registerTest(new ScalarSequenceTest<float>(i, k));
+            newCategory->registerTest(new UMESimdSequenceTest<float, 8>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<float, 8, 1>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<float, 8, 4>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<float, 16, 4>(i, k));
+
+            harness.registerTestCategory(newCategory);
+        }
+    }
+
+    // Sequence of rotations (double precision)
+    for (int i = 1024; i <= MAX_SIZE / 8; i *= 4) {
+        for (int k = 1; k <= MAX_ROTATIONS; k *= 2) {
+            std::string categoryName = std::string("BLAS_ROT_sequence");
+            TestCategory *newCategory = new TestCategory(categoryName);
+            newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 64));
+            newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), i));
+            newCategory->registerParameter(new ValueParameter<int>(std::string("rotations"), k));
+
+            newCategory->registerTest(new ScalarSequenceTest<double>(i, k));
+            newCategory->registerTest(new UMESimdSequenceTest<double, 4>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<double, 4, 1>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<double, 4, 4>(i, k));
+            newCategory->registerTest(new UMESimdFusedSequenceTest<double, 8, 4>(i, k));
+
+            harness.registerTestCategory(newCategory);
+        }
+    }
+
     /*
     // Chained execution (single precision)
     for (int i = 1; i <= MAX_SIZE; i *= 10) {
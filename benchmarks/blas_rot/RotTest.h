@@ -124,6 +124,98 @@ public:
     UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
 };
 
+// Test execution of a sequence of 'rotation_count' plane rotations applied to the same
+// pair of vectors, as done by QR and Jacobi methods:
+//   for k in [0, rotation_count): (X, Y) = rot(X, Y, c[k], s[k])
+template<typename FLOAT_T>
+class RotSequenceTest : public Test {
+protected:
+    static const int OPTIMAL_ALIGNMENT = 64;
+    typedef ttmath::Big<2, 2> BigFloat;
+
+    FLOAT_T *x, *y, *c, *s;
+
+    int problem_size;
+    int rotation_count;
+
+    BigFloat *x_expected, *y_expected;
+
+public:
+    RotSequenceTest(int problem_size, int rotation_count) :
+        Test(true), problem_size(problem_size), rotation_count(rotation_count) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        x = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+        y = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*problem_size, OPTIMAL_ALIGNMENT);
+        c = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*rotation_count, OPTIMAL_ALIGNMENT);
+        s = (FLOAT_T*)UME::DynamicMemory::AlignedMalloc(sizeof(FLOAT_T)*rotation_count, OPTIMAL_ALIGNMENT);
+        x_expected = (BigFloat*)UME::DynamicMemory::AlignedMalloc(sizeof(BigFloat)*problem_size, OPTIMAL_ALIGNMENT);
+        y_expected = (BigFloat*)UME::DynamicMemory::AlignedMalloc(sizeof(BigFloat)*problem_size, OPTIMAL_ALIGNMENT);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data
+        for (int i = 0; i < problem_size; i++)
+        {
+            // Generate random numbers in range (0.0;1.0)
+            x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+            y[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+            x_expected[i] = x[i];
+            y_expected[i] = y[i];
+        }
+
+        for (int k = 0; k < rotation_count; k++)
+        {
+            FLOAT_T theta = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) * FLOAT_T(6.28);
+            c[k] = std::cos(theta);
+            s[k] = std::sin(theta);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+        UME::DynamicMemory::AlignedFree(c);
+        UME::DynamicMemory::AlignedFree(s);
+        UME::DynamicMemory::AlignedFree(x_expected);
+        UME::DynamicMemory::AlignedFree(y_expected);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        // Calculate expected values
+        for (int k = 0; k < rotation_count; k++) {
+            BigFloat c_k = c[k];
+            BigFloat s_k = s[k];
+            for (int i = 0; i < problem_size; i++) {
+                BigFloat t0 = c_k * x_expected[i] + s_k * y_expected[i];
+                BigFloat t1 = c_k * y_expected[i] - s_k * x_expected[i];
+                x_expected[i] = t0;
+                y_expected[i] = t1;
+            }
+        }
+
+        BigFloat max_err = 0;
+        BigFloat max_norm = 0;
+
+        for (int i = 0; i < problem_size; i++) {
+            BigFloat x_diff = ttmath::Abs(BigFloat(x[i]) - x_expected[i]);
+            BigFloat y_diff = ttmath::Abs(BigFloat(y[i]) - y_expected[i]);
+            max_err = max_err > x_diff ? max_err : x_diff;
+            max_err = max_err > y_diff ? max_err : y_diff;
+
+            BigFloat x_abs = ttmath::Abs(x_expected[i]);
+            BigFloat y_abs = ttmath::Abs(y_expected[i]);
+            max_norm = max_norm > x_abs ? max_norm : x_abs;
+            max_norm = max_norm > y_abs ? max_norm : y_abs;
+        }
+
+        error_norm_bignum = max_err / max_norm;
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
 /*
 template<typename FLOAT_T>
 class DotChainedTest : public Test {
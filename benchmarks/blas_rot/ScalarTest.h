@@ -62,6 +62,33 @@ public:
         return retval;
     }
 };
+
+// Rotation sequence applied one rotation at a time: every rotation is a separate
+// pass reading and writing both vectors.
+template<typename FLOAT_T>
+class ScalarSequenceTest : public RotSequenceTest<FLOAT_T> {
+public:
+    ScalarSequenceTest(int problem_size, int rotation_count) :
+        RotSequenceTest<FLOAT_T>(problem_size, rotation_count) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int k = 0; k < this->rotation_count; k++) {
+            FLOAT_T c = this->c[k];
+            FLOAT_T s = this->s[k];
+            for (int i = 0; i < this->problem_size; i++) {
+                FLOAT_T t0 = c * this->x[i] + s * this->y[i];
+                FLOAT_T t1 = c * this->y[i] - s * this->x[i];
+                this->x[i] = t0;
+                this->y[i] = t1;
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar sequence, " + std::to_string(this->rotation_count) + " rotations";
+        return retval;
+    }
+};
 /*
 // Test chained execution of naive AXPY kernel.
 template<typename FLOAT_T>
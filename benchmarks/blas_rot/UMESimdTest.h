@@ -75,6 +75,138 @@ public:
         return retval;
     }
 };
+
+// Rotation sequence applied one rotation at a time: every rotation is a separate
+// pass reading and writing both vectors, so the kernel stays bandwidth bound for
+// any number of rotations.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdSequenceTest : public RotSequenceTest<FLOAT_T> {
+public:
+    UMESimdSequenceTest(int problem_size, int rotation_count) :
+        RotSequenceTest<FLOAT_T>(problem_size, rotation_count) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        int LOOP_COUNT = this->problem_size / STRIDE;
+        int LOOP_PEEL_OFFSET = LOOP_COUNT * STRIDE;
+
+        UME::SIMD::SIMDVec<FLOAT_T, STRIDE> x_vec, y_vec, t0_vec, t1_vec;
+
+        for (int k = 0; k < this->rotation_count; k++)
+        {
+            FLOAT_T c = this->c[k];
+            FLOAT_T s = this->s[k];
+
+            for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE)
+            {
+                x_vec.loada(&this->x[i]);
+                y_vec.loada(&this->y[i]);
+
+                t0_vec = c*x_vec + s*y_vec;
+                t1_vec = c*y_vec - s*x_vec;
+
+                t0_vec.storea(&this->x[i]);
+                t1_vec.storea(&this->y[i]);
+            }
+
+            // Use scalar code to handle the reminder of elements.
+            for (int i = LOOP_PEEL_OFFSET; i < this->problem_size; i++)
+            {
+                FLOAT_T t0 = c * this->x[i] + s * this->y[i];
+                FLOAT_T t1 = c * this->y[i] - s * this->x[i];
+
+                this->x[i] = t0;
+                this->y[i] = t1;
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD sequence, " + std::to_string(this->rotation_count) +
+            " rotations (STRIDE: " + std::to_string(STRIDE) + ")";
+        return retval;
+    }
+};
+
+// Rotation sequence applied in a single pass. A tile of UNROLL*STRIDE elements of
+// X and Y is loaded into registers, all rotations are applied to it and it is stored
+// back, so every element is read and written once regardless of the number of
+// rotations. For longer sequences the kernel becomes compute bound. UNROLL
+// independent vectors hide the latency of the dependency chain of a single tile.
+template<typename FLOAT_T, int STRIDE, int UNROLL>
+class UMESimdFusedSequenceTest : public RotSequenceTest<FLOAT_T> {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+
+    template<int U>
+    UME_FORCE_INLINE void rotate_tile(FLOAT_T *x, FLOAT_T *y) {
+        VEC_T x_vec[U], y_vec[U], t0_vec;
+
+        for (int u = 0; u < U; u++) {
+            x_vec[u].loada(&x[u*STRIDE]);
+            y_vec[u].loada(&y[u*STRIDE]);
+        }
+
+        for (int k = 0; k < this->rotation_count; k++) {
+            VEC_T c_vec(this->c[k]);
+            VEC_T s_vec(this->s[k]);
+            for (int u = 0; u < U; u++) {
+                t0_vec = c_vec*x_vec[u] + s_vec*y_vec[u];
+                y_vec[u] = c_vec*y_vec[u] - s_vec*x_vec[u];
+                x_vec[u] = t0_vec;
+            }
+        }
+
+        for (int u = 0; u < U; u++) {
+            x_vec[u].storea(&x[u*STRIDE]);
+            y_vec[u].storea(&y[u*STRIDE]);
+        }
+    }
+
+public:
+    UMESimdFusedSequenceTest(int problem_size, int rotation_count) :
+        RotSequenceTest<FLOAT_T>(problem_size, rotation_count) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code()
+    {
+        int TILE_PEEL_OFFSET = (this->problem_size / (UNROLL*STRIDE)) * (UNROLL*STRIDE);
+        int LOOP_PEEL_OFFSET = (this->problem_size / STRIDE) * STRIDE;
+
+        for (int i = 0; i < TILE_PEEL_OFFSET; i += UNROLL*STRIDE)
+        {
+            rotate_tile<UNROLL>(&this->x[i], &this->y[i]);
+        }
+
+        for (int i = TILE_PEEL_OFFSET; i < LOOP_PEEL_OFFSET; i += STRIDE)
+        {
+            rotate_tile<1>(&this->x[i], &this->y[i]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < this->problem_size; i++)
+        {
+            FLOAT_T x = this->x[i];
+            FLOAT_T y = this->y[i];
+            for (int k = 0; k < this->rotation_count; k++)
+            {
+                FLOAT_T t0 = this->c[k] * x + this->s[k] * y;
+                y = this->c[k] * y - this->s[k] * x;
+                x = t0;
+            }
+            this->x[i] = x;
+            this->y[i] = y;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier()
+    {
+        std::string retval = "UME::SIMD fused sequence, " + std::to_string(this->rotation_count) +
+            " rotations (STRIDE: " + std::to_string(STRIDE) + ", UNROLL: " + std::to_string(UNROLL) + ")";
+        return retval;
+    }
+};
+
 /*
 template<typename FLOAT_T, int STRIDE>
 class UMESimdChainedTest : public Test {
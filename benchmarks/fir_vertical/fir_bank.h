@@ -0,0 +1,375 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#ifndef UME_FIR_BANK_H_
+#define UME_FIR_BANK_H_
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// Filter bank: 'channels' independent FIR filters of the same order, each with its
+// own coefficients. Samples are stored in an interleaved layout, one row per time
+// step: x[t * ld + c] is sample 't' of channel 'c'. A single SIMD vector holds the
+// same time step of STRIDE consecutive channels, so every lane advances its own
+// channel and no horizontal operations are needed.
+//
+// Coefficients are given per channel: h[c * order + k] is the gain of x[t - k]
+// for channel 'c'. Filters keep their last 'order - 1' input samples between calls
+// to 'process', so a long signal can be processed in consecutive pieces.
+
+// Reference implementation. Like the SIMD version, blocks of BLOCK time steps are
+// copied together with the history into a contiguous delay line and outputs are
+// computed one time step at a time, with channels in the innermost loop.
+template<typename FLOAT_T>
+class ScalarFIRBank {
+private:
+    static const int BLOCK = 256;
+
+    int channels;
+    int order;
+    FLOAT_T *coeffs;    // [tap][channel]
+    FLOAT_T *history;   // [order - 1][channel], oldest sample first
+    FLOAT_T *line;      // [order - 1 + BLOCK][channel]
+
+public:
+    ScalarFIRBank(int channels, int order, FLOAT_T const *h) : channels(channels), order(order) {
+        coeffs = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(channels*order*sizeof(FLOAT_T), sizeof(FLOAT_T));
+        history = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(std::max(1, channels*(order - 1))*sizeof(FLOAT_T), sizeof(FLOAT_T));
+        line = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc((order - 1 + BLOCK)*channels*sizeof(FLOAT_T), sizeof(FLOAT_T));
+
+        for (int c = 0; c < channels; c++) {
+            for (int k = 0; k < order; k++) coeffs[k*channels + c] = h[c*order + k];
+        }
+        reset();
+    }
+
+    ~ScalarFIRBank() {
+        UME::DynamicMemory::AlignedFree(coeffs);
+        UME::DynamicMemory::AlignedFree(history);
+        UME::DynamicMemory::AlignedFree(line);
+    }
+
+    void reset() {
+        for (int i = 0; i < channels*(order - 1); i++) history[i] = FLOAT_T(0);
+    }
+
+    void process(int samples, FLOAT_T const *x, int ldx, FLOAT_T *y, int ldy) {
+        const int HISTORY = order - 1;
+
+        for (int block_begin = 0; block_begin < samples; block_begin += BLOCK) {
+            int n = std::min(BLOCK, samples - block_begin);
+            FLOAT_T const *x_block = &x[block_begin*ldx];
+            FLOAT_T *y_block = &y[block_begin*ldy];
+
+            // Delay line: history followed by the block
+            for (int i = 0; i < HISTORY*channels; i++) line[i] = history[i];
+            for (int t = 0; t < n; t++) {
+                for (int c = 0; c < channels; c++) line[(HISTORY + t)*channels + c] = x_block[t*ldx + c];
+            }
+
+            // y[t] = sum(h[k] * line[HISTORY + t - k])
+            for (int t = 0; t < n; t++) {
+                FLOAT_T *dst = &y_block[t*ldy];
+                for (int c = 0; c < channels; c++) dst[c] = FLOAT_T(0);
+                for (int k = 0; k < order; k++) {
+                    FLOAT_T const *h = &coeffs[k*channels];
+                    FLOAT_T const *src = &line[(HISTORY + t - k)*channels];
+                    for (int c = 0; c < channels; c++) dst[c] += h[c] * src[c];
+                }
+            }
+
+            // The last HISTORY entries of the delay line become the new history
+            for (int i = 0; i < HISTORY*channels; i++) history[i] = line[n*channels + i];
+        }
+    }
+};
+
+// Channels are processed in groups of STRIDE, one channel per lane. For each group,
+// blocks of BLOCK time steps are copied together with the history into a contiguous
+// delay line, so that taps become aligned vector loads independent of the row
+// stride. OUTPUT_UNROLL consecutive outputs are computed at once, which reuses every
+// coefficient load. Order and coefficients are runtime values.
+//
+// 'ldx' and 'ldy' have to be multiples of STRIDE and 'x', 'y' aligned to the SIMD
+// vector alignment. Unused lanes of the last group are processed with zero
+// coefficients, so rows have to hold at least a multiple of STRIDE channels.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdFIRBank {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+
+    static const int BLOCK = 256;
+    static const int OUTPUT_UNROLL = 4;
+
+    int channels;
+    int groups;
+    int order;
+    FLOAT_T *coeffs;    // [group][tap][lane]
+    FLOAT_T *history;   // [group][order - 1][lane], oldest sample first
+    FLOAT_T *line;      // [order - 1 + BLOCK][lane]
+
+public:
+    UMESimdFIRBank(int channels, int order, FLOAT_T const *h) : channels(channels), order(order) {
+        const int ALIGNMENT = FLOAT_VEC_T::alignment();
+        groups = (channels + STRIDE - 1) / STRIDE;
+
+        coeffs = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(groups*order*STRIDE*sizeof(FLOAT_T), ALIGNMENT);
+        history = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(std::max(1, groups*(order - 1))*STRIDE*sizeof(FLOAT_T), ALIGNMENT);
+        line = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc((order - 1 + BLOCK)*STRIDE*sizeof(FLOAT_T), ALIGNMENT);
+
+        for (int g = 0; g < groups; g++) {
+            for (int k = 0; k < order; k++) {
+                for (int l = 0; l < STRIDE; l++) {
+                    int c = g*STRIDE + l;
+                    coeffs[(g*order + k)*STRIDE + l] = (c < channels) ? h[c*order + k] : FLOAT_T(0);
+                }
+            }
+        }
+        reset();
+    }
+
+    ~UMESimdFIRBank() {
+        UME::DynamicMemory::AlignedFree(coeffs);
+        UME::DynamicMemory::AlignedFree(history);
+        UME::DynamicMemory::AlignedFree(line);
+    }
+
+    void reset() {
+        for (int i = 0; i < groups*(order - 1)*STRIDE; i++) history[i] = FLOAT_T(0);
+    }
+
+    void process(int samples, FLOAT_T const *x, int ldx, FLOAT_T *y, int ldy) {
+        const int HISTORY = order - 1;
+        FLOAT_VEC_T t0, t1, t2, t3, c0;
+
+        for (int block_begin = 0; block_begin < samples; block_begin += BLOCK) {
+            int n = std::min(BLOCK, samples - block_begin);
+            FLOAT_T const *x_block = &x[block_begin*ldx];
+            FLOAT_T *y_block = &y[block_begin*ldy];
+
+            for (int g = 0; g < groups; g++) {
+                FLOAT_T const *h = &coeffs[g*order*STRIDE];
+                FLOAT_T *hist = &history[g*HISTORY*STRIDE];
+
+                // Delay line: history followed by the block
+                for (int i = 0; i < HISTORY; i++) {
+                    t0.loada(&hist[i*STRIDE]);
+                    t0.storea(&line[i*STRIDE]);
+                }
+                for (int t = 0; t < n; t++) {
+                    t0.loada(&x_block[t*ldx + g*STRIDE]);
+                    t0.storea(&line[(HISTORY + t)*STRIDE]);
+                }
+
+                // y[t] = sum(h[k] * line[HISTORY + t - k])
+                int LOOP_PEEL_OFFSET = (n / OUTPUT_UNROLL) * OUTPUT_UNROLL;
+                for (int t = 0; t < LOOP_PEEL_OFFSET; t += OUTPUT_UNROLL) {
+                    FLOAT_VEC_T acc0(FLOAT_T(0)), acc1(FLOAT_T(0)), acc2(FLOAT_T(0)), acc3(FLOAT_T(0));
+                    for (int k = 0; k < order; k++) {
+                        FLOAT_T const *src = &line[(HISTORY + t - k)*STRIDE];
+                        c0.loada(&h[k*STRIDE]);
+                        t0.loada(&src[0]);
+                        t1.loada(&src[STRIDE]);
+                        t2.loada(&src[2*STRIDE]);
+                        t3.loada(&src[3*STRIDE]);
+                        acc0 = t0.fmuladd(c0, acc0);
+                        acc1 = t1.fmuladd(c0, acc1);
+                        acc2 = t2.fmuladd(c0, acc2);
+                        acc3 = t3.fmuladd(c0, acc3);
+                    }
+                    acc0.storea(&y_block[t*ldy + g*STRIDE]);
+                    acc1.storea(&y_block[(t + 1)*ldy + g*STRIDE]);
+                    acc2.storea(&y_block[(t + 2)*ldy + g*STRIDE]);
+                    acc3.storea(&y_block[(t + 3)*ldy + g*STRIDE]);
+                }
+                for (int t = LOOP_PEEL_OFFSET; t < n; t++) {
+                    FLOAT_VEC_T acc0(FLOAT_T(0));
+                    for (int k = 0; k < order; k++) {
+                        c0.loada(&h[k*STRIDE]);
+                        t0.loada(&line[(HISTORY + t - k)*STRIDE]);
+                        acc0 = t0.fmuladd(c0, acc0);
+                    }
+                    acc0.storea(&y_block[t*ldy + g*STRIDE]);
+                }
+
+                // The last HISTORY entries of the delay line become the new history
+                for (int i = 0; i < HISTORY; i++) {
+                    t0.loada(&line[(n + i)*STRIDE]);
+                    t0.storea(&hist[i*STRIDE]);
+                }
+            }
+        }
+    }
+};
+
+// Rows are padded to a multiple of MAX_BANK_STRIDE channels, so that all SIMD
+// versions use the same input.
+static const int MAX_BANK_STRIDE = 16;
+
+inline int bank_row_length(int channels) {
+    return ((channels + MAX_BANK_STRIDE - 1) / MAX_BANK_STRIDE) * MAX_BANK_STRIDE;
+}
+
+template<typename FLOAT_T>
+struct FIRBankData {
+    int channels, order, samples, ld;
+    FLOAT_T *h, *x, *y;
+
+    FIRBankData(int channels, int order, int samples) :
+        channels(channels), order(order), samples(samples), ld(bank_row_length(channels))
+    {
+        h = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(channels*order*sizeof(FLOAT_T), 64);
+        x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(samples*ld*sizeof(FLOAT_T), 64);
+        y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(samples*ld*sizeof(FLOAT_T), 64);
+
+        srand(0);
+        // Initialize arrays with random data in range (0.0;1.0), padding channels are zeroed
+        for (int t = 0; t < samples; t++) {
+            for (int c = 0; c < ld; c++) {
+                x[t*ld + c] = (c < channels) ? static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX) : FLOAT_T(0);
+                y[t*ld + c] = FLOAT_T(0);
+            }
+        }
+        for (int i = 0; i < channels*order; i++) {
+            h[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+    }
+
+    ~FIRBankData() {
+        UME::DynamicMemory::AlignedFree(h);
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+    }
+
+    // Perform reduction to avoid dead-code removals.
+    void consume() {
+        volatile FLOAT_T red = static_cast<FLOAT_T>(0);
+        for (int i = 0; i < samples*ld; i++) {
+            red += y[i];
+        }
+        // cast to void to avoid reduction
+        (void)red;
+    }
+};
+
+template<typename FLOAT_T>
+UME_NEVER_INLINE TIMING_RES test_scalar_FIR_bank(int channels, int order, int samples)
+{
+    unsigned long long start, end; // Time measurements
+    FIRBankData<FLOAT_T> data(channels, order, samples);
+    ScalarFIRBank<FLOAT_T> bank(channels, order, data.h);
+
+    start = get_timestamp();
+
+    bank.process(samples, data.x, data.ld, data.y, data.ld);
+
+    end = get_timestamp();
+
+    data.consume();
+    return end - start;
+}
+
+// Maximum absolute difference between 'data.y' and the output of 'ScalarFIRBank'
+// run on the same input. Padding channels are not compared.
+template<typename FLOAT_T>
+FLOAT_T fir_bank_max_error(FIRBankData<FLOAT_T> const & data)
+{
+    FLOAT_T *expected = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(data.samples*data.ld*sizeof(FLOAT_T), 64);
+    ScalarFIRBank<FLOAT_T> bank(data.channels, data.order, data.h);
+    bank.process(data.samples, data.x, data.ld, expected, data.ld);
+
+    FLOAT_T max_error = FLOAT_T(0);
+    for (int t = 0; t < data.samples; t++) {
+        for (int c = 0; c < data.channels; c++) {
+            max_error = std::max(max_error, FLOAT_T(std::abs(data.y[t*data.ld + c] - expected[t*data.ld + c])));
+        }
+    }
+    UME::DynamicMemory::AlignedFree(expected);
+    return max_error;
+}
+
+// With 'max_error' given, the output is also compared against 'fir_bank_max_error'
+// after the measurement.
+template<typename FLOAT_T, int STRIDE>
+UME_NEVER_INLINE TIMING_RES test_ume_FIR_bank(int channels, int order, int samples, FLOAT_T *max_error = nullptr)
+{
+    unsigned long long start, end; // Time measurements
+    FIRBankData<FLOAT_T> data(channels, order, samples);
+    UMESimdFIRBank<FLOAT_T, STRIDE> bank(channels, order, data.h);
+
+    start = get_timestamp();
+
+    bank.process(samples, data.x, data.ld, data.y, data.ld);
+
+    end = get_timestamp();
+
+    if (max_error != nullptr) *max_error = fir_bank_max_error(data);
+
+    data.consume();
+    return end - start;
+}
+
+template<typename FLOAT_T>
+void benchmarkScalarBank(std::string const & resultPrefix,
+                         int iterations,
+                         int channels, int order, int samples,
+                         TimingStatistics & stats)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_scalar_FIR_bank<FLOAT_T>(channels, order, samples));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: 1.0x)\n";
+}
+
+template<typename FLOAT_T, int STRIDE>
+void benchmarkSIMDBank(std::string const & resultPrefix,
+                       int iterations,
+                       int channels, int order, int samples,
+                       TimingStatistics & reference)
+{
+    TimingStatistics stats;
+    FLOAT_T max_error = FLOAT_T(0);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_ume_FIR_bank<FLOAT_T, STRIDE>(channels, order, samples, i == 0 ? &max_error : nullptr));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: " << stats.calculateSpeedup(reference) << "x, max error: " << max_error << ")\n";
+}
+
+#endif
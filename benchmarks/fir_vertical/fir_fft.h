@@ -0,0 +1,583 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#ifndef UME_FIR_FFT_H_
+#define UME_FIR_FFT_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Single channel FIR filters with runtime order, for long filters.
+//
+// Direct convolution costs 'order' multiply-adds per sample, overlap-save convolution
+// with an FFT of size N costs O(N log N) per N - order + 1 samples. 'FIRPlanner'
+// measures both for a given order and call size and selects the faster one.
+
+// y[t] = sum(h[k] * line[order - 1 + t - k]) for t < count. 'line' holds 'order - 1'
+// samples of history followed by 'count' new samples. SIMD lanes compute consecutive
+// outputs, four vectors of outputs share every coefficient broadcast.
+template<typename FLOAT_T, int STRIDE>
+UME_FORCE_INLINE void direct_fir(int count, int order, FLOAT_T const *h, FLOAT_T const *line, FLOAT_T *y)
+{
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+    const int UNROLL = 4 * STRIDE;
+
+    FLOAT_T const *src = &line[order - 1];
+    FLOAT_VEC_T t0, t1, t2, t3, c0;
+
+    int LOOP_PEEL_OFFSET = (count / UNROLL) * UNROLL;
+    for (int t = 0; t < LOOP_PEEL_OFFSET; t += UNROLL) {
+        FLOAT_VEC_T acc0(FLOAT_T(0)), acc1(FLOAT_T(0)), acc2(FLOAT_T(0)), acc3(FLOAT_T(0));
+        for (int k = 0; k < order; k++) {
+            FLOAT_T const *p = &src[t - k];
+            c0 = FLOAT_VEC_T(h[k]);
+            t0.load(&p[0]);
+            t1.load(&p[STRIDE]);
+            t2.load(&p[2 * STRIDE]);
+            t3.load(&p[3 * STRIDE]);
+            acc0 = t0.fmuladd(c0, acc0);
+            acc1 = t1.fmuladd(c0, acc1);
+            acc2 = t2.fmuladd(c0, acc2);
+            acc3 = t3.fmuladd(c0, acc3);
+        }
+        acc0.store(&y[t]);
+        acc1.store(&y[t + STRIDE]);
+        acc2.store(&y[t + 2 * STRIDE]);
+        acc3.store(&y[t + 3 * STRIDE]);
+    }
+
+    int VEC_PEEL_OFFSET = (count / STRIDE) * STRIDE;
+    for (int t = LOOP_PEEL_OFFSET; t < VEC_PEEL_OFFSET; t += STRIDE) {
+        FLOAT_VEC_T acc0(FLOAT_T(0));
+        for (int k = 0; k < order; k++) {
+            c0 = FLOAT_VEC_T(h[k]);
+            t0.load(&src[t - k]);
+            acc0 = t0.fmuladd(c0, acc0);
+        }
+        acc0.store(&y[t]);
+    }
+
+    // Use scalar code to handle the reminder of elements.
+    for (int t = VEC_PEEL_OFFSET; t < count; t++) {
+        FLOAT_T acc = FLOAT_T(0);
+        for (int k = 0; k < order; k++) {
+            acc += h[k] * src[t - k];
+        }
+        y[t] = acc;
+    }
+}
+
+// In-place complex FFT of power of 2 size on split (separate real and imaginary)
+// arrays. Radix-4 stages are used, followed by a single radix-2 stage for odd powers
+// of 2. Butterflies of a stage are vectorized over their index within a block, so
+// stages with less than STRIDE butterflies per block use scalar code.
+//
+// 'forward' is a decimation in frequency transform and leaves the spectrum in
+// bit-reversed order. 'inverse' is the matching decimation in time transform, which
+// takes a bit-reversed spectrum and returns samples in natural order, multiplied by
+// the size. Pointwise products of two spectra can be computed in bit-reversed order,
+// so convolutions never need the permutation.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdFFT {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+
+    int size;
+    int radix4_stages;
+    bool radix2_stage;
+    // For each radix-4 stage with 'q' butterflies per block: real and imaginary
+    // parts of w^j, w^2j and w^3j, 'q' elements each.
+    FLOAT_T *twiddles;
+    std::vector<int> twiddle_offset;
+
+    template<typename T>
+    static UME_FORCE_INLINE void dif_butterfly(
+        T & r0, T & i0, T & r1, T & i1, T & r2, T & i2, T & r3, T & i3,
+        T const & w1r, T const & w1i, T const & w2r, T const & w2i, T const & w3r, T const & w3i)
+    {
+        T b0r = r0 + r2, b0i = i0 + i2;
+        T b1r = r1 + r3, b1i = i1 + i3;
+        T b2r = r0 - r2, b2i = i0 - i2;
+        // b3 = -i * (a1 - a3)
+        T b3r = i1 - i3, b3i = r3 - r1;
+
+        r0 = b0r + b1r;
+        i0 = b0i + b1i;
+        T xr = b0r - b1r, xi = b0i - b1i;
+        r1 = xr * w2r - xi * w2i;
+        i1 = xr * w2i + xi * w2r;
+        xr = b2r + b3r;
+        xi = b2i + b3i;
+        r2 = xr * w1r - xi * w1i;
+        i2 = xr * w1i + xi * w1r;
+        xr = b2r - b3r;
+        xi = b2i - b3i;
+        r3 = xr * w3r - xi * w3i;
+        i3 = xr * w3i + xi * w3r;
+    }
+
+    template<typename T>
+    static UME_FORCE_INLINE void dit_butterfly(
+        T & r0, T & i0, T & r1, T & i1, T & r2, T & i2, T & r3, T & i3,
+        T const & w1r, T const & w1i, T const & w2r, T const & w2i, T const & w3r, T const & w3i)
+    {
+        // Undo twiddles with conjugates
+        T ur = r1 * w2r + i1 * w2i, ui = i1 * w2r - r1 * w2i;
+        T vr = r2 * w1r + i2 * w1i, vi = i2 * w1r - r2 * w1i;
+        T zr = r3 * w3r + i3 * w3i, zi = i3 * w3r - r3 * w3i;
+
+        T b0r = r0 + ur, b0i = i0 + ui;
+        T b1r = r0 - ur, b1i = i0 - ui;
+        T b2r = vr + zr, b2i = vi + zi;
+        T b3r = vr - zr, b3i = vi - zi;
+
+        r0 = b0r + b2r;
+        i0 = b0i + b2i;
+        r2 = b0r - b2r;
+        i2 = b0i - b2i;
+        // a1 = b1 + i * b3, a3 = b1 - i * b3
+        r1 = b1r - b3i;
+        i1 = b1i + b3r;
+        r3 = b1r + b3i;
+        i3 = b1i - b3r;
+    }
+
+    template<bool FORWARD>
+    static UME_FORCE_INLINE void radix4_block(int q, FLOAT_T *re, FLOAT_T *im, FLOAT_T const *w) {
+        FLOAT_T const *w1r = &w[0], *w1i = &w[q], *w2r = &w[2*q], *w2i = &w[3*q], *w3r = &w[4*q], *w3i = &w[5*q];
+
+        int LOOP_PEEL_OFFSET = (q / STRIDE) * STRIDE;
+        for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+            FLOAT_VEC_T r0, i0, r1, i1, r2, i2, r3, i3;
+            FLOAT_VEC_T c1r, c1i, c2r, c2i, c3r, c3i;
+            r0.loada(&re[j]);       i0.loada(&im[j]);
+            r1.loada(&re[j + q]);   i1.loada(&im[j + q]);
+            r2.loada(&re[j + 2*q]); i2.loada(&im[j + 2*q]);
+            r3.loada(&re[j + 3*q]); i3.loada(&im[j + 3*q]);
+            c1r.load(&w1r[j]); c1i.load(&w1i[j]);
+            c2r.load(&w2r[j]); c2i.load(&w2i[j]);
+            c3r.load(&w3r[j]); c3i.load(&w3i[j]);
+            if (FORWARD) dif_butterfly(r0, i0, r1, i1, r2, i2, r3, i3, c1r, c1i, c2r, c2i, c3r, c3i);
+            else dit_butterfly(r0, i0, r1, i1, r2, i2, r3, i3, c1r, c1i, c2r, c2i, c3r, c3i);
+            r0.storea(&re[j]);       i0.storea(&im[j]);
+            r1.storea(&re[j + q]);   i1.storea(&im[j + q]);
+            r2.storea(&re[j + 2*q]); i2.storea(&im[j + 2*q]);
+            r3.storea(&re[j + 3*q]); i3.storea(&im[j + 3*q]);
+        }
+
+        // Use scalar code to handle the reminder of butterflies.
+        for (int j = LOOP_PEEL_OFFSET; j < q; j++) {
+            if (FORWARD) {
+                dif_butterfly(re[j], im[j], re[j + q], im[j + q], re[j + 2*q], im[j + 2*q], re[j + 3*q], im[j + 3*q],
+                    w1r[j], w1i[j], w2r[j], w2i[j], w3r[j], w3i[j]);
+            }
+            else {
+                dit_butterfly(re[j], im[j], re[j + q], im[j + q], re[j + 2*q], im[j + 2*q], re[j + 3*q], im[j + 3*q],
+                    w1r[j], w1i[j], w2r[j], w2i[j], w3r[j], w3i[j]);
+            }
+        }
+    }
+
+    // Radix-2 stage with a single butterfly per block, the same in both directions.
+    void radix2_pass(FLOAT_T *re, FLOAT_T *im) const {
+        for (int b = 0; b < size; b += 2) {
+            FLOAT_T r0 = re[b], i0 = im[b];
+            re[b] = r0 + re[b + 1];
+            im[b] = i0 + im[b + 1];
+            re[b + 1] = r0 - re[b + 1];
+            im[b + 1] = i0 - im[b + 1];
+        }
+    }
+
+public:
+    UMESimdFFT(int size) : size(size) {
+        int log2size = 0;
+        while ((1 << log2size) < size) log2size++;
+        radix4_stages = log2size / 2;
+        radix2_stage = (log2size % 2) == 1;
+
+        int total = 0;
+        for (int s = 0, q = size / 4; s < radix4_stages; s++, q /= 4) {
+            twiddle_offset.push_back(total);
+            total += 6 * q;
+        }
+        twiddles = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(std::max(1, total)*sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+
+        const double PI = 3.14159265358979323846;
+        for (int s = 0, q = size / 4; s < radix4_stages; s++, q /= 4) {
+            FLOAT_T *w = &twiddles[twiddle_offset[s]];
+            for (int j = 0; j < q; j++) {
+                for (int m = 1; m <= 3; m++) {
+                    double angle = -2.0 * PI * double(m * j) / double(4 * q);
+                    w[(2*m - 2)*q + j] = FLOAT_T(std::cos(angle));
+                    w[(2*m - 1)*q + j] = FLOAT_T(std::sin(angle));
+                }
+            }
+        }
+    }
+
+    ~UMESimdFFT() {
+        UME::DynamicMemory::AlignedFree(twiddles);
+    }
+
+    int get_size() const { return size; }
+
+    // 're' and 'im' have to be aligned to the SIMD vector alignment.
+    void forward(FLOAT_T *re, FLOAT_T *im) const {
+        for (int s = 0, q = size / 4; s < radix4_stages; s++, q /= 4) {
+            for (int b = 0; b < size; b += 4 * q) {
+                radix4_block<true>(q, &re[b], &im[b], &twiddles[twiddle_offset[s]]);
+            }
+        }
+        if (radix2_stage) radix2_pass(re, im);
+    }
+
+    void inverse(FLOAT_T *re, FLOAT_T *im) const {
+        if (radix2_stage) radix2_pass(re, im);
+        for (int s = radix4_stages - 1; s >= 0; s--) {
+            int q = size >> (2 * s + 2);
+            for (int b = 0; b < size; b += 4 * q) {
+                radix4_block<false>(q, &re[b], &im[b], &twiddles[twiddle_offset[s]]);
+            }
+        }
+    }
+};
+
+// FIR filter with runtime order, processing chunks of any size. History between
+// calls is kept in a delay line, so chunks of a signal give the same output as the
+// whole signal at once. 'process' does not allocate.
+//
+// With 'fft_size' == 0 all outputs are computed by direct convolution. Otherwise
+// overlap-save convolution is used: every FFT yields 'step' = fft_size - order + 1
+// outputs. The signal is real, so two consecutive steps are transformed at once, as
+// real and imaginary parts of one complex FFT: the filter is real, hence the two
+// convolutions do not mix. Parts of a chunk shorter than 'step' use direct convolution,
+// so no output is delayed.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdFIR {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+
+    static const int DIRECT_BLOCK = 1024;
+
+    int order;
+    int fft_size;
+    int step;
+    FLOAT_T *h;
+    FLOAT_T *line;              // [order - 1 + 2 * step], history first
+    FLOAT_T *H_re, *H_im;       // Filter spectrum divided by fft_size, bit-reversed
+    FLOAT_T *re, *im;
+    UMESimdFFT<FLOAT_T, STRIDE> *fft;
+
+    static FLOAT_T *alloc(int count) {
+        return (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(std::max(1, count)*sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+    }
+
+    // Outputs of 'blocks' (1 or 2) steps, starting at the beginning of the delay line
+    void fft_steps(int blocks, FLOAT_T *y) {
+        const int HISTORY = order - 1;
+
+        std::memcpy(re, line, fft_size * sizeof(FLOAT_T));
+        if (blocks == 2) std::memcpy(im, &line[step], fft_size * sizeof(FLOAT_T));
+        else std::memset(im, 0, fft_size * sizeof(FLOAT_T));
+
+        fft->forward(re, im);
+
+        FLOAT_VEC_T xr, xi, hr, hi;
+        int LOOP_PEEL_OFFSET = (fft_size / STRIDE) * STRIDE;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            xr.loada(&re[i]); xi.loada(&im[i]);
+            hr.loada(&H_re[i]); hi.loada(&H_im[i]);
+            (xr * hr - xi * hi).storea(&re[i]);
+            (xr * hi + xi * hr).storea(&im[i]);
+        }
+        for (int i = LOOP_PEEL_OFFSET; i < fft_size; i++) {
+            FLOAT_T r = re[i] * H_re[i] - im[i] * H_im[i];
+            im[i] = re[i] * H_im[i] + im[i] * H_re[i];
+            re[i] = r;
+        }
+
+        fft->inverse(re, im);
+
+        // The first 'order - 1' outputs are aliased and discarded
+        std::memcpy(y, &re[HISTORY], step * sizeof(FLOAT_T));
+        if (blocks == 2) std::memcpy(&y[step], &im[HISTORY], step * sizeof(FLOAT_T));
+    }
+
+public:
+    UMESimdFIR(int order, FLOAT_T const *coeffs, int fft_size) :
+        order(order), fft_size(fft_size), H_re(nullptr), H_im(nullptr), re(nullptr), im(nullptr), fft(nullptr)
+    {
+        step = (fft_size > 0) ? fft_size - order + 1 : DIRECT_BLOCK;
+
+        h = alloc(order);
+        line = alloc(order - 1 + 2 * step);
+        for (int k = 0; k < order; k++) h[k] = coeffs[k];
+
+        if (fft_size > 0) {
+            fft = new UMESimdFFT<FLOAT_T, STRIDE>(fft_size);
+            H_re = alloc(fft_size);
+            H_im = alloc(fft_size);
+            re = alloc(fft_size);
+            im = alloc(fft_size);
+
+            // Scaling of the inverse transform is applied to the filter spectrum
+            for (int i = 0; i < fft_size; i++) {
+                H_re[i] = (i < order) ? coeffs[i] / FLOAT_T(fft_size) : FLOAT_T(0);
+                H_im[i] = FLOAT_T(0);
+            }
+            fft->forward(H_re, H_im);
+        }
+        reset();
+    }
+
+    ~UMESimdFIR() {
+        UME::DynamicMemory::AlignedFree(h);
+        UME::DynamicMemory::AlignedFree(line);
+        if (fft != nullptr) {
+            delete fft;
+            UME::DynamicMemory::AlignedFree(H_re);
+            UME::DynamicMemory::AlignedFree(H_im);
+            UME::DynamicMemory::AlignedFree(re);
+            UME::DynamicMemory::AlignedFree(im);
+        }
+    }
+
+    // Smallest sensible FFT size: power of 2, at least twice the order
+    static int min_fft_size(int order) {
+        int retval = 4 * STRIDE;
+        while (retval < 2 * order) retval *= 2;
+        return retval;
+    }
+
+    static int fft_step(int order, int fft_size) { return fft_size - order + 1; }
+
+    int get_fft_size() const { return fft_size; }
+
+    void reset() {
+        for (int i = 0; i < order - 1; i++) line[i] = FLOAT_T(0);
+    }
+
+    void process(int samples, FLOAT_T const *x, FLOAT_T *y) {
+        const int HISTORY = order - 1;
+
+        for (int pos = 0; pos < samples; ) {
+            int remaining = samples - pos;
+            int blocks = (fft != nullptr) ? std::min(2, remaining / step) : 0;
+            int count = (blocks > 0) ? blocks * step : std::min(remaining, 2 * step);
+
+            std::memcpy(&line[HISTORY], &x[pos], count * sizeof(FLOAT_T));
+
+            if (blocks > 0) fft_steps(blocks, &y[pos]);
+            else direct_fir<FLOAT_T, STRIDE>(count, order, h, line, &y[pos]);
+
+            // The last 'order - 1' samples become the new history
+            std::memmove(line, &line[count], HISTORY * sizeof(FLOAT_T));
+            pos += count;
+        }
+    }
+};
+
+// Selects between direct and overlap-save convolution for a filter order and the
+// number of samples passed to each 'process' call, by measuring both on random data.
+// FFT sizes from 'UMESimdFIR::min_fft_size' up to 8 times larger are tried, as long
+// as a single call fills at least one FFT step. Decisions are remembered.
+template<typename FLOAT_T, int STRIDE>
+class FIRPlanner {
+private:
+    static const int PROBE_SAMPLES = 32768;
+    static const int PROBE_RUNS = 3;
+    static const int MAX_SIZE_MULTIPLIER = 8;
+
+    std::map<std::pair<int, int>, int> plans;
+
+public:
+    // Best of PROBE_RUNS executions
+    static TIMING_RES measure(int order, int block_size, int fft_size) {
+        int calls = std::max(1, PROBE_SAMPLES / block_size);
+        FLOAT_T *h = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(order*sizeof(FLOAT_T), sizeof(FLOAT_T));
+        FLOAT_T *x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(calls*block_size*sizeof(FLOAT_T), sizeof(FLOAT_T));
+        FLOAT_T *y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(calls*block_size*sizeof(FLOAT_T), sizeof(FLOAT_T));
+        for (int i = 0; i < order; i++) h[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        for (int i = 0; i < calls*block_size; i++) x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+
+        UMESimdFIR<FLOAT_T, STRIDE> filter(order, h, fft_size);
+
+        TIMING_RES best = 0;
+        for (int i = 0; i < PROBE_RUNS; i++) {
+            filter.reset();
+            unsigned long long start = get_timestamp();
+            for (int c = 0; c < calls; c++) {
+                filter.process(block_size, &x[c*block_size], &y[c*block_size]);
+            }
+            unsigned long long end = get_timestamp();
+            if (i == 0 || end - start < best) best = end - start;
+        }
+
+        UME::DynamicMemory::AlignedFree(h);
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+        return best;
+    }
+
+    // Returns FFT size for 'UMESimdFIR', or 0 if direct convolution is faster.
+    int plan(int order, int block_size) {
+        std::pair<int, int> key(order, block_size);
+        auto known = plans.find(key);
+        if (known != plans.end()) return known->second;
+
+        int best_size = 0;
+        TIMING_RES best_time = measure(order, block_size, 0);
+
+        int min_size = UMESimdFIR<FLOAT_T, STRIDE>::min_fft_size(order);
+        for (int size = min_size; size <= MAX_SIZE_MULTIPLIER * min_size; size *= 2) {
+            if (UMESimdFIR<FLOAT_T, STRIDE>::fft_step(order, size) > block_size) break;
+            TIMING_RES t0 = measure(order, block_size, size);
+            if (t0 < best_time) { best_size = size; best_time = t0; }
+        }
+
+        plans[key] = best_size;
+        return best_size;
+    }
+};
+
+// Maximum absolute difference between 'y' and a single direct convolution of 'count'
+// samples of 'x', with zero initial history. Used to check filters that split or
+// transform the input.
+template<typename FLOAT_T, int STRIDE>
+FLOAT_T fir_max_error(int order, FLOAT_T const *h, FLOAT_T const *x, FLOAT_T const *y, int count)
+{
+    std::vector<FLOAT_T> line(order - 1 + count, FLOAT_T(0));
+    std::vector<FLOAT_T> expected(count);
+    std::copy(x, x + count, line.begin() + (order - 1));
+
+    direct_fir<FLOAT_T, STRIDE>(count, order, h, line.data(), expected.data());
+
+    FLOAT_T max_error = FLOAT_T(0);
+    for (int i = 0; i < count; i++) {
+        max_error = std::max(max_error, FLOAT_T(std::abs(y[i] - expected[i])));
+    }
+    return max_error;
+}
+
+// With 'max_error' given, the output is also compared against 'fir_max_error' after
+// the measurement.
+template<typename FLOAT_T, int STRIDE>
+UME_NEVER_INLINE TIMING_RES test_ume_FIR_long(int order, int fft_size, int block_size, FLOAT_T *max_error = nullptr)
+{
+    unsigned long long start, end; // Time measurements
+    FLOAT_T *h, *x, *y;
+
+    h = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(order*sizeof(FLOAT_T), sizeof(FLOAT_T));
+    x = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(ARRAY_SIZE*sizeof(FLOAT_T), sizeof(FLOAT_T));
+    y = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(ARRAY_SIZE*sizeof(FLOAT_T), sizeof(FLOAT_T));
+
+    srand(0);
+    // Initialize arrays with random data
+    for(int i = 0; i < ARRAY_SIZE; i++)
+    {
+        // Generate random numbers in range (0.0;1.0)
+        x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+    }
+    for(int i = 0; i < order; i++)
+    {
+        h[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+    }
+
+    // Filter setup (allocations, filter spectrum) is not measured
+    UMESimdFIR<FLOAT_T, STRIDE> filter(order, h, fft_size);
+
+    start = get_timestamp();
+
+    for (int i = 0; i < ARRAY_SIZE; i += block_size) {
+        filter.process(std::min(block_size, ARRAY_SIZE - i), &x[i], &y[i]);
+    }
+
+    end = get_timestamp();
+
+    if (max_error != nullptr) *max_error = fir_max_error<FLOAT_T, STRIDE>(order, h, x, y, ARRAY_SIZE);
+
+    // Perform reduction to avoid dead-code removals.
+    volatile FLOAT_T red = static_cast<FLOAT_T>(0);
+    for(int i = 0; i < ARRAY_SIZE; i++) {
+        red += y[i];
+    }
+    // cast to void to avoid reduction
+    (void)red;
+
+    UME::DynamicMemory::AlignedFree(h);
+    UME::DynamicMemory::AlignedFree(x);
+    UME::DynamicMemory::AlignedFree(y);
+
+    return end - start;
+}
+
+// Direct convolution, used as the reference for overlap-save results
+template<typename FLOAT_T, int STRIDE>
+void benchmarkDirectLong(std::string const & resultPrefix,
+                         int iterations,
+                         int order, int block_size,
+                         TimingStatistics & stats)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_ume_FIR_long<FLOAT_T, STRIDE>(order, 0, block_size));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: 1.0x)\n";
+}
+
+template<typename FLOAT_T, int STRIDE>
+void benchmarkSIMDLong(std::string const & resultPrefix,
+                       int iterations,
+                       int order, int fft_size, int block_size,
+                       TimingStatistics & reference)
+{
+    TimingStatistics stats;
+    FLOAT_T max_error = FLOAT_T(0);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_ume_FIR_long<FLOAT_T, STRIDE>(order, fft_size, block_size, i == 0 ? &max_error : nullptr));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: " << stats.calculateSpeedup(reference) << "x, max error: " << max_error << ")\n";
+}
+
+#endif
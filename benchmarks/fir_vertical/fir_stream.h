@@ -0,0 +1,233 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#ifndef UME_FIR_STREAM_H_
+#define UME_FIR_STREAM_H_
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "fir_fft.h"
+
+// Stateful FIR filter for online processing: samples arrive in chunks of any size
+// and outputs of a chunk are available as soon as 'process' returns.
+//
+// History is kept in a mirrored ring buffer of RING_SIZE samples: every sample is
+// stored both at its ring position 'w' and at 'w + RING_SIZE'. The 'order - 1'
+// samples preceding the write position together with the new samples are then
+// always contiguous in the upper half, so neither the history nor the input has to
+// be shifted, and a call costs the outputs it computes plus two copies of its input.
+// Chunks longer than the free part of the ring are split. 'process' does not allocate.
+template<typename FLOAT_T, int STRIDE>
+class FIRStream {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+
+    static const int MIN_RING_STEP = 1024;
+
+    int order;
+    int ring_size;              // power of 2, multiple of STRIDE
+    int write_pos;
+    FLOAT_T *h;
+    FLOAT_T *h_reversed;        // h_reversed[j] = h[order - 1 - j]
+    FLOAT_T *ring;              // [2 * ring_size]
+
+    // y[t] = sum(h_reversed[j] * line[t + j]). Used for chunks, or chunk remainders,
+    // shorter than a vector: every output is a dot product vectorized over taps.
+    UME_FORCE_INLINE void dot_fir(int count, FLOAT_T const *line, FLOAT_T *y) const {
+        int LOOP_PEEL_OFFSET = (order / STRIDE) * STRIDE;
+        FLOAT_VEC_T c0, t0;
+
+        for (int t = 0; t < count; t++) {
+            FLOAT_T const *window = &line[t];
+            FLOAT_VEC_T acc0(FLOAT_T(0));
+            for (int j = 0; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+                c0.loada(&h_reversed[j]);
+                t0.load(&window[j]);
+                acc0 = t0.fmuladd(c0, acc0);
+            }
+            FLOAT_T acc = acc0.hadd();
+            // Use scalar code to handle the reminder of taps.
+            for (int j = LOOP_PEEL_OFFSET; j < order; j++) {
+                acc += h_reversed[j] * window[j];
+            }
+            y[t] = acc;
+        }
+    }
+
+public:
+    FIRStream(int order, FLOAT_T const *coeffs) : order(order), write_pos(0) {
+        ring_size = STRIDE;
+        while (ring_size < order - 1 + MIN_RING_STEP) ring_size *= 2;
+
+        h = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(order*sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+        h_reversed = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(order*sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+        ring = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(2*ring_size*sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+
+        for (int k = 0; k < order; k++) {
+            h[k] = coeffs[k];
+            h_reversed[order - 1 - k] = coeffs[k];
+        }
+        reset();
+    }
+
+    ~FIRStream() {
+        UME::DynamicMemory::AlignedFree(h);
+        UME::DynamicMemory::AlignedFree(h_reversed);
+        UME::DynamicMemory::AlignedFree(ring);
+    }
+
+    void reset() {
+        write_pos = 0;
+        for (int i = 0; i < 2 * ring_size; i++) ring[i] = FLOAT_T(0);
+    }
+
+    void process(int samples, FLOAT_T const *x, FLOAT_T *y) {
+        const int HISTORY = order - 1;
+
+        for (int pos = 0; pos < samples; ) {
+            // Do not wrap around within a piece, nor overwrite its own history.
+            int count = std::min(samples - pos, std::min(ring_size - write_pos, ring_size - HISTORY));
+
+            std::memcpy(&ring[write_pos], &x[pos], count * sizeof(FLOAT_T));
+            std::memcpy(&ring[ring_size + write_pos], &x[pos], count * sizeof(FLOAT_T));
+
+            FLOAT_T const *line = &ring[ring_size + write_pos - HISTORY];
+            int VEC_PEEL_OFFSET = (count / STRIDE) * STRIDE;
+            direct_fir<FLOAT_T, STRIDE>(VEC_PEEL_OFFSET, order, h, line, &y[pos]);
+            dot_fir(count - VEC_PEEL_OFFSET, &line[VEC_PEEL_OFFSET], &y[pos + VEC_PEEL_OFFSET]);
+
+            write_pos = (write_pos + count) & (ring_size - 1);
+            pos += count;
+        }
+    }
+};
+
+// Average time of a single 'process' call, for a stream of ARRAY_SIZE samples
+// arriving in chunks of 'chunk' samples. With 'stream' == false, the same chunks are
+// passed to 'UMESimdFIR' using direct convolution, which shifts its delay line after
+// every call. With 'max_error' given, the output is also compared against
+// 'fir_max_error' after the measurement.
+template<typename FLOAT_T, int STRIDE>
+UME_NEVER_INLINE TIMING_RES test_ume_FIR_stream(int order, int chunk, bool stream, FLOAT_T *max_error = nullptr)
+{
+    unsigned long long start, end; // Time measurements
+    FLOAT_T *h, *x, *y;
+
+    h = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(order*sizeof(FLOAT_T), sizeof(FLOAT_T));
+    x = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(ARRAY_SIZE*sizeof(FLOAT_T), sizeof(FLOAT_T));
+    y = (FLOAT_T *) UME::DynamicMemory::AlignedMalloc(ARRAY_SIZE*sizeof(FLOAT_T), sizeof(FLOAT_T));
+
+    srand(0);
+    // Initialize arrays with random data
+    for(int i = 0; i < ARRAY_SIZE; i++)
+    {
+        // Generate random numbers in range (0.0;1.0)
+        x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+    }
+    for(int i = 0; i < order; i++)
+    {
+        h[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+    }
+
+    FIRStream<FLOAT_T, STRIDE> filter(order, h);
+    UMESimdFIR<FLOAT_T, STRIDE> reference(order, h, 0);
+    int calls = (ARRAY_SIZE + chunk - 1) / chunk;
+
+    start = get_timestamp();
+
+    if (stream) {
+        for (int i = 0; i < ARRAY_SIZE; i += chunk) {
+            filter.process(std::min(chunk, ARRAY_SIZE - i), &x[i], &y[i]);
+        }
+    }
+    else {
+        for (int i = 0; i < ARRAY_SIZE; i += chunk) {
+            reference.process(std::min(chunk, ARRAY_SIZE - i), &x[i], &y[i]);
+        }
+    }
+
+    end = get_timestamp();
+
+    if (max_error != nullptr) *max_error = fir_max_error<FLOAT_T, STRIDE>(order, h, x, y, ARRAY_SIZE);
+
+    // Perform reduction to avoid dead-code removals.
+    volatile FLOAT_T red = static_cast<FLOAT_T>(0);
+    for(int i = 0; i < ARRAY_SIZE; i++) {
+        red += y[i];
+    }
+    // cast to void to avoid reduction
+    (void)red;
+
+    UME::DynamicMemory::AlignedFree(h);
+    UME::DynamicMemory::AlignedFree(x);
+    UME::DynamicMemory::AlignedFree(y);
+
+    return (end - start) / calls;
+}
+
+// Delay line shifting after every call, used as the reference for 'FIRStream'
+template<typename FLOAT_T, int STRIDE>
+void benchmarkDelayLineLatency(std::string const & resultPrefix,
+                               int iterations,
+                               int order, int chunk,
+                               TimingStatistics & stats)
+{
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_ume_FIR_stream<FLOAT_T, STRIDE>(order, chunk, false));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: 1.0x)\n";
+}
+
+template<typename FLOAT_T, int STRIDE>
+void benchmarkStreamLatency(std::string const & resultPrefix,
+                            int iterations,
+                            int order, int chunk,
+                            TimingStatistics & reference)
+{
+    TimingStatistics stats;
+    FLOAT_T max_error = FLOAT_T(0);
+
+    for (int i = 0; i < iterations; i++)
+    {
+        stats.update(test_ume_FIR_stream<FLOAT_T, STRIDE>(order, chunk, true, i == 0 ? &max_error : nullptr));
+    }
+
+    std::cout << resultPrefix << (unsigned long long) stats.getAverage()
+        << ", dev: " << (unsigned long long) stats.getStdDev()
+        << " (speedup: " << stats.calculateSpeedup(reference) << "x, max error: " << max_error << ")\n";
+}
+
+#endif
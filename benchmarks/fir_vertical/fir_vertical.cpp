@@ -50,6 +50,16 @@ const int ITERATIONS = 20;
 //#define ENABLE_DEBUG
 #include "fir_vertical_umesimd.h"
 #include "fir_vertical_intel.h"
+#include "fir_bank.h"
+#include "fir_fft.h"
+#include "fir_stream.h"
+
+// Filter bank: many channels filtered at once, one channel per SIMD lane.
+const int BANK_CHANNELS = 2048;
+const int BANK_SAMPLES = 2048;
+const int BANK_ITERATIONS = 5;
+const int LONG_ITERATIONS = 5;
+const int STREAM_ITERATIONS = 3;
 
 // FIR_ORDER == 1 means a 0-order gain filter y[t]=a*x[t]
 // FIR_ORDER == 4 means a 3-order FIR filter y[t]=a*x[t] + b*x[t-1] + c*x[t-2]
@@ -138,6 +148,9 @@ int main()
                  "int: LOAD-CONSTR, SWIZZLEA\n"
                  "float: LOAD-CONSTR, GATHERV, MULV, HADD\n"
                  "swizzle: LOAD-CONSTR\n"
+                 "FIR bank: LOADA, FMULADDV, STOREA (one channel per lane)\n"
+                 "Long FIR: LOAD, FMULADDV, STORE (direct), MULV, ADDV, SUBV (radix-4 FFT, overlap-save)\n"
+                 "FIR stream: LOAD, FMULADDV, HADD (mirrored ring buffer, per call latency)\n"
                  "\n";
 /*
     {
@@ -251,5 +264,69 @@ int main()
         benchmarkSIMD_FIR16<double>("SIMD code (16x64f, fixed permute): ", ITERATIONS, stats_scalar_f);
     }
 
+    for (int order : { 3, 16, 33, 64 }) {
+        std::cout << "\n\nFIR bank (" << BANK_CHANNELS << " channels, " << BANK_SAMPLES
+                  << " samples, " << order << " taps):\n";
+
+        TimingStatistics stats_scalar_f, stats_scalar_d;
+
+        benchmarkScalarBank<float>("Scalar code (float): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_f);
+        benchmarkScalarBank<double>("Scalar code (double): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_d);
+
+        benchmarkSIMDBank<float, 4>("SIMD code (4x32f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_f);
+        benchmarkSIMDBank<float, 8>("SIMD code (8x32f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_f);
+        benchmarkSIMDBank<float, 16>("SIMD code (16x32f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_f);
+        benchmarkSIMDBank<double, 2>("SIMD code (2x64f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_d);
+        benchmarkSIMDBank<double, 4>("SIMD code (4x64f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_d);
+        benchmarkSIMDBank<double, 8>("SIMD code (8x64f): ", BANK_ITERATIONS, BANK_CHANNELS, order, BANK_SAMPLES, stats_scalar_d);
+    }
+
+    // Overlap-save is only used when the planner measured it to be faster. Calls of
+    // ARRAY_SIZE samples model offline processing, calls of 256 samples a stream.
+    FIRPlanner<float, 8> planner_f;
+    FIRPlanner<double, 4> planner_d;
+
+    for (int order : { 16, 64, 256, 1024, 4096 }) {
+        for (int block_size : { 256, ARRAY_SIZE }) {
+            std::cout << "\n\nLong FIR (" << order << " taps, " << block_size << " samples per call):\n";
+
+            TimingStatistics stats_direct_f, stats_direct_d;
+
+            benchmarkDirectLong<float, 8>("SIMD direct (8x32f): ", LONG_ITERATIONS, order, block_size, stats_direct_f);
+            int fft_size_f = planner_f.plan(order, block_size);
+            if (fft_size_f > 0) {
+                benchmarkSIMDLong<float, 8>("SIMD overlap-save (8x32f, FFT " + std::to_string(fft_size_f) + "): ",
+                    LONG_ITERATIONS, order, fft_size_f, block_size, stats_direct_f);
+            }
+            else {
+                std::cout << "SIMD overlap-save (8x32f): not selected by planner\n";
+            }
+
+            benchmarkDirectLong<double, 4>("SIMD direct (4x64f): ", LONG_ITERATIONS, order, block_size, stats_direct_d);
+            int fft_size_d = planner_d.plan(order, block_size);
+            if (fft_size_d > 0) {
+                benchmarkSIMDLong<double, 4>("SIMD overlap-save (4x64f, FFT " + std::to_string(fft_size_d) + "): ",
+                    LONG_ITERATIONS, order, fft_size_d, block_size, stats_direct_d);
+            }
+            else {
+                std::cout << "SIMD overlap-save (4x64f): not selected by planner\n";
+            }
+        }
+    }
+
+    // Online processing: time of a single call for chunks arriving one at a time
+    for (int order : { 16, 64, 256 }) {
+        for (int chunk = 1; chunk <= 4096; chunk *= 2) {
+            std::cout << "\n\nFIR stream (" << order << " taps, " << chunk << " samples per call):\n";
+
+            TimingStatistics stats_delay_f, stats_delay_d;
+
+            benchmarkDelayLineLatency<float, 8>("SIMD delay line (8x32f): ", STREAM_ITERATIONS, order, chunk, stats_delay_f);
+            benchmarkStreamLatency<float, 8>("SIMD ring buffer (8x32f): ", STREAM_ITERATIONS, order, chunk, stats_delay_f);
+            benchmarkDelayLineLatency<double, 4>("SIMD delay line (4x64f): ", STREAM_ITERATIONS, order, chunk, stats_delay_d);
+            benchmarkStreamLatency<double, 4>("SIMD ring buffer (4x64f): ", STREAM_ITERATIONS, order, chunk, stats_delay_d);
+        }
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -31,10 +31,12 @@
 #include <iostream>
 #include <memory>
 
-#include <immintrin.h> 
 #include <cmath>
 #include <time.h>
 #include <stdlib.h>
+#include <string>
+#include <thread>
+#include <algorithm>
 
 // Files containing different implementations
 #include "matmul_common.h"
@@ -50,145 +52,111 @@
 #include "matmul_AVX512.h"
 #endif
 #include "matmul_UMESIMD.h"
-
-const int MATRIX_RANK = 1000; // Array size increased to show the peeling effect.
-//alignas(32) float x[ARRAY_SIZE];
-
-int main()
+#include "matmul_blocked.h"
+#include "matmul_strassen.h"
+
+template<typename FLOAT_T>
+struct MatmulVectors {};
+
+template<> struct MatmulVectors<float> {
+    typedef UME::SIMD::SIMD4_32f  SIMD_NARROW;
+    typedef UME::SIMD::SIMD8_32f  SIMD_NATIVE;
+    typedef UME::SIMD::SIMD16_32f SIMD_WIDE;
+};
+
+template<> struct MatmulVectors<double> {
+    typedef UME::SIMD::SIMD2_64f  SIMD_NARROW;
+    typedef UME::SIMD::SIMD4_64f  SIMD_NATIVE;
+    typedef UME::SIMD::SIMD8_64f  SIMD_WIDE;
+};
+
+template<typename FLOAT_T>
+void registerMatmulCategory(BenchmarkHarness & harness, int rank, int iterations, int hardware_threads)
 {
-    const int ITERATIONS = 20;
-
-    std::cout << "The result is amount of time it takes to calculate multiplication of two \n"
-                 "square matrices (" << MATRIX_RANK << "x" << MATRIX_RANK << ").\n"
-                 "All measured algorithms are non-blocking.\n"
-                 "All timing results in nanoseconds. \n"
-                 "RMS error calculated in regard to scalar (naive) version (single or double precision).\n"
-                 "Speedup calculated with scalar (naive) floating point result as reference.\n\n"
-                 "SIMD version uses following operations: \n"
-                 " LOADA, FMULADDV, HADD\n\n";
-
-    // SCALAR code, single precision
-    TimingStatistics stats_scalar_naive_f;
-    Statistics<float> error_scalar_naive_f;
-
-    for (int i = 0; i < ITERATIONS; i++) {
-        RESULTS<float> results = test_scalar_naive<float, MATRIX_RANK>();
-
-        stats_scalar_naive_f.update(results.elapsed);
-        error_scalar_naive_f.update(results.RMS_error);
+    typedef typename MatmulVectors<FLOAT_T>::SIMD_NARROW SIMD_NARROW;
+    typedef typename MatmulVectors<FLOAT_T>::SIMD_NATIVE SIMD_NATIVE;
+    typedef typename MatmulVectors<FLOAT_T>::SIMD_WIDE SIMD_WIDE;
+
+    // Scalar code is too slow for the largest ranks.
+    const int MAX_SCALAR_RANK = 1024;
+    // Strassen-Winograd only pays off for large ranks.
+    const int MIN_STRASSEN_RANK = 1024;
+    const int STRASSEN_CUTOFFS[] = { 256, 512, 1024 };
+
+    std::string categoryName = std::string("MATMUL");
+    TestCategory *newCategory = new TestCategory(categoryName);
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), rank));
+
+    if (rank <= MAX_SCALAR_RANK) {
+        newCategory->registerTest(new ScalarNaiveTest<FLOAT_T>(rank));
+        newCategory->registerTest(new ScalarFoxTest<FLOAT_T>(rank));
     }
-
-    std::cout << "Scalar code (naive, float): " << (unsigned long long) stats_scalar_naive_f.getAverage()
-        << ", dev: " << (unsigned long long) stats_scalar_naive_f.getStdDev()
-        << ", RMS error: " << error_scalar_naive_f.getAverage()
-        << " (speedup: 1.0x)\n";
-
-
-    // SCALAR code, single precision, Fox's algorithm
-    TimingStatistics stats_scalar_fox_f;
-    Statistics<float> error_scalar_fox_f;
-
-    for (int i = 0; i < ITERATIONS; i++) {
-        RESULTS<float> results = test_scalar_fox<float, MATRIX_RANK>();
-
-        stats_scalar_fox_f.update(results.elapsed);
-        error_scalar_fox_f.update(results.RMS_error);
-    }
-
-    std::cout << "Scalar code (Fox, float): " << (unsigned long long) stats_scalar_fox_f.getAverage()
-        << ", dev: " << (unsigned long long) stats_scalar_fox_f.getStdDev()
-        << ", RMS error: " << error_scalar_fox_f.getAverage()
-        << " (speedup: " << stats_scalar_fox_f.calculateSpeedup(stats_scalar_naive_f) << "x)\n";
-
-    // SSE intrinsic code, single precision
 #if defined(__SSE__)
-    benchmark_sse_32f<MATRIX_RANK>("SSE intrinsics code (4x32f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "SSE intrinsics code (4x32f): SSE instruction set not detected\n";
+    newCategory->registerTest(new SSETest<FLOAT_T>(rank));
 #endif
-
-    // AVX/AVX2 intrinsic code, single precision
-#if defined(__AVX__) || defined(__AVX2__)
-    benchmark_avx_32f<MATRIX_RANK>("AVX/AVX2 intrinsics code (8x32f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "AVX/AVX2 intrinsics code (8x32f): AVX/AVX2 instruction set not detected\n";
+#if defined(__AVX__)
+    newCategory->registerTest(new AVXTest<FLOAT_T>(rank));
 #endif
-
-    // AVX512 intrinsic code, single precision
 #if defined(__AVX512F__)
-    benchmark_avx512_32f<MATRIX_RANK>("AVX512 instrinsics code (16x32f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "AVX512 intrinsics code (16x32f): AVX512 instruction set not detected\n";
+    newCategory->registerTest(new AVX512Test<FLOAT_T>(rank));
 #endif
+    newCategory->registerTest(new UMESimdTest<SIMD_NARROW>(rank));
+    newCategory->registerTest(new UMESimdTest<SIMD_NATIVE>(rank));
+    newCategory->registerTest(new UMESimdTest<SIMD_WIDE>(rank));
+    newCategory->registerTest(new UMESimdBlockedTest<SIMD_NATIVE>(rank));
+    newCategory->registerTest(new UMESimdBlockedTest<SIMD_WIDE>(rank));
+    // Parallel Fox's algorithm is measured for square thread grids up to the number
+    // of hardware threads.
+    for (int q = 1; q * q <= hardware_threads; q++) {
+        newCategory->registerTest(new UMESimdFoxTest<SIMD_NATIVE>(rank, q));
+    }
+    if (rank >= MIN_STRASSEN_RANK) {
+        for (int cutoff : STRASSEN_CUTOFFS) {
+            if (cutoff < rank) newCategory->registerTest(new UMESimdStrassenTest<SIMD_NATIVE>(rank, cutoff));
+        }
+    }
 
-    // SIMD code, single precision
-    benchmarkSIMD<UME::SIMD::SIMD1_32f, MATRIX_RANK>("SIMD code (1x32f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD2_32f, MATRIX_RANK>("SIMD code (2x32f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD4_32f, MATRIX_RANK>("SIMD code (4x32f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD8_32f, MATRIX_RANK>("SIMD code (8x32f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD16_32f, MATRIX_RANK>("SIMD code (16x32f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD32_32f, MATRIX_RANK>("SIMD code (32x32f): ", ITERATIONS, stats_scalar_naive_f);
+    harness.registerTestCategory(newCategory, iterations);
+}
 
+int main(int argc, char **argv)
+{
+    int MIN_RANK = 64;
+    int MAX_RANK = 2048;
+    int PROGRESSION = 2;
+    int ITERATIONS = 10;
+    // Large ranks take seconds per run.
+    int LARGE_RANK = 1024;
+    int LARGE_RANK_ITERATIONS = 3;
+    int HARDWARE_THREADS = std::max(1, (int)std::thread::hardware_concurrency());
 
-    // SCALAR code, double precision
-    TimingStatistics stats_scalar_naive_d;
-    Statistics<double> error_scalar_naive_d;
+    BenchmarkHarness harness(argc, argv);
 
-    for (int i = 0; i < ITERATIONS; i++) {
-        RESULTS<double> results = test_scalar_naive<double, MATRIX_RANK>();
+    std::cout << "The result is amount of time it takes to calculate multiplication of two \n"
+                 "square matrices, for ranks from " << MIN_RANK << " to " << MAX_RANK << ".\n"
+                 "'UME::SIMD blocked', 'parallel Fox' and 'Strassen-Winograd' codes are blocking,\n"
+                 "remaining algorithms are non-blocking.\n"
+                 "Blocking parameters are selected by a short search at the first run and\n"
+                 "cached per CPU model in " << MATMUL_TUNING_CACHE << ".\n"
+                 "Use -v to report RMS error calculated in regard to a naive product\n"
+                 "accumulated in double precision.\n"
+                 "Parallel Fox's algorithm requires OpenMP (make USE_OPENMP=ON), otherwise the grid is\n"
+                 "processed by a single thread.\n"
+                 "UME::SIMD version uses following operations: \n"
+                 " LOADA, FMULADDV, HADD\n\n";
 
-        stats_scalar_naive_d.update(results.elapsed);
-        error_scalar_naive_d.update(results.RMS_error);
+    for (int rank = MIN_RANK; rank <= MAX_RANK; rank *= PROGRESSION) {
+        int iterations = rank >= LARGE_RANK ? LARGE_RANK_ITERATIONS : ITERATIONS;
+        registerMatmulCategory<float>(harness, rank, iterations, HARDWARE_THREADS);
     }
 
-    std::cout << "Scalar code (naive, double): " << (unsigned long long) stats_scalar_naive_d.getAverage()
-        << ", dev: " << (unsigned long long) stats_scalar_naive_d.getStdDev()
-        << ", RMS error: " << error_scalar_naive_d.getAverage()
-        << " (speedup: " << stats_scalar_naive_d.calculateSpeedup(stats_scalar_naive_f) << "x)\n";
-
-    // scalar code, double precision, Fox's algorithm
-    TimingStatistics stats_scalar_fox_d;
-    Statistics<double> errors_scalar_fox_d;
-
-    for (int i = 0; i < ITERATIONS; i++) {
-        RESULTS<double> results = test_scalar_fox<double, MATRIX_RANK>();
-
-        stats_scalar_fox_d.update(results.elapsed);
-        errors_scalar_fox_d.update(results.RMS_error);
+    for (int rank = MIN_RANK; rank <= MAX_RANK; rank *= PROGRESSION) {
+        int iterations = rank >= LARGE_RANK ? LARGE_RANK_ITERATIONS : ITERATIONS;
+        registerMatmulCategory<double>(harness, rank, iterations, HARDWARE_THREADS);
     }
 
-    std::cout << "Scalar code (Fox, double): " << (unsigned long long) stats_scalar_fox_d.getAverage()
-        << ", dev: " << (unsigned long long) stats_scalar_fox_d.getStdDev()
-        << ", RMS error: " << errors_scalar_fox_d.getAverage()
-        << " (speedup: " << stats_scalar_fox_d.calculateSpeedup(stats_scalar_naive_f) << "x)\n";
-
-    // SSE intrinsic code, double precision
-#if defined(__SSE__)
-    benchmark_sse_64f<MATRIX_RANK>("SSE intrinsics code (2x64f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "SSE intrinsics code (2x64f): AVX/AVX2 instruction set not detected\n";
-#endif
-
-    // AVX/AVX2 intrinsic code, double precision
-#if defined(__AVX__) || defined(__AVX2__)
-    benchmark_avx_64f<MATRIX_RANK>("AVX/AVX2 intrinsics code (4x64f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "AVX/AVX2 intrinsics code (4x64f): AVX/AVX2 instruction set not detected\n";
-#endif
-
-    // AVX512 intrinsic code, double precision
-#if defined(__AVX512F__)
-    benchmark_avx512_64f<MATRIX_RANK>("AVX512 intrinsics code (8x64f): ", ITERATIONS, stats_scalar_naive_f);
-#else
-    std::cout << "AVX512 intrinsics code (8x64f): AVX512 instruction set not detected\n";
-#endif
-
-    // SIMD code, double precision
-    benchmarkSIMD<UME::SIMD::SIMD1_64f, MATRIX_RANK>("SIMD code (1x64f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD2_64f, MATRIX_RANK>("SIMD code (2x64f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD4_64f, MATRIX_RANK>("SIMD code (4x64f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD8_64f, MATRIX_RANK>("SIMD code (8x64f): ", ITERATIONS, stats_scalar_naive_f);
-    benchmarkSIMD<UME::SIMD::SIMD16_64f, MATRIX_RANK>("SIMD code (16x64f): ", ITERATIONS, stats_scalar_naive_f);
+    harness.runTests(ITERATIONS);
 
     return 0;
 }
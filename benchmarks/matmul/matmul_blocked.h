@@ -0,0 +1,518 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+
+#ifndef MATMUL_BLOCKED_H_
+#define MATMUL_BLOCKED_H_
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "matmul_common.h"
+
+// Cache-blocked matrix multiplication with runtime blocking parameters.
+//
+// The structure follows the 'packed panels' scheme (Goto, BLIS): KC x NC block of B
+// is packed into micro-panels of NR columns (L3 resident), MC x KC block of A is packed
+// into micro-panels of MR rows (L2 resident), and a MR x NR tile of C is computed in
+// registers. Cache blocks (MC, NC, KC) are runtime values. Register tile is selected
+// from a fixed set of instantiated micro-kernels. The best parameters for a given CPU
+// are found by a short search at startup and cached in a file.
+
+struct MatmulBlocking {
+    int MR;         // Rows of the register tile
+    int NR_VECS;    // Columns of the register tile, in SIMD vectors
+    int KC;
+    int MC;
+    int NC;
+};
+
+// Register tiles (MR, NR_VECS) with instantiated micro-kernels.
+static const int REGISTER_TILE_COUNT = 6;
+static const int REGISTER_TILES[REGISTER_TILE_COUNT][2] = {
+    { 4, 1 }, { 8, 1 }, { 4, 2 }, { 6, 2 }, { 8, 2 }, { 4, 3 }
+};
+
+// Edge tiles are spilled to a stack buffer sized for the largest SIMD stride.
+static const int BLOCKED_MAX_STRIDE = 32;
+
+static const char MATMUL_TUNING_CACHE[] = "matmul_tuning.cache";
+
+inline std::string cpu_model_name() {
+    char brand[49];
+    memset(brand, 0, sizeof(brand));
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if ((unsigned int)regs[0] >= 0x80000004) {
+        for (int i = 0; i < 3; i++) {
+            __cpuid(regs, 0x80000002 + i);
+            memcpy(&brand[16 * i], regs, 16);
+        }
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned int regs[4];
+    if (__get_cpuid(0x80000000, &regs[0], &regs[1], &regs[2], &regs[3]) && regs[0] >= 0x80000004) {
+        for (int i = 0; i < 3; i++) {
+            __get_cpuid(0x80000002 + i, &regs[0], &regs[1], &regs[2], &regs[3]);
+            memcpy(&brand[16 * i], regs, 16);
+        }
+    }
+#else
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 8, "Hardware") == 0) {
+            std::string value = line.substr(line.find(':') + 1);
+            strncpy(brand, value.c_str(), sizeof(brand) - 1);
+            break;
+        }
+    }
+#endif
+    std::string retval(brand);
+    // Brand string is padded with spaces
+    retval.erase(0, retval.find_first_not_of(' '));
+    retval.erase(retval.find_last_not_of(' ') + 1);
+    return retval.empty() ? "unknown" : retval;
+}
+
+template<typename FLOAT_VEC_TYPE, int MR, int NR_VECS>
+struct BlockedMatmulKernel {
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    // Pack 'mc x kc' block of A into micro-panels of MR rows. Within a micro-panel
+    // elements are stored column by column. Missing rows are padded with zeros.
+    static UME_FORCE_INLINE void pack_A(int mc, int kc, FLOAT_T const *A, int lda, FLOAT_T *Ap) {
+        for (int i = 0; i < mc; i += MR) {
+            int mr = std::min(MR, mc - i);
+            for (int p = 0; p < kc; p++) {
+                for (int r = 0; r < mr; r++) Ap[r] = A[(i + r)*lda + p];
+                for (int r = mr; r < MR; r++) Ap[r] = FLOAT_T(0);
+                Ap += MR;
+            }
+        }
+    }
+
+    // Pack 'kc x nc' block of B into micro-panels of NR columns. Within a micro-panel
+    // elements are stored row by row. Missing columns are padded with zeros.
+    static UME_FORCE_INLINE void pack_B(int kc, int nc, FLOAT_T const *B, int ldb, FLOAT_T *Bp) {
+        const int SIMD_STRIDE = FLOAT_VEC_TYPE::length();
+        const int NR = NR_VECS * SIMD_STRIDE;
+        for (int j = 0; j < nc; j += NR) {
+            int nr = std::min(NR, nc - j);
+            for (int p = 0; p < kc; p++) {
+                if (nr == NR) {
+                    for (int v = 0; v < NR_VECS; v++) {
+                        FLOAT_VEC_TYPE t0;
+                        t0.load(&B[p*ldb + j + v*SIMD_STRIDE]);
+                        t0.storea(&Bp[v*SIMD_STRIDE]);
+                    }
+                }
+                else {
+                    for (int c = 0; c < nr; c++) Bp[c] = B[p*ldb + j + c];
+                    for (int c = nr; c < NR; c++) Bp[c] = FLOAT_T(0);
+                }
+                Bp += NR;
+            }
+        }
+    }
+
+    // C[0:mr, 0:nr] (+)= Ap * Bp. C is only read when 'accumulate' is set.
+    static UME_FORCE_INLINE void micro_kernel(
+        int kc,
+        FLOAT_T const *Ap,
+        FLOAT_T const *Bp,
+        FLOAT_T *C, int ldc,
+        int mr, int nr,
+        bool accumulate)
+    {
+        const int SIMD_STRIDE = FLOAT_VEC_TYPE::length();
+        const int NR = NR_VECS * SIMD_STRIDE;
+
+        FLOAT_VEC_TYPE acc[MR][NR_VECS];
+        for (int r = 0; r < MR; r++) {
+            for (int v = 0; v < NR_VECS; v++) acc[r][v] = FLOAT_T(0);
+        }
+
+        for (int p = 0; p < kc; p++) {
+            FLOAT_VEC_TYPE b[NR_VECS];
+            for (int v = 0; v < NR_VECS; v++) b[v].loada(&Bp[p*NR + v*SIMD_STRIDE]);
+
+            for (int r = 0; r < MR; r++) {
+                FLOAT_VEC_TYPE a(Ap[p*MR + r]);
+                for (int v = 0; v < NR_VECS; v++) acc[r][v] = a.fmuladd(b[v], acc[r][v]);
+            }
+        }
+
+        if (mr == MR && nr == NR) {
+            for (int r = 0; r < MR; r++) {
+                for (int v = 0; v < NR_VECS; v++) {
+                    FLOAT_T *c = &C[r*ldc + v*SIMD_STRIDE];
+                    if (accumulate) {
+                        FLOAT_VEC_TYPE t0;
+                        t0.load(c);
+                        acc[r][v] += t0;
+                    }
+                    acc[r][v].store(c);
+                }
+            }
+        }
+        else {
+            // Edge tile: spill the accumulators and update only the valid part.
+            FLOAT_T tile[MR * NR_VECS * BLOCKED_MAX_STRIDE];
+            for (int r = 0; r < MR; r++) {
+                for (int v = 0; v < NR_VECS; v++) acc[r][v].store(&tile[r*NR + v*SIMD_STRIDE]);
+            }
+            for (int r = 0; r < mr; r++) {
+                for (int c = 0; c < nr; c++) {
+                    C[r*ldc + c] = accumulate ? C[r*ldc + c] + tile[r*NR + c] : tile[r*NR + c];
+                }
+            }
+        }
+    }
+
+    // C (+)= A * B for row-major matrices A (M x K), B (K x N) and C (M x N). 'packedA'
+    // and 'packedB' have to hold 'blocked_packed_A_size' and 'blocked_packed_B_size'
+    // elements.
+    static void gemm(int M, int N, int K, MatmulBlocking const & blocking,
+        FLOAT_T const *A, int lda,
+        FLOAT_T const *B, int ldb,
+        FLOAT_T *C, int ldc,
+        FLOAT_T *packedA, FLOAT_T *packedB,
+        bool accumulate)
+    {
+        const int NR = NR_VECS * FLOAT_VEC_TYPE::length();
+
+        for (int jc = 0; jc < N; jc += blocking.NC) {
+            int nc = std::min(blocking.NC, N - jc);
+
+            for (int pc = 0; pc < K; pc += blocking.KC) {
+                int kc = std::min(blocking.KC, K - pc);
+
+                pack_B(kc, nc, &B[pc*ldb + jc], ldb, packedB);
+
+                for (int ic = 0; ic < M; ic += blocking.MC) {
+                    int mc = std::min(blocking.MC, M - ic);
+
+                    pack_A(mc, kc, &A[ic*lda + pc], lda, packedA);
+
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            micro_kernel(kc, &packedA[ir*kc], &packedB[jr*kc],
+                                &C[(ic + ir)*ldc + jc + jr], ldc,
+                                std::min(MR, mc - ir), std::min(NR, nc - jr), accumulate || pc > 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Round cache blocks to multiples of the register tile.
+template<typename FLOAT_VEC_TYPE>
+MatmulBlocking normalize_blocking(MatmulBlocking blocking) {
+    int NR = blocking.NR_VECS * FLOAT_VEC_TYPE::length();
+    blocking.KC = std::max(1, blocking.KC);
+    blocking.MC = std::max(1, blocking.MC / blocking.MR) * blocking.MR;
+    blocking.NC = std::max(1, blocking.NC / NR) * NR;
+    return blocking;
+}
+
+inline int blocked_packed_A_size(MatmulBlocking const & blocking) {
+    return blocking.MC * blocking.KC;
+}
+
+inline int blocked_packed_B_size(MatmulBlocking const & blocking) {
+    return blocking.KC * blocking.NC;
+}
+
+template<typename FLOAT_VEC_TYPE>
+bool is_valid_register_tile(int MR, int NR_VECS) {
+    if ((int)FLOAT_VEC_TYPE::length() > BLOCKED_MAX_STRIDE) return false;
+    for (int i = 0; i < REGISTER_TILE_COUNT; i++) {
+        if (REGISTER_TILES[i][0] == MR && REGISTER_TILES[i][1] == NR_VECS) return true;
+    }
+    return false;
+}
+
+// Dispatch to the micro-kernel instantiated for the selected register tile.
+// C = A * B, or C += A * B when 'accumulate' is set.
+template<typename FLOAT_VEC_TYPE>
+void blocked_gemm(int M, int N, int K, MatmulBlocking const & blocking,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T const *A, int lda,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T const *B, int ldb,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *C, int ldc,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *packedA,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *packedB,
+    bool accumulate = false)
+{
+    int tile = blocking.MR * 16 + blocking.NR_VECS;
+    switch (tile) {
+    case 4 * 16 + 1: BlockedMatmulKernel<FLOAT_VEC_TYPE, 4, 1>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    case 8 * 16 + 1: BlockedMatmulKernel<FLOAT_VEC_TYPE, 8, 1>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    case 4 * 16 + 2: BlockedMatmulKernel<FLOAT_VEC_TYPE, 4, 2>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    case 6 * 16 + 2: BlockedMatmulKernel<FLOAT_VEC_TYPE, 6, 2>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    case 8 * 16 + 2: BlockedMatmulKernel<FLOAT_VEC_TYPE, 8, 2>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    case 4 * 16 + 3: BlockedMatmulKernel<FLOAT_VEC_TYPE, 4, 3>::gemm(M, N, K, blocking, A, lda, B, ldb, C, ldc, packedA, packedB, accumulate); break;
+    default:
+        // Blockings come from 'MatmulAutotuner', which only selects tiles listed in
+        // REGISTER_TILES. Anything else would leave C unwritten.
+        std::fprintf(stderr, "blocked_gemm: unsupported register tile %dx%d\n", blocking.MR, blocking.NR_VECS);
+        std::abort();
+    }
+}
+
+// C = A * B for square N x N row-major matrices.
+template<typename FLOAT_VEC_TYPE>
+void blocked_matmul(int N, MatmulBlocking const & blocking,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T const *A,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T const *B,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *C,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *packedA,
+    typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T *packedB)
+{
+    blocked_gemm<FLOAT_VEC_TYPE>(N, N, N, blocking, A, N, B, N, C, N, packedA, packedB);
+}
+
+// Selects blocking parameters for the current CPU. Results of the search are stored
+// in MATMUL_TUNING_CACHE, one line per CPU model and vector type:
+//
+//   <CPU model>;<precision>x<SIMD stride>\t<MR> <NR_VECS> <KC> <MC> <NC>
+//
+// Remove the file (or the line) to force a new search, e.g. after changing compiler
+// flags.
+template<typename FLOAT_VEC_TYPE>
+class MatmulAutotuner {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    // The search is run on a problem much larger than L2, so that the effect of
+    // blocking is visible, but small enough to keep the search short.
+    static const int PROBE_RANK = 512;
+    static const int PROBE_RUNS = 3;
+
+    static std::string cache_key() {
+        return cpu_model_name() + ";" + std::to_string(8 * sizeof(FLOAT_T)) +
+            "x" + std::to_string(FLOAT_VEC_TYPE::length());
+    }
+
+    static bool load(std::string const & key, MatmulBlocking & blocking) {
+        std::ifstream file(MATMUL_TUNING_CACHE);
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t separator = line.find('\t');
+            if (separator == std::string::npos || line.substr(0, separator) != key) continue;
+
+            MatmulBlocking t0;
+            if (sscanf(line.c_str() + separator + 1, "%d %d %d %d %d",
+                &t0.MR, &t0.NR_VECS, &t0.KC, &t0.MC, &t0.NC) == 5 &&
+                is_valid_register_tile<FLOAT_VEC_TYPE>(t0.MR, t0.NR_VECS) &&
+                t0.KC > 0 && t0.MC > 0 && t0.NC > 0)
+            {
+                blocking = normalize_blocking<FLOAT_VEC_TYPE>(t0);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void store(std::string const & key, MatmulBlocking const & blocking) {
+        std::ofstream file(MATMUL_TUNING_CACHE, std::ios_base::app);
+        file << key << "\t" << blocking.MR << " " << blocking.NR_VECS << " "
+            << blocking.KC << " " << blocking.MC << " " << blocking.NC << "\n";
+    }
+
+    // Best of PROBE_RUNS executions
+    static TIMING_RES measure(MatmulBlocking const & blocking, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T *C) {
+        uint32_t ALIGNMENT = FLOAT_VEC_TYPE::alignment();
+        FLOAT_T *packedA = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_A_size(blocking)*sizeof(FLOAT_T), ALIGNMENT);
+        FLOAT_T *packedB = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_B_size(blocking)*sizeof(FLOAT_T), ALIGNMENT);
+
+        TIMING_RES best = 0;
+        for (int i = 0; i < PROBE_RUNS; i++) {
+            unsigned long long start = get_timestamp();
+            blocked_matmul<FLOAT_VEC_TYPE>(PROBE_RANK, blocking, A, B, C, packedA, packedB);
+            unsigned long long end = get_timestamp();
+            if (i == 0 || end - start < best) best = end - start;
+        }
+
+        UME::DynamicMemory::AlignedFree(packedA);
+        UME::DynamicMemory::AlignedFree(packedB);
+        return best;
+    }
+
+    // Coordinate search: register tile first (with default cache blocks), then KC,
+    // MC and NC, each with the remaining parameters fixed at their best values.
+    static MatmulBlocking tune() {
+        uint32_t ALIGNMENT = FLOAT_VEC_TYPE::alignment();
+        FLOAT_T *A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(PROBE_RANK*PROBE_RANK*sizeof(FLOAT_T), ALIGNMENT);
+        FLOAT_T *B = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(PROBE_RANK*PROBE_RANK*sizeof(FLOAT_T), ALIGNMENT);
+        FLOAT_T *C = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(PROBE_RANK*PROBE_RANK*sizeof(FLOAT_T), ALIGNMENT);
+        for (int i = 0; i < PROBE_RANK*PROBE_RANK; i++) {
+            A[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+            B[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+
+        const int KC_CANDIDATES[] = { 64, 128, 192, 256, 384, 512 };
+        const int MC_CANDIDATES[] = { 24, 48, 96, 144, 192, 288 };
+        const int NC_CANDIDATES[] = { 256, 512, 1024, 2048, 4096 };
+
+        MatmulBlocking best = { 4, 1, 256, 96, 2048 };
+        TIMING_RES best_time = 0;
+
+        for (int i = 0; i < REGISTER_TILE_COUNT; i++) {
+            MatmulBlocking t0 = best;
+            t0.MR = REGISTER_TILES[i][0];
+            t0.NR_VECS = REGISTER_TILES[i][1];
+            t0 = normalize_blocking<FLOAT_VEC_TYPE>(t0);
+            TIMING_RES t1 = measure(t0, A, B, C);
+            if (i == 0 || t1 < best_time) { best = t0; best_time = t1; }
+        }
+        for (int kc : KC_CANDIDATES) {
+            MatmulBlocking t0 = best;
+            t0.KC = kc;
+            TIMING_RES t1 = measure(t0, A, B, C);
+            if (t1 < best_time) { best = t0; best_time = t1; }
+        }
+        for (int mc : MC_CANDIDATES) {
+            MatmulBlocking t0 = best;
+            t0.MC = mc;
+            t0 = normalize_blocking<FLOAT_VEC_TYPE>(t0);
+            TIMING_RES t1 = measure(t0, A, B, C);
+            if (t1 < best_time) { best = t0; best_time = t1; }
+        }
+        for (int nc : NC_CANDIDATES) {
+            MatmulBlocking t0 = best;
+            t0.NC = nc;
+            t0 = normalize_blocking<FLOAT_VEC_TYPE>(t0);
+            TIMING_RES t1 = measure(t0, A, B, C);
+            if (t1 < best_time) { best = t0; best_time = t1; }
+        }
+
+        UME::DynamicMemory::AlignedFree(A);
+        UME::DynamicMemory::AlignedFree(B);
+        UME::DynamicMemory::AlignedFree(C);
+        return best;
+    }
+
+public:
+    // Returns cached parameters for this CPU, or runs the search and caches its result.
+    // The result is also kept in memory, tests initialized once per iteration do not
+    // re-read the file.
+    static MatmulBlocking get(bool & from_cache) {
+        static bool known = false;
+        static bool known_from_cache = false;
+        static MatmulBlocking blocking;
+
+        if (!known) {
+            std::string key = cache_key();
+            known_from_cache = load(key, blocking);
+            if (!known_from_cache) {
+                blocking = tune();
+                store(key, blocking);
+            }
+            known = true;
+        }
+        from_cache = known_from_cache;
+        return blocking;
+    }
+};
+
+// Blocking parameters are obtained in the first 'initialize', so the search (if
+// any) is not measured.
+template<typename FLOAT_VEC_TYPE>
+class UMESimdBlockedTest : public MatmulTest<typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T> {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    MatmulBlocking blocking;
+    bool tuned;
+    bool from_cache;
+    // Packing buffers are part of the algorithm workspace, their allocation is not measured.
+    FLOAT_T *packedA, *packedB;
+
+public:
+    UMESimdBlockedTest(int rank) :
+        MatmulTest<FLOAT_T>(rank, rank, FLOAT_VEC_TYPE::alignment()),
+        tuned(false), from_cache(false), packedA(nullptr), packedB(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulTest<FLOAT_T>::initialize();
+        blocking = MatmulAutotuner<FLOAT_VEC_TYPE>::get(from_cache);
+        tuned = true;
+        packedA = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_A_size(blocking)*sizeof(FLOAT_T), this->alignment);
+        packedB = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_B_size(blocking)*sizeof(FLOAT_T), this->alignment);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        blocked_matmul<FLOAT_VEC_TYPE>(this->rank, blocking, this->A, this->B, this->C, packedA, packedB);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(packedA);
+        UME::DynamicMemory::AlignedFree(packedB);
+        MatmulTest<FLOAT_T>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD blocked, " + ScalarToString<FLOAT_T>::value() +
+            " " + std::to_string(this->rank) +
+            ", stride " + std::to_string(FLOAT_VEC_TYPE::length());
+        return retval;
+    }
+
+    // The selected blocking depends on the CPU and on the cache file, so it is
+    // reported as metrics rather than in the identifier.
+    UME_NEVER_INLINE virtual Test::TestMetrics get_test_metrics() {
+        Test::TestMetrics metrics;
+        if (tuned) {
+            metrics.push_back(std::make_pair(std::string("MR"), double(blocking.MR)));
+            metrics.push_back(std::make_pair(std::string("NR"), double(blocking.NR_VECS * FLOAT_VEC_TYPE::length())));
+            metrics.push_back(std::make_pair(std::string("KC"), double(blocking.KC)));
+            metrics.push_back(std::make_pair(std::string("MC"), double(blocking.MC)));
+            metrics.push_back(std::make_pair(std::string("NC"), double(blocking.NC)));
+            metrics.push_back(std::make_pair(std::string("blocking_cached"), from_cache ? 1.0 : 0.0));
+        }
+        return metrics;
+    }
+};
+
+#endif
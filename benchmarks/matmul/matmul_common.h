@@ -32,53 +32,126 @@
 #define MATMUL_COMMON_H_
 
 //#define UME_SIMD_SHOW_EMULATION_WARNINGS 1
-#include "../../UMESimd.h"
-#include "../utilities/TimingStatistics.h"
+#include <umesimd/UMESimd.h>
 
+#include <cmath>
+#include <time.h>
+#include <stdlib.h>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+// Rows of padded arrays are rounded up to a multiple of SIMD stride, so that
+// every row starts at the optimal alignment and dot products need no remainder loop.
+inline int padded_row_length(int rank, int simd_stride) {
+    return ((rank + simd_stride - 1) / simd_stride) * simd_stride;
+}
+
+// Transpose row-major 'rank x rank' matrix B into B_T with row stride 'ld'.
+// Padding columns of B_T are zeroed.
 template<typename FLOAT_T>
-struct RESULTS {
-    TIMING_RES elapsed;
-    FLOAT_T    RMS_error;
-};
+UME_FORCE_INLINE void transpose_padded(int rank, int ld, FLOAT_T const *B, FLOAT_T *B_T) {
+    for (int i = 0; i < rank; i++) {
+        for (int j = 0; j < rank; j++) {
+            B_T[i*ld + j] = B[j*rank + i];
+        }
+        for (int j = rank; j < ld; j++) {
+            B_T[i*ld + j] = FLOAT_T(0);
+        }
+    }
+}
 
-// For non-padded array representations
-template<typename FLOAT_T, int MAT_RANK>
-UME_NEVER_INLINE FLOAT_T calculate_RMS_error_scalar(FLOAT_T* A, FLOAT_T* B, FLOAT_T* C) {
-    FLOAT_T error = FLOAT_T(0);
-    FLOAT_T C_ij;
-    for (int i = 0; i < MAT_RANK; i++) {
+// RMS error of C with respect to A * B. A has row stride 'lda', B and C are not
+// padded. Reference is accumulated in double precision.
+template<typename FLOAT_T>
+UME_NEVER_INLINE double calculate_RMS_error(int rank, FLOAT_T const *A, int lda, FLOAT_T const *B, FLOAT_T const *C) {
+    double error = 0.0;
+    for (int i = 0; i < rank; i++) {
         // For each element in a row of C
-        for (int j = 0; j < MAT_RANK; j++) {
-            C_ij = 0;
-            for (int k = 0; k < MAT_RANK; k++) {
-                C_ij += A[i*MAT_RANK + k] * B[k*MAT_RANK + j];
+        for (int j = 0; j < rank; j++) {
+            double C_ij = 0.0;
+            for (int k = 0; k < rank; k++) {
+                C_ij += double(A[i*lda + k]) * double(B[k*rank + j]);
             }
-            error += (C[i*MAT_RANK + j] - C_ij)*(C[i*MAT_RANK + j] - C_ij);
+            error += (double(C[i*rank + j]) - C_ij)*(double(C[i*rank + j]) - C_ij);
         }
     }
-    return std::sqrt(error / (FLOAT_T(MAT_RANK)*FLOAT_T(MAT_RANK)));
+    return std::sqrt(error / (double(rank)*double(rank)));
 }
 
-// Take padding into consideration
-template<typename FLOAT_T, int MAT_RANK, int SIMD_STRIDE>
-UME_NEVER_INLINE FLOAT_T calculate_RMS_error_SIMD(FLOAT_T* A, FLOAT_T* B, FLOAT_T* C) {
-    FLOAT_T error = FLOAT_T(0);
-    FLOAT_T C_ij;
+// C = A * B for square row-major matrices of rank 'rank'. Rows of A are padded
+// to 'lda' elements (padding is zeroed), B and C are not padded. Error reported
+// by 'verify' is the RMS error of C.
+template<typename FLOAT_T>
+class MatmulTest : public Test {
+protected:
+    FLOAT_T *A, *B, *C;
 
-    int PADDING = SIMD_STRIDE - (MAT_RANK % SIMD_STRIDE);
+    int rank;
+    int lda;
+    int alignment;
 
-    for (int i = 0; i < MAT_RANK; i++) {
-        // For each element in a row of C
-        for (int j = 0; j < MAT_RANK; j++) {
-            C_ij = 0;
-            for (int k = 0; k < MAT_RANK; k++) {
-                C_ij += A[i*(MAT_RANK + PADDING) + k] * B[k*MAT_RANK + j];
+public:
+    MatmulTest(int rank, int lda, int alignment) :
+        Test(true), A(nullptr), B(nullptr), C(nullptr), rank(rank), lda(lda), alignment(alignment) {}
+
+    MatmulTest(int rank) : MatmulTest(rank, rank, sizeof(FLOAT_T)) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(rank*lda*sizeof(FLOAT_T), alignment);
+        B = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(rank*rank*sizeof(FLOAT_T), alignment);
+        C = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(rank*rank*sizeof(FLOAT_T), alignment);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data
+        for (int i = 0; i < rank; i++) {
+            for (int j = 0; j < rank; j++) {
+                // Generate random numbers in range (0.0;1.0)
+                A[i*lda + j] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+                B[i*rank + j] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+                C[i*rank + j] = FLOAT_T(0);
+            }
+            for (int j = rank; j < lda; j++) {
+                A[i*lda + j] = FLOAT_T(0);
             }
-            error += (C[i*(MAT_RANK)+j] - C_ij)*(C[i*(MAT_RANK)+j] - C_ij);
         }
     }
-    return std::sqrt(error / (FLOAT_T(MAT_RANK)*FLOAT_T(MAT_RANK)));
-}
 
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(A);
+        UME::DynamicMemory::AlignedFree(B);
+        UME::DynamicMemory::AlignedFree(C);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        error_norm_bignum = calculate_RMS_error<FLOAT_T>(rank, A, lda, B, C);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+// Dot product kernels read B transposed. The transposition is a part of the
+// algorithm, so it is done in the measured code, into a padded B_T buffer.
+template<typename FLOAT_T>
+class MatmulTransposedTest : public MatmulTest<FLOAT_T> {
+protected:
+    FLOAT_T *B_T;
+
+public:
+    MatmulTransposedTest(int rank, int simd_stride, int alignment) :
+        MatmulTest<FLOAT_T>(rank, padded_row_length(rank, simd_stride), alignment), B_T(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulTest<FLOAT_T>::initialize();
+        B_T = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(this->rank*this->lda*sizeof(FLOAT_T), this->alignment);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(B_T);
+        MatmulTest<FLOAT_T>::cleanup();
+    }
+};
 
 #endif
@@ -31,82 +31,281 @@
 #ifndef MATMUL_FOX_H_
 #define MATMUL_FOX_H_
 
+#include <algorithm>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include "matmul_common.h"
-#include "matmul_naive.h"
+#include "matmul_blocked.h"
+#include "../utilities/UMEThreadPinning.h"
 
-// Use Fox's algorithm
-template<typename FLOAT_T, int MAT_RANK>
-RESULTS<FLOAT_T> test_scalar_fox()
+// Fox's algorithm. Serial version, with single elements as blocks: only the
+// order of stages is preserved. See 'ParallelFoxMatmul' for the parallel version.
+//
+// C += A * B for square row-major matrices of rank N
+template<typename FLOAT_T>
+UME_FORCE_INLINE void fox_matmul(int N, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T *C)
 {
-    unsigned long long start, end; // Time measurements
-    FLOAT_T *A, *B, *C;
+    // For each stage
+    for (int k = 0; k < N; k++) {
+        // For each row in C
+        for (int i = 0; i < N; i++) {
+            // For each column in C
+            for (int j = 0; j < N; j++) {
+                int k_mod = (i + k) % N;
+                C[i*N + j] += A[i*N + k_mod] * B[k_mod*N + j];
+            }
+        }
+    }
+}
 
-    // Allocate alligned to a single scalar
-    A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
-    B = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
-    C = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
+template<typename FLOAT_T>
+class ScalarFoxTest : public MatmulTest<FLOAT_T> {
+public:
+    ScalarFoxTest(int rank) : MatmulTest<FLOAT_T>(rank) {}
 
-    srand((unsigned int)time(NULL));
-    // Initialize arrays with random data
-    for (int i = 0; i < MAT_RANK*MAT_RANK; i++)
-    {
-        // Generate random numbers in range (0.0;1.0)
-        A[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
-        B[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
-        C[i] = FLOAT_T(0);
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        fox_matmul<FLOAT_T>(this->rank, this->A, this->B, this->C);
     }
-    /*
-    std::cout << "A: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << A[i*MAT_RANK + j] << " ";
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar Fox, " + ScalarToString<FLOAT_T>::value() +
+            " " + std::to_string(this->rank);
+        return retval;
     }
-    std::cout << std::endl;
+};
+
+// Fox's algorithm on a 'q x q' grid of threads. Matrices are split into 'q x q'
+// blocks and the thread at grid position (i, j) owns blocks A_ij, B_ij and C_ij,
+// as a process of a distributed memory machine would. In stage 'k':
+//
+//  - the thread at (i, (i + k) mod q) broadcasts its block of A along grid row 'i':
+//    every thread of the row copies it into its own receive buffer,
+//  - every thread updates C_ij += A_i,(i+k) * B_(i+k),j with the SIMD blocked kernel,
+//  - blocks of B are shifted one grid row up: each thread copies its block of B into
+//    the receive buffer of the thread above it.
+//
+// Blocks of B are double buffered by stage parity, so that a single barrier per stage
+// separates the shift from the next update. Distribution of A and B to the owners
+// ('scatter') and collection of C ('gather') are not part of the algorithm.
+//
+// Threads come from the OpenMP runtime. They are not pinned by this class, see
+// 'ThreadPinning'. Without OpenMP a single thread executes the steps of all grid
+// positions in turn.
+template<typename FLOAT_VEC_TYPE>
+class ParallelFoxMatmul {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    int rank;
+    int q;              // Grid rank, q*q blocks
+    int block;          // Block rank, blocks on the edge of the matrix are zero-padded
+    int threadCount;
+    MatmulBlocking blocking;
+
+    // Buffers of grid position 'i*q + j'
+    std::vector<FLOAT_T *> A_own, A_recv, B_buf[2], C_own, packedA, packedB;
+
+    static UME_FORCE_INLINE void barrier() {
+#if defined(_OPENMP)
+        #pragma omp barrier
+#endif
     }
 
-    std::cout << "\n\nB: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << B[i*MAT_RANK + j] << " ";
+    static UME_FORCE_INLINE void copy_block(int count, FLOAT_T const *src, FLOAT_T *dst) {
+        const int SIMD_STRIDE = FLOAT_VEC_TYPE::length();
+        int LOOP_PEEL_OFFSET = (count / SIMD_STRIDE) * SIMD_STRIDE;
+        FLOAT_VEC_TYPE t0;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += SIMD_STRIDE) {
+            t0.load(&src[i]);
+            t0.store(&dst[i]);
+        }
+        for (int i = LOOP_PEEL_OFFSET; i < count; i++) dst[i] = src[i];
     }
-    std::cout << std::endl;
+
+    // Grid positions 'first, first + step, ...' are handled by the calling thread.
+    void fox_stages(int first, int step) {
+        int count = block * block;
+
+        for (int k = 0; k < q; k++) {
+            int current = k % 2;
+            int next = (k + 1) % 2;
+
+            for (int p = first; p < q * q; p += step) {
+                int i = p / q;
+                int root = i * q + (i + k) % q;
+
+                // Broadcast of A along the grid row
+                copy_block(count, A_own[root], A_recv[p]);
+
+                blocked_gemm<FLOAT_VEC_TYPE>(block, block, block, blocking,
+                    A_recv[p], block, B_buf[current][p], block, C_own[p], block,
+                    packedA[p], packedB[p], k > 0);
+            }
+
+            if (k == q - 1) break;
+
+            for (int p = first; p < q * q; p += step) {
+                int i = p / q;
+                int j = p % q;
+                int up = ((i + q - 1) % q) * q + j;
+
+                // Shift of B one grid row up
+                copy_block(count, B_buf[current][p], B_buf[next][up]);
+            }
+            barrier();
+        }
     }
-    */
-    start = get_timestamp();
 
-    // For each stage
-    for (int k = 0; k < MAT_RANK; k++) {
-        // For each row in C
-        for (int i = 0; i < MAT_RANK; i++) {
-            // For each column in C
-            for (int j = 0; j < MAT_RANK; j++) {
-                int k_mod = (i + k) % MAT_RANK;
-                C[i*MAT_RANK + j] += A[i*MAT_RANK + k_mod] * B[k_mod*MAT_RANK + j];
+public:
+    ParallelFoxMatmul(int rank, int q, MatmulBlocking const & blocking) :
+        rank(rank), q(q), blocking(blocking)
+    {
+        block = (rank + q - 1) / q;
+        threadCount = threads_for_grid(q);
+        uint32_t ALIGNMENT = FLOAT_VEC_TYPE::alignment();
+        for (int p = 0; p < q * q; p++) {
+            A_own.push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(block*block*sizeof(FLOAT_T), ALIGNMENT));
+            A_recv.push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(block*block*sizeof(FLOAT_T), ALIGNMENT));
+            B_buf[0].push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(block*block*sizeof(FLOAT_T), ALIGNMENT));
+            B_buf[1].push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(block*block*sizeof(FLOAT_T), ALIGNMENT));
+            C_own.push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(block*block*sizeof(FLOAT_T), ALIGNMENT));
+            packedA.push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_A_size(blocking)*sizeof(FLOAT_T), ALIGNMENT));
+            packedB.push_back((FLOAT_T *)UME::DynamicMemory::AlignedMalloc(blocked_packed_B_size(blocking)*sizeof(FLOAT_T), ALIGNMENT));
+        }
+    }
+
+    ~ParallelFoxMatmul() {
+        for (int p = 0; p < q * q; p++) {
+            UME::DynamicMemory::AlignedFree(A_own[p]);
+            UME::DynamicMemory::AlignedFree(A_recv[p]);
+            UME::DynamicMemory::AlignedFree(B_buf[0][p]);
+            UME::DynamicMemory::AlignedFree(B_buf[1][p]);
+            UME::DynamicMemory::AlignedFree(C_own[p]);
+            UME::DynamicMemory::AlignedFree(packedA[p]);
+            UME::DynamicMemory::AlignedFree(packedB[p]);
+        }
+    }
+
+    // Number of threads used for a 'q x q' grid
+    static int threads_for_grid(int q) {
+#if defined(_OPENMP)
+        return q * q;
+#else
+        (void)q;
+        return 1;
+#endif
+    }
+
+    int thread_count() const { return threadCount; }
+
+    // Distribute blocks of row-major A and B to their owners
+    void scatter(FLOAT_T const *A, FLOAT_T const *B) {
+        for (int p = 0; p < q * q; p++) {
+            int row0 = (p / q) * block;
+            int col0 = (p % q) * block;
+            for (int r = 0; r < block; r++) {
+                for (int c = 0; c < block; c++) {
+                    bool valid = row0 + r < rank && col0 + c < rank;
+                    A_own[p][r*block + c] = valid ? A[(row0 + r)*rank + col0 + c] : FLOAT_T(0);
+                    B_buf[0][p][r*block + c] = valid ? B[(row0 + r)*rank + col0 + c] : FLOAT_T(0);
+                }
             }
         }
     }
 
-    end = get_timestamp();
-    /*
-    std::cout << "\n\nC: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << C[i*MAT_RANK + j] << " ";
+    // Collect blocks of C into a row-major matrix
+    void gather(FLOAT_T *C) {
+        for (int p = 0; p < q * q; p++) {
+            int row0 = (p / q) * block;
+            int col0 = (p % q) * block;
+            for (int r = 0; r < block && row0 + r < rank; r++) {
+                for (int c = 0; c < block && col0 + c < rank; c++) {
+                    C[(row0 + r)*rank + col0 + c] = C_own[p][r*block + c];
+                }
+            }
+        }
     }
-    std::cout << std::endl;
-    }*/
-    FLOAT_T error = calculate_RMS_error_scalar<FLOAT_T, MAT_RANK>(A, B, C);
-    //std::cout << "scalar Fox RMS error: " << error << std::endl;
 
-    UME::DynamicMemory::AlignedFree(A);
-    UME::DynamicMemory::AlignedFree(B);
-    UME::DynamicMemory::AlignedFree(C);
+    void multiply() {
+        if (threadCount == 1) {
+            fox_stages(0, 1);
+            return;
+        }
+#if defined(_OPENMP)
+        #pragma omp parallel num_threads(threadCount)
+        {
+            // The runtime may provide fewer threads than requested, in which case
+            // threads take more than one grid position.
+            fox_stages(omp_get_thread_num(), omp_get_num_threads());
+        }
+#endif
+    }
+};
 
-    RESULTS<FLOAT_T> retval;
-    retval.elapsed = end - start;
-    retval.RMS_error = error;
+// Threads are pinned once in 'test_init' and released in 'test_cleanup'. Thread
+// grid, its buffers and blocking parameters are set up in 'initialize'.
+// Distribution of A and B to the grid happens in 'optional_init' and collection
+// of C in 'optional_cleanup', so only the stages of the algorithm are measured.
+template<typename FLOAT_VEC_TYPE>
+class UMESimdFoxTest : public MatmulTest<typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T> {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
 
-    return retval;
-}
+    ParallelFoxMatmul<FLOAT_VEC_TYPE> *fox;
+    ThreadPinning *pinning;
+    int grid_rank;
+
+public:
+    UMESimdFoxTest(int rank, int grid_rank) :
+        MatmulTest<FLOAT_T>(rank, rank, FLOAT_VEC_TYPE::alignment()),
+        fox(nullptr), pinning(nullptr), grid_rank(grid_rank) {}
+
+    UME_NEVER_INLINE virtual void test_init() {
+        pinning = new ThreadPinning(ParallelFoxMatmul<FLOAT_VEC_TYPE>::threads_for_grid(grid_rank));
+    }
+
+    UME_NEVER_INLINE virtual void test_cleanup() {
+        delete pinning;
+        pinning = nullptr;
+    }
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulTest<FLOAT_T>::initialize();
+        bool from_cache;
+        MatmulBlocking blocking = MatmulAutotuner<FLOAT_VEC_TYPE>::get(from_cache);
+        fox = new ParallelFoxMatmul<FLOAT_VEC_TYPE>(this->rank, grid_rank, blocking);
+    }
+
+    UME_NEVER_INLINE virtual void optional_init() {
+        fox->scatter(this->A, this->B);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        fox->multiply();
+    }
+
+    UME_NEVER_INLINE virtual void optional_cleanup() {
+        fox->gather(this->C);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete fox;
+        fox = nullptr;
+        MatmulTest<FLOAT_T>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD parallel Fox, " + ScalarToString<FLOAT_T>::value() +
+            " " + std::to_string(this->rank) +
+            ", stride " + std::to_string(FLOAT_VEC_TYPE::length()) +
+            " (grid: " + std::to_string(grid_rank) + "x" + std::to_string(grid_rank) +
+            ", threads: " + std::to_string(ParallelFoxMatmul<FLOAT_VEC_TYPE>::threads_for_grid(grid_rank)) + ")";
+        return retval;
+    }
+};
 
 #endif
@@ -31,75 +31,37 @@
 #ifndef MATMUL_NAIVE_H_
 #define MATMUL_NAIVE_H_
 
-template<typename FLOAT_T, int MAT_RANK>
-RESULTS<FLOAT_T> test_scalar_naive()
-{
-    unsigned long long start, end; // Time measurements
-    FLOAT_T *A, *B, *C;
-
-    // Allocate alligned to a single scalar
-    A = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
-    B = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
-    C = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(MAT_RANK*MAT_RANK*sizeof(FLOAT_T), sizeof(FLOAT_T));
-
-    srand((unsigned int)time(NULL));
-    // Initialize arrays with random data
-    for (int i = 0; i < MAT_RANK*MAT_RANK; i++)
-    {
-        // Generate random numbers in range (0.0;1.0)
-        A[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
-        B[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
-        C[i] = FLOAT_T(0);
-    }
-    /*
-    std::cout << "A: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << A[i*MAT_RANK + j] << " ";
-    }
-    std::cout << std::endl;
-    }
-
-    std::cout << "\n\nB: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << B[i*MAT_RANK + j] << " ";
-    }
-    std::cout << std::endl;
-    }*/
+#include "matmul_common.h"
 
-    start = get_timestamp();
+// C += A * B for square row-major matrices of rank N
+template<typename FLOAT_T>
+UME_FORCE_INLINE void naive_matmul(int N, FLOAT_T const *A, FLOAT_T const *B, FLOAT_T *C)
+{
     // For each row in C
-    for (int i = 0; i < MAT_RANK; i++) {
+    for (int i = 0; i < N; i++) {
         // For each element in a row of C
-        for (int j = 0; j < MAT_RANK; j++) {
-            for (int k = 0; k < MAT_RANK; k++) {
-                C[i*MAT_RANK + j] += A[i*MAT_RANK + k] * B[k*MAT_RANK + j];
+        for (int j = 0; j < N; j++) {
+            for (int k = 0; k < N; k++) {
+                C[i*N + j] += A[i*N + k] * B[k*N + j];
             }
         }
     }
-    end = get_timestamp();
-    /*
-    std::cout << "\n\nC: \n";
-    for (int i = 0; i < MAT_RANK; i++) {
-    for (int j = 0; j < MAT_RANK; j++) {
-    std::cout << C[i*MAT_RANK + j] << " ";
-    }
-    std::cout << std::endl;
-    }*/
-
-    FLOAT_T error = calculate_RMS_error_scalar<FLOAT_T, MAT_RANK>(A, B, C);
-    //std::cout << "scalar RMS error: " << error << std::endl;
+}
 
-    UME::DynamicMemory::AlignedFree(A);
-    UME::DynamicMemory::AlignedFree(B);
-    UME::DynamicMemory::AlignedFree(C);
+template<typename FLOAT_T>
+class ScalarNaiveTest : public MatmulTest<FLOAT_T> {
+public:
+    ScalarNaiveTest(int rank) : MatmulTest<FLOAT_T>(rank) {}
 
-    RESULTS<FLOAT_T> retval;
-    retval.elapsed = end - start;
-    retval.RMS_error = error;
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        naive_matmul<FLOAT_T>(this->rank, this->A, this->B, this->C);
+    }
 
-    return retval;
-}
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "Scalar naive, " + ScalarToString<FLOAT_T>::value() +
+            " " + std::to_string(this->rank);
+        return retval;
+    }
+};
 
 #endif
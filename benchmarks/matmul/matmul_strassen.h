@@ -0,0 +1,263 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+
+#ifndef MATMUL_STRASSEN_H_
+#define MATMUL_STRASSEN_H_
+
+#include <vector>
+
+#include "matmul_common.h"
+#include "matmul_blocked.h"
+
+// Strassen-Winograd matrix multiplication (7 multiplications and 15 additions per
+// recursion level). Quadrant products are computed recursively until the quadrant
+// rank drops to 'cutoff' or below; leaves use the cache-blocked SIMD kernel.
+//
+// Products are scheduled so that every recursion level needs only two temporaries,
+// one for a combination of A quadrants and one for a combination of B quadrants,
+// with the quadrants of C used as the remaining scratch space (Boyer, Dumas, Pernet,
+// Zhou, "Memory efficient scheduling of Strassen-Winograd's matrix multiplication
+// algorithm", 2009). All temporaries, leaf packing buffers and, for ranks not
+// divisible by 2^levels, zero-padded copies of the operands are taken from a single
+// arena allocated when the object is created, so the multiplication itself does not
+// allocate.
+template<typename FLOAT_VEC_TYPE>
+class StrassenWinogradMatmul {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    int rank;
+    int levels;
+    int padded_rank;
+    MatmulBlocking blocking;
+
+    FLOAT_T *arena;
+    size_t arena_size;
+    std::vector<FLOAT_T *> X, Y;
+    FLOAT_T *packedA, *packedB;
+    FLOAT_T *paddedA, *paddedB, *paddedC;
+
+    // Keep every buffer of the arena aligned to 64 bytes
+    static size_t aligned_count(size_t count) {
+        const size_t ALIGN_ELEMENTS = 64 / sizeof(FLOAT_T);
+        return ((count + ALIGN_ELEMENTS - 1) / ALIGN_ELEMENTS) * ALIGN_ELEMENTS;
+    }
+
+    // Z = X + Y for 'n x n' blocks
+    static UME_FORCE_INLINE void add(int n, FLOAT_T const *x, int ldx, FLOAT_T const *y, int ldy, FLOAT_T *z, int ldz) {
+        const int SIMD_STRIDE = FLOAT_VEC_TYPE::length();
+        int LOOP_PEEL_OFFSET = (n / SIMD_STRIDE) * SIMD_STRIDE;
+        for (int i = 0; i < n; i++) {
+            FLOAT_VEC_TYPE t0, t1;
+            for (int j = 0; j < LOOP_PEEL_OFFSET; j += SIMD_STRIDE) {
+                t0.load(&x[i*ldx + j]);
+                t1.load(&y[i*ldy + j]);
+                (t0 + t1).store(&z[i*ldz + j]);
+            }
+            for (int j = LOOP_PEEL_OFFSET; j < n; j++) z[i*ldz + j] = x[i*ldx + j] + y[i*ldy + j];
+        }
+    }
+
+    // Z = X - Y for 'n x n' blocks
+    static UME_FORCE_INLINE void sub(int n, FLOAT_T const *x, int ldx, FLOAT_T const *y, int ldy, FLOAT_T *z, int ldz) {
+        const int SIMD_STRIDE = FLOAT_VEC_TYPE::length();
+        int LOOP_PEEL_OFFSET = (n / SIMD_STRIDE) * SIMD_STRIDE;
+        for (int i = 0; i < n; i++) {
+            FLOAT_VEC_TYPE t0, t1;
+            for (int j = 0; j < LOOP_PEEL_OFFSET; j += SIMD_STRIDE) {
+                t0.load(&x[i*ldx + j]);
+                t1.load(&y[i*ldy + j]);
+                (t0 - t1).store(&z[i*ldz + j]);
+            }
+            for (int j = LOOP_PEEL_OFFSET; j < n; j++) z[i*ldz + j] = x[i*ldx + j] - y[i*ldy + j];
+        }
+    }
+
+    static void copy_padded(int n, int ld_src, FLOAT_T const *src, int ld_dst, FLOAT_T *dst) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) dst[i*ld_dst + j] = src[i*ld_src + j];
+        }
+    }
+
+    // C = A * B for 'n x n' blocks
+    void multiply(int level, int n, FLOAT_T const *A, int lda, FLOAT_T const *B, int ldb, FLOAT_T *C, int ldc) {
+        if (level == levels) {
+            blocked_gemm<FLOAT_VEC_TYPE>(n, n, n, blocking, A, lda, B, ldb, C, ldc, packedA, packedB);
+            return;
+        }
+
+        int h = n / 2;
+        FLOAT_T const *A11 = A, *A12 = A + h, *A21 = A + h*lda, *A22 = A + h*lda + h;
+        FLOAT_T const *B11 = B, *B12 = B + h, *B21 = B + h*ldb, *B22 = B + h*ldb + h;
+        FLOAT_T *C11 = C, *C12 = C + h, *C21 = C + h*ldc, *C22 = C + h*ldc + h;
+        FLOAT_T *x = X[level], *y = Y[level];
+
+        sub(h, A11, lda, A21, lda, x, h);                   // S3 = A11 - A21
+        sub(h, B22, ldb, B12, ldb, y, h);                   // T3 = B22 - B12
+        multiply(level + 1, h, x, h, y, h, C21, ldc);       // P7 = S3 * T3
+        add(h, A21, lda, A22, lda, x, h);                   // S1 = A21 + A22
+        sub(h, B12, ldb, B11, ldb, y, h);                   // T1 = B12 - B11
+        multiply(level + 1, h, x, h, y, h, C22, ldc);       // P5 = S1 * T1
+        sub(h, x, h, A11, lda, x, h);                       // S2 = S1 - A11
+        sub(h, B22, ldb, y, h, y, h);                       // T2 = B22 - T1
+        multiply(level + 1, h, x, h, y, h, C12, ldc);       // P6 = S2 * T2
+        sub(h, A12, lda, x, h, x, h);                       // S4 = A12 - S2
+        multiply(level + 1, h, x, h, B22, ldb, C11, ldc);   // P3 = S4 * B22
+        multiply(level + 1, h, A11, lda, B11, ldb, x, h);   // P1 = A11 * B11
+        add(h, x, h, C12, ldc, C12, ldc);                   // U2 = P1 + P6
+        add(h, C12, ldc, C21, ldc, C21, ldc);               // U3 = U2 + P7
+        add(h, C12, ldc, C22, ldc, C12, ldc);               // U4 = U2 + P5
+        add(h, C21, ldc, C22, ldc, C22, ldc);               // C22 = U7 = U3 + P5
+        add(h, C12, ldc, C11, ldc, C12, ldc);               // C12 = U5 = U4 + P3
+        sub(h, y, h, B21, ldb, y, h);                       // T4 = T2 - B21
+        multiply(level + 1, h, A22, lda, y, h, C11, ldc);   // P4 = A22 * T4
+        sub(h, C21, ldc, C11, ldc, C21, ldc);               // C21 = U6 = U3 - P4
+        multiply(level + 1, h, A12, lda, B21, ldb, C11, ldc); // P2 = A12 * B21
+        add(h, x, h, C11, ldc, C11, ldc);                   // C11 = U1 = P1 + P2
+    }
+
+public:
+    StrassenWinogradMatmul(int rank, int cutoff, MatmulBlocking const & blocking) :
+        rank(rank), blocking(blocking)
+    {
+        levels = recursion_levels(rank, cutoff);
+        padded_rank = ((rank + (1 << levels) - 1) >> levels) << levels;
+
+        arena_size = 0;
+        for (int l = 0; l < levels; l++) {
+            size_t half = size_t(padded_rank >> (l + 1));
+            arena_size += 2 * aligned_count(half * half);
+        }
+        arena_size += aligned_count(blocked_packed_A_size(blocking));
+        arena_size += aligned_count(blocked_packed_B_size(blocking));
+        if (padded_rank != rank) {
+            arena_size += 3 * aligned_count(size_t(padded_rank) * padded_rank);
+        }
+
+        arena = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(arena_size * sizeof(FLOAT_T), 64);
+
+        FLOAT_T *next = arena;
+        for (int l = 0; l < levels; l++) {
+            size_t half = size_t(padded_rank >> (l + 1));
+            X.push_back(next);
+            next += aligned_count(half * half);
+            Y.push_back(next);
+            next += aligned_count(half * half);
+        }
+        packedA = next;
+        next += aligned_count(blocked_packed_A_size(blocking));
+        packedB = next;
+        next += aligned_count(blocked_packed_B_size(blocking));
+        paddedA = paddedB = paddedC = nullptr;
+        if (padded_rank != rank) {
+            size_t padded_size = aligned_count(size_t(padded_rank) * padded_rank);
+            paddedA = next;
+            paddedB = next + padded_size;
+            paddedC = next + 2 * padded_size;
+            for (size_t i = 0; i < 3 * padded_size; i++) next[i] = FLOAT_T(0);
+        }
+    }
+
+    ~StrassenWinogradMatmul() {
+        UME::DynamicMemory::AlignedFree(arena);
+    }
+
+    // C = A * B for square row-major matrices of rank 'rank'
+    void matmul(FLOAT_T const *A, FLOAT_T const *B, FLOAT_T *C) {
+        if (padded_rank == rank) {
+            multiply(0, rank, A, rank, B, rank, C, rank);
+        }
+        else {
+            // Padding rows and columns stay zero, only the valid part is copied.
+            copy_padded(rank, rank, A, padded_rank, paddedA);
+            copy_padded(rank, rank, B, padded_rank, paddedB);
+            multiply(0, padded_rank, paddedA, padded_rank, paddedB, padded_rank, paddedC, padded_rank);
+            copy_padded(rank, padded_rank, paddedC, rank, C);
+        }
+    }
+
+    // Number of halvings until the quadrant rank drops to 'cutoff' or below
+    static int recursion_levels(int rank, int cutoff) {
+        int retval = 0;
+        int leaf_rank = rank;
+        while (leaf_rank > cutoff && leaf_rank > 1) {
+            leaf_rank = (leaf_rank + 1) / 2;
+            retval++;
+        }
+        return retval;
+    }
+
+    int recursion_levels() const { return levels; }
+    size_t workspace_bytes() const { return arena_size * sizeof(FLOAT_T); }
+};
+
+// The workspace is allocated in 'initialize', outside of the measured code.
+template<typename FLOAT_VEC_TYPE>
+class UMESimdStrassenTest : public MatmulTest<typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T> {
+private:
+    typedef typename UME::SIMD::SIMDTraits<FLOAT_VEC_TYPE>::SCALAR_T FLOAT_T;
+
+    StrassenWinogradMatmul<FLOAT_VEC_TYPE> *strassen;
+    int cutoff;
+
+public:
+    UMESimdStrassenTest(int rank, int cutoff) :
+        MatmulTest<FLOAT_T>(rank, rank, FLOAT_VEC_TYPE::alignment()),
+        strassen(nullptr), cutoff(cutoff) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        MatmulTest<FLOAT_T>::initialize();
+        bool from_cache;
+        MatmulBlocking blocking = MatmulAutotuner<FLOAT_VEC_TYPE>::get(from_cache);
+        strassen = new StrassenWinogradMatmul<FLOAT_VEC_TYPE>(this->rank, cutoff, blocking);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        strassen->matmul(this->A, this->B, this->C);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete strassen;
+        strassen = nullptr;
+        MatmulTest<FLOAT_T>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "UME::SIMD Strassen-Winograd, " + ScalarToString<FLOAT_T>::value() +
+            " " + std::to_string(this->rank) +
+            ", stride " + std::to_string(FLOAT_VEC_TYPE::length()) +
+            " (cutoff: " + std::to_string(cutoff) +
+            ", levels: " + std::to_string(StrassenWinogradMatmul<FLOAT_VEC_TYPE>::recursion_levels(this->rank, cutoff)) + ")";
+        return retval;
+    }
+};
+
+#endif
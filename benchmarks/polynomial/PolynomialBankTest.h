@@ -0,0 +1,199 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#pragma once
+
+#include <cmath>
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+#include "../utilities/UMESimdPolynomial.h"
+
+// Evaluation of 'channels' different polynomials of DEGREE, one per channel. The
+// argument is either shared by all channels, or given per channel ('per_channel_x').
+// Coefficients are generated per channel ('array of structures'), as they would
+// come from a calibration.
+template<typename FLOAT_T, int DEGREE>
+class PolynomialBankTest : public Test {
+protected:
+    int channels;
+    bool per_channel_x;
+
+    FLOAT_T *a;     // a[channel * (DEGREE + 1) + k]
+    FLOAT_T *x;
+    FLOAT_T *y;
+
+public:
+    PolynomialBankTest(int channels, bool per_channel_x) :
+        Test(true), channels(channels), per_channel_x(per_channel_x) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        a = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(channels * (DEGREE + 1) * sizeof(FLOAT_T), 64);
+        x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(channels * sizeof(FLOAT_T), 64);
+        y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(channels * sizeof(FLOAT_T), 64);
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data. Only x[0] is used for a shared argument.
+        for (int i = 0; i < channels; i++)
+        {
+            // Generate random numbers in range (0.0;1.0)
+            x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+            y[i] = FLOAT_T(0.0f);
+        }
+
+        for (int i = 0; i < channels * (DEGREE + 1); i++)
+        {
+            // Generate random coefficients in range (0.0; 1.0)
+            a[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(a);
+        UME::DynamicMemory::AlignedFree(y);
+        UME::DynamicMemory::AlignedFree(x);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        long double max_err = 0;
+
+        for (int c = 0; c < channels; c++) {
+            FLOAT_T arg = per_channel_x ? x[c] : x[0];
+            long double expected = a[c * (DEGREE + 1) + DEGREE];
+            for (int k = DEGREE - 1; k >= 0; k--) {
+                expected = expected * arg + a[c * (DEGREE + 1) + k];
+            }
+            // All coefficients and arguments are positive, so 'expected' > 0
+            long double diff = std::fabs(y[c] - expected) / expected;
+            max_err = max_err > diff ? max_err : diff;
+        }
+
+        error_norm_bignum = double(max_err);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+
+    std::string argument_name() {
+        return per_channel_x ? "x per channel" : "shared x";
+    }
+};
+
+// Loop over channels, evaluating each polynomial with Horner's scheme
+template<typename FLOAT_T, int DEGREE>
+class ScalarBankTest : public PolynomialBankTest<FLOAT_T, DEGREE> {
+public:
+    ScalarBankTest(int channels, bool per_channel_x) : PolynomialBankTest<FLOAT_T, DEGREE>(channels, per_channel_x) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int c = 0; c < this->channels; c++) {
+            FLOAT_T const *coeffs = &this->a[c * (DEGREE + 1)];
+            FLOAT_T arg = this->per_channel_x ? this->x[c] : this->x[0];
+            FLOAT_T acc = coeffs[DEGREE];
+            for (int k = DEGREE - 1; k >= 0; k--) {
+                acc = acc * arg + coeffs[k];
+            }
+            this->y[c] = acc;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+
+        retval += "Scalar per channel, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->channels) +
+            ", degree " + std::to_string(DEGREE) +
+            ", " + this->argument_name();
+
+        return retval;
+    }
+};
+
+// Polynomial per SIMD lane. Transposition of coefficients happens in 'initialize'
+// and is not measured: it is done once, when the calibration is loaded.
+template<typename FLOAT_T, int STRIDE, int DEGREE, int SCHEME>
+class UMESimdBankTest : public PolynomialBankTest<FLOAT_T, DEGREE> {
+private:
+    typedef UMESimdPolynomialBank<FLOAT_T, STRIDE, DEGREE, SCHEME> BANK_T;
+
+    BANK_T *bank;
+
+public:
+    UMESimdBankTest(int channels, bool per_channel_x) :
+        PolynomialBankTest<FLOAT_T, DEGREE>(channels, per_channel_x), bank(nullptr) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        PolynomialBankTest<FLOAT_T, DEGREE>::initialize();
+        bank = new BANK_T(this->channels, this->a);
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        if (this->per_channel_x) bank->evaluate(this->x, this->y);
+        else bank->evaluate(this->x[0], this->y);
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        delete bank;
+        bank = nullptr;
+        PolynomialBankTest<FLOAT_T, DEGREE>::cleanup();
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+
+        retval += "UME::SIMD lane per channel " + std::string(BANK_T::scheme_name()) + ", " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(STRIDE) + ", " +
+            std::to_string(this->channels) +
+            ", degree " + std::to_string(DEGREE) +
+            ", " + this->argument_name();
+
+        return retval;
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int DEGREE>
+void registerPolynomialBankCategory(BenchmarkHarness & harness, int channels, bool per_channel_x) {
+    TestCategory *newCategory = new TestCategory(std::string("polynomial_bank"));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("degree"), DEGREE));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), channels));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("per_channel_x"), per_channel_x ? 1 : 0));
+
+    newCategory->registerTest(new ScalarBankTest<FLOAT_T, DEGREE>(channels, per_channel_x));
+    newCategory->registerTest(new UMESimdBankTest<FLOAT_T, STRIDE, DEGREE, POLYNOMIAL_HORNER>(channels, per_channel_x));
+    newCategory->registerTest(new UMESimdBankTest<FLOAT_T, STRIDE, DEGREE, POLYNOMIAL_ESTRIN>(channels, per_channel_x));
+
+    harness.registerTestCategory(newCategory);
+}
@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#pragma once
+
+#include <cmath>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+// Evaluation of a single polynomial of 'degree' at every element of 'x'. Unlike the
+// fixed order 16 tests, results are stored for every element and verified against
+// Horner's scheme evaluated in long double precision.
+template<typename FLOAT_T>
+class PolynomialDegreeTest : public Test {
+protected:
+    int problem_size;
+    int degree;
+
+    FLOAT_T *a;
+    FLOAT_T *x;
+    FLOAT_T *y;
+
+public:
+    PolynomialDegreeTest(int problem_size, int degree) : Test(true), problem_size(problem_size), degree(degree) {}
+
+    UME_NEVER_INLINE virtual void initialize() {
+        // Alignment sufficient for any SIMD vector
+        x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(problem_size * sizeof(FLOAT_T), 64);
+        y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(problem_size * sizeof(FLOAT_T), 64);
+        a = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc((degree + 1) * sizeof(FLOAT_T), sizeof(FLOAT_T));
+
+        srand((unsigned int)time(NULL));
+        // Initialize arrays with random data
+        for (int i = 0; i < problem_size; i++)
+        {
+            // Generate random numbers in range (0.0;1.0)
+            x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+            y[i] = FLOAT_T(0.0f);
+        }
+
+        for (int i = 0; i <= degree; i++)
+        {
+            // Generate random coefficients in range (0.0; 1.0)
+            a[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(a);
+        UME::DynamicMemory::AlignedFree(y);
+        UME::DynamicMemory::AlignedFree(x);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        long double max_err = 0;
+
+        for (int i = 0; i < problem_size; i++) {
+            long double expected = a[degree];
+            for (int k = degree - 1; k >= 0; k--) {
+                expected = expected * x[i] + a[k];
+            }
+            // All coefficients and arguments are positive, so 'expected' >= a[0] > 0
+            long double diff = std::fabs(y[i] - expected) / expected;
+            max_err = max_err > diff ? max_err : diff;
+        }
+
+        error_norm_bignum = double(max_err);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+// Horner's scheme with the degree known only at runtime
+template<typename FLOAT_T>
+class ScalarHornerTest : public PolynomialDegreeTest<FLOAT_T> {
+public:
+    ScalarHornerTest(int problem_size, int degree) : PolynomialDegreeTest<FLOAT_T>(problem_size, degree) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int i = 0; i < this->problem_size; i++) {
+            FLOAT_T acc = this->a[this->degree];
+            for (int k = this->degree - 1; k >= 0; k--) {
+                acc = acc * this->x[i] + this->a[k];
+            }
+            this->y[i] = acc;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+
+        retval += "Scalar Horner, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(this->problem_size) +
+            ", degree " + std::to_string(this->degree);
+
+        return retval;
+    }
+};
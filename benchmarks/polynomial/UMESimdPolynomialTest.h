@@ -0,0 +1,103 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2015-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's 
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+
+#pragma once
+
+#include <umesimd/UMESimd.h>
+
+#include "PolynomialDegreeTest.h"
+#include "../utilities/UMESimdPolynomial.h"
+
+template<typename FLOAT_T, int STRIDE, int DEGREE, int SCHEME>
+class UMESimdPolynomialTest : public PolynomialDegreeTest<FLOAT_T> {
+private:
+    typedef typename UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_TYPE;
+    typedef UMESimdPolynomial<FLOAT_VEC_TYPE, DEGREE, SCHEME> POLYNOMIAL_T;
+
+public:
+    UMESimdPolynomialTest(int problem_size) : PolynomialDegreeTest<FLOAT_T>(problem_size, DEGREE) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        POLYNOMIAL_T polynomial(this->a);
+        FLOAT_VEC_TYPE x_vec, y_vec;
+
+        int LOOP_PEEL_OFFSET = (this->problem_size / STRIDE) * STRIDE;
+        for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+            x_vec.loada(&this->x[i]);
+            y_vec = polynomial.evaluate(x_vec);
+            y_vec.storea(&this->y[i]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int i = LOOP_PEEL_OFFSET; i < this->problem_size; i++) {
+            FLOAT_T acc = this->a[DEGREE];
+            for (int k = DEGREE - 1; k >= 0; k--) {
+                acc = acc * this->x[i] + this->a[k];
+            }
+            this->y[i] = acc;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+
+        retval += "UME::SIMD " + std::string(POLYNOMIAL_T::scheme_name()) + ", " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            std::to_string(STRIDE) + ", " +
+            std::to_string(this->problem_size) +
+            ", degree " + std::to_string(DEGREE);
+
+        return retval;
+    }
+};
+
+// Registers a category of tests for each of COUNT degrees, starting from DEGREE
+template<typename FLOAT_T, int STRIDE, int DEGREE, int COUNT>
+struct PolynomialDegreeSweep {
+    static void registerCategories(BenchmarkHarness & harness, int problem_size) {
+        TestCategory *newCategory = new TestCategory(std::string("polynomial_degree"));
+        newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+        newCategory->registerParameter(new ValueParameter<int>(std::string("degree"), DEGREE));
+        newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), problem_size));
+
+        newCategory->registerTest(new ScalarHornerTest<FLOAT_T>(problem_size, DEGREE));
+        newCategory->registerTest(new UMESimdPolynomialTest<FLOAT_T, STRIDE, DEGREE, POLYNOMIAL_HORNER>(problem_size));
+        newCategory->registerTest(new UMESimdPolynomialTest<FLOAT_T, STRIDE, DEGREE, POLYNOMIAL_ESTRIN>(problem_size));
+
+        harness.registerTestCategory(newCategory);
+
+        PolynomialDegreeSweep<FLOAT_T, STRIDE, DEGREE + 1, COUNT - 1>::registerCategories(harness, problem_size);
+    }
+};
+
+template<typename FLOAT_T, int STRIDE, int DEGREE>
+struct PolynomialDegreeSweep<FLOAT_T, STRIDE, DEGREE, 0> {
+    static void registerCategories(BenchmarkHarness &, int) {}
+};
@@ -84,7 +84,7 @@ public:
 
         FLOAT_VEC_TYPE a0(a[0]), a1(a[1]), a2(a[2]), a3(a[3]),
             a4(a[4]), a5(a[5]), a6(a[6]), a7(a[7]),
-            a8(a[8]), a9(a[9]), a10(a[10]), a11(11),
+            a8(a[8]), a9(a[9]), a10(a[10]), a11(a[11]),
             a12(a[12]), a13(a[13]), a14(a[14]), a15(a[15]);
 
         for (int i = 0; i < problem_size; i += FLOAT_VEC_TYPE::length()) {
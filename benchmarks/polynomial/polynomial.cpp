@@ -45,6 +45,8 @@
 #include "ScalarTest.h"
 #include "UMESimdTest.h"
 #include "UMESimdOmpParallelTest.h"
+#include "UMESimdPolynomialTest.h"
+#include "PolynomialBankTest.h"
 #include "AVXTest.h"
 #include "AVX512Test.h"
 #include "OpenmpTest.h"
@@ -56,6 +58,10 @@
 #define BREAK_COMPILER_OPTIMIZATION() __asm__ ("NOP");
 
 const int ARRAY_SIZE = 1000000000; // TODO: modify benchmarks to consider peeling effect.
+// Problem size of the degree sweep, where results of every element are kept
+const int DEGREE_SWEEP_SIZE = 1048576;
+// Number of channels, each with its own polynomial
+const int BANK_CHANNELS = 1000000;
 
 int main(int argc, char **argv)
 {
@@ -71,7 +77,11 @@ int main(int argc, char **argv)
                  "All timing results in nanoseconds. \n"
                  "Speedup calculated with scalar floating point result as reference.\n\n"
                  "SIMD version uses following operations: \n"
-                 " ZERO-CONSTR, SET-CONSTR, LOAD, STORE, MULV, FMULADDV, ADDVA\n";
+                 " ZERO-CONSTR, SET-CONSTR, LOAD, STORE, MULV, FMULADDV, ADDVA\n\n"
+                 "Category 'polynomial_degree' compares Horner's and Estrin's schemes\n"
+                 "generated at compile time for degrees 2 to 32, on " << DEGREE_SWEEP_SIZE << " elements.\n"
+                 "Category 'polynomial_bank' evaluates a different polynomial for each of\n"
+                 << BANK_CHANNELS << " channels, with one channel per SIMD lane.\n";
 
     //for (int i = MIN_SIZE; i <= MAX_SIZE; i*=PROGRESSION) {
         std::string categoryName = std::string("polynomial");
@@ -126,6 +136,18 @@ int main(int argc, char **argv)
         harness.registerTestCategory(newCategory);
     //}
 
+    PolynomialDegreeSweep<float, 8, 2, 31>::registerCategories(harness, DEGREE_SWEEP_SIZE);
+    PolynomialDegreeSweep<double, 4, 2, 31>::registerCategories(harness, DEGREE_SWEEP_SIZE);
+
+    for (bool per_channel_x : { false, true }) {
+        registerPolynomialBankCategory<float, 8, 3>(harness, BANK_CHANNELS, per_channel_x);
+        registerPolynomialBankCategory<float, 8, 8>(harness, BANK_CHANNELS, per_channel_x);
+        registerPolynomialBankCategory<float, 8, 16>(harness, BANK_CHANNELS, per_channel_x);
+        registerPolynomialBankCategory<double, 4, 3>(harness, BANK_CHANNELS, per_channel_x);
+        registerPolynomialBankCategory<double, 4, 8>(harness, BANK_CHANNELS, per_channel_x);
+        registerPolynomialBankCategory<double, 4, 16>(harness, BANK_CHANNELS, per_channel_x);
+    }
+
     harness.runTests(ITERATIONS);
 
     return 0;
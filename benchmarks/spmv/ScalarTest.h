@@ -0,0 +1,63 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+//
+#ifndef SCALAR_SPMV_BENCH_H_
+#define SCALAR_SPMV_BENCH_H_
+
+#include <umesimd/UMESimd.h>
+
+#include "SpmvTest.h"
+
+template<typename FLOAT_T>
+class ScalarCsrTest : public SpmvTest<FLOAT_T> {
+public:
+    ScalarCsrTest(int problem_size, SparsityPattern pattern, int density) :
+        SpmvTest<FLOAT_T>(problem_size, pattern, density) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        for (int i = 0; i < this->problem_size; i++) {
+            FLOAT_T sum = FLOAT_T(0.0f);
+            for (int j = this->row_ptr[i]; j < this->row_ptr[i + 1]; j++) {
+                sum += this->values[j] * this->x[this->col_idx[j]];
+            }
+            this->y[i] = sum;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "Scalar CSR, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            this->matrix_description();
+        return retval;
+    }
+};
+
+#endif
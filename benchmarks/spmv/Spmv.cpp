@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+//
+
+#include <iostream>
+#include <memory>
+
+#include <cmath>
+#include <time.h>
+#include <stdlib.h>
+#include <string>
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/TimingStatistics.h"
+#include "../utilities/MeasurementHarness.h"
+
+#include "ScalarTest.h"
+#include "UMESimdTest.h"
+
+// STRIDE0 and STRIDE1 are SIMD strides for 256b and 512b registers. SELL-C-sigma
+// uses C = SIMD stride.
+template<typename FLOAT_T, int STRIDE0, int STRIDE1>
+void register_category(BenchmarkHarness & harness, int i, SparsityPattern pattern, int density) {
+    const int SIGMA = 256;
+    long long nnz = spmv_nonzeros(i, pattern, density);
+
+    std::string categoryName = std::string("SPMV_") + sparsity_to_string(pattern);
+    TestCategory *newCategory = new TestCategory(categoryName);
+    newCategory->registerParameter(new ValueParameter<int>(std::string("precision"), 8 * sizeof(FLOAT_T)));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("problem_size"), i));
+    newCategory->registerParameter(new ValueParameter<int>(std::string("density"), density));
+    newCategory->registerParameter(new ValueParameter<long long>(std::string("nnz"), nnz));
+    newCategory->registerParameter(new ValueParameter<long long>(std::string("flops"), 2 * nnz));
+
+    newCategory->registerTest(new ScalarCsrTest<FLOAT_T>(i, pattern, density));
+    newCategory->registerTest(new UMESimdCsrGatherTest<FLOAT_T, STRIDE0>(i, pattern, density));
+    newCategory->registerTest(new UMESimdCsrGatherTest<FLOAT_T, STRIDE1>(i, pattern, density));
+    newCategory->registerTest(new UMESimdSellTest<FLOAT_T, STRIDE0>(i, pattern, density, 1));
+    newCategory->registerTest(new UMESimdSellTest<FLOAT_T, STRIDE0>(i, pattern, density, SIGMA));
+    newCategory->registerTest(new UMESimdSellTest<FLOAT_T, STRIDE1>(i, pattern, density, 1));
+    newCategory->registerTest(new UMESimdSellTest<FLOAT_T, STRIDE1>(i, pattern, density, SIGMA));
+
+    harness.registerTestCategory(newCategory);
+}
+
+int main(int argc, char **argv)
+{
+    int MIN_SIZE = 1024;
+    int MAX_SIZE = 1048576;
+    int PROGRESSION = 4;
+    int ITERATIONS = 10;
+
+    // Half-bandwidth of banded matrices and average row length of random matrices.
+    int BANDWIDTH = 4;
+    int NNZ_PER_ROW = 16;
+
+    BenchmarkHarness harness(argc, argv);
+
+    std::cout <<
+        "[Run with -v to verify results and report the error of each variant]\n"
+        "\n"
+        "This benchmark measures execution of y = A * x (SpMV) with a sparse\n"
+        "square matrix A. Two matrix structures are used:\n"
+        " - banded, with " << 2 * BANDWIDTH + 1 << " non-zeros around the diagonal of each row\n"
+        " - random, with on average " << NNZ_PER_ROW << " non-zeros at random columns of each row\n"
+        "and three kernels:\n"
+        " - scalar CSR\n"
+        " - CSR with rows processed by SIMD gathers and horizontal reductions\n"
+        " - SELL-C-sigma, with C equal to the SIMD stride and rows sorted by length\n"
+        "   within windows of sigma rows\n\n"
+        "Each test reports its effective bandwidth (GB/s), computed from the bytes\n"
+        "its storage format has to move, and its GFLOP/s, computed from the 2 * nnz\n"
+        "flops listed with the category.\n\n";
+
+    for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
+        register_category<float, 8, 16>(harness, i, SPARSITY_BANDED, BANDWIDTH);
+        register_category<float, 8, 16>(harness, i, SPARSITY_RANDOM, NNZ_PER_ROW);
+    }
+
+    for (int i = MIN_SIZE; i <= MAX_SIZE; i *= PROGRESSION) {
+        register_category<double, 4, 8>(harness, i, SPARSITY_BANDED, BANDWIDTH);
+        register_category<double, 4, 8>(harness, i, SPARSITY_RANDOM, NNZ_PER_ROW);
+    }
+
+    harness.runTests(ITERATIONS);
+}
@@ -0,0 +1,231 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+//
+#ifndef SPMV_BENCH_H_
+#define SPMV_BENCH_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <stdlib.h>
+
+#include <umesimd/UMESimd.h>
+
+#include "../utilities/MeasurementHarness.h"
+#include "../utilities/UMEScalarToString.h"
+
+#include "../utilities/ttmath/ttmath/ttmath.h"
+
+// Column indices have the width of matrix elements: UME::SIMD gathers
+// elements using unsigned integer vectors of the same element width, so
+// SIMD kernels can load the indices directly into an index vector.
+template<typename FLOAT_T> struct SpmvIndex;
+template<> struct SpmvIndex<float> { typedef uint32_t type; };
+template<> struct SpmvIndex<double> { typedef uint64_t type; };
+
+enum SparsityPattern {
+    // Row 'i' has non-zeros in columns (i - bandwidth; i + bandwidth).
+    SPARSITY_BANDED,
+    // Row lengths are uniformly distributed in (1; 2 * nnz_per_row - 1),
+    // column indices are spread randomly over the whole row.
+    SPARSITY_RANDOM
+};
+
+inline std::string sparsity_to_string(SparsityPattern pattern) {
+    return pattern == SPARSITY_BANDED ? "banded" : "random";
+}
+
+// Row lengths do not depend on the random seed, so that the number of non-zeros
+// (and so flops and bytes moved) is known before the matrix is generated.
+inline int spmv_row_length(int row, int size, SparsityPattern pattern, int density) {
+    if (pattern == SPARSITY_BANDED) {
+        int first = row - density < 0 ? 0 : row - density;
+        int last = row + density >= size ? size - 1 : row + density;
+        return last - first + 1;
+    }
+    uint32_t hash = uint32_t(row) * 2654435761u;
+    hash ^= hash >> 16;
+    int length = 1 + int(hash % uint32_t(2 * density - 1));
+    return length > size ? size : length;
+}
+
+// 'y' is allocated with a padding, so that kernels processing blocks of up to
+// MAX_SPMV_STRIDE rows can store whole blocks.
+static const int MAX_SPMV_STRIDE = 32;
+
+inline int padded_rows(int size) {
+    return ((size + MAX_SPMV_STRIDE - 1) / MAX_SPMV_STRIDE) * MAX_SPMV_STRIDE;
+}
+
+inline long long spmv_nonzeros(int size, SparsityPattern pattern, int density) {
+    long long nnz = 0;
+    for (int i = 0; i < size; i++) nnz += spmv_row_length(i, size, pattern, density);
+    return nnz;
+}
+
+// y = A * x with A being a square 'problem_size' x 'problem_size' sparse matrix
+// stored in CSR format. Tests using other formats convert the matrix in
+// 'initialize', outside of the measured code.
+template<typename FLOAT_T>
+class SpmvTest : public Test {
+protected:
+    static const int OPTIMAL_ALIGNMENT = 64;
+    typedef typename SpmvIndex<FLOAT_T>::type INDEX_T;
+    typedef ttmath::Big<2, 2> BigFloat;
+
+    // CSR storage: non-zeros of row 'i' are at positions (row_ptr[i]; row_ptr[i+1] - 1)
+    // of 'values' and 'col_idx'.
+    int *row_ptr;
+    INDEX_T *col_idx;
+    FLOAT_T *values;
+    int nnz;
+
+    FLOAT_T *x, *y;
+
+    int problem_size;
+    SparsityPattern pattern;
+    // Half-bandwidth for banded, average row length for random matrices.
+    int density;
+
+    void fill_row(int row) {
+        int start = row_ptr[row];
+        int length = row_ptr[row + 1] - start;
+        if (pattern == SPARSITY_BANDED) {
+            int first = row - density < 0 ? 0 : row - density;
+            for (int j = 0; j < length; j++) col_idx[start + j] = INDEX_T(first + j);
+        }
+        else {
+            // One random column out of each of 'length' equal intervals, so that
+            // columns are sorted and unique.
+            for (int j = 0; j < length; j++) {
+                long long lo = (long long)problem_size * j / length;
+                long long hi = (long long)problem_size * (j + 1) / length;
+                col_idx[start + j] = INDEX_T(lo + rand() % (hi - lo));
+            }
+        }
+        for (int j = 0; j < length; j++) {
+            // Generate random numbers in range (0.0;1.0)
+            values[start + j] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+    }
+
+public:
+    SpmvTest(int problem_size, SparsityPattern pattern, int density) :
+        Test(true), problem_size(problem_size), pattern(pattern), density(density)
+    {
+        nnz = (int)spmv_nonzeros(problem_size, pattern, density);
+    }
+
+    UME_NEVER_INLINE virtual void initialize() {
+        srand((unsigned int)time(NULL));
+
+        row_ptr = (int *)UME::DynamicMemory::AlignedMalloc((problem_size + 1) * sizeof(int), OPTIMAL_ALIGNMENT);
+        row_ptr[0] = 0;
+        for (int i = 0; i < problem_size; i++) {
+            row_ptr[i + 1] = row_ptr[i] + spmv_row_length(i, problem_size, pattern, density);
+        }
+
+        col_idx = (INDEX_T *)UME::DynamicMemory::AlignedMalloc(nnz * sizeof(INDEX_T), OPTIMAL_ALIGNMENT);
+        values = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(nnz * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        for (int i = 0; i < problem_size; i++) {
+            fill_row(i);
+        }
+
+        x = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(problem_size * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        y = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(padded_rows(problem_size) * sizeof(FLOAT_T), OPTIMAL_ALIGNMENT);
+        for (int i = 0; i < problem_size; i++) {
+            x[i] = static_cast <FLOAT_T> (rand()) / static_cast <FLOAT_T> (RAND_MAX);
+        }
+        for (int i = 0; i < padded_rows(problem_size); i++) {
+            y[i] = FLOAT_T(0.0f);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() = 0;
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(row_ptr);
+        UME::DynamicMemory::AlignedFree(col_idx);
+        UME::DynamicMemory::AlignedFree(values);
+        UME::DynamicMemory::AlignedFree(x);
+        UME::DynamicMemory::AlignedFree(y);
+    }
+
+    UME_NEVER_INLINE virtual void verify() {
+        BigFloat max_err = 0;
+        BigFloat norm = 0;
+
+        for (int i = 0; i < problem_size; i++) {
+            BigFloat expected = 0;
+            for (int j = row_ptr[i]; j < row_ptr[i + 1]; j++) {
+                expected += BigFloat(values[j]) * BigFloat(x[col_idx[j]]);
+            }
+            BigFloat diff = ttmath::Abs(BigFloat(y[i]) - expected);
+            max_err = max_err > diff ? max_err : diff;
+            BigFloat y_abs = ttmath::Abs(expected);
+            norm = y_abs > norm ? y_abs : norm;
+        }
+
+        error_norm_bignum = max_err / norm;
+    }
+
+    // Minimal memory traffic of CSR SpMV: matrix, 'x' read once and 'y' written once.
+    unsigned long long csr_bytes_moved() {
+        return (unsigned long long)nnz * (sizeof(FLOAT_T) + sizeof(INDEX_T)) +
+            (unsigned long long)(problem_size + 1) * sizeof(int) +
+            2ULL * problem_size * sizeof(FLOAT_T);
+    }
+
+    // Memory traffic of the storage format used by the kernel.
+    virtual unsigned long long bytes_moved() {
+        return csr_bytes_moved();
+    }
+
+    // The elapsed time is given in ns, so bytes and flops per elapsed time are
+    // the effective bandwidth in GB/s and GFLOP/s. Padding of the storage format
+    // counts as moved bytes, but not as flops.
+    UME_NEVER_INLINE virtual TestMetrics get_test_metrics() {
+        TestMetrics metrics;
+        double elapsed = this->stats.getAverage();
+        if (elapsed > 0.0) {
+            metrics.push_back(std::make_pair(std::string("GB/s"), (double)bytes_moved() / elapsed));
+            metrics.push_back(std::make_pair(std::string("GFLOP/s"), 2.0 * nnz / elapsed));
+        }
+        return metrics;
+    }
+
+    std::string matrix_description() {
+        return sparsity_to_string(pattern) + " " + std::to_string(problem_size) +
+            ", nnz " + std::to_string(nnz);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() = 0;
+};
+
+#endif
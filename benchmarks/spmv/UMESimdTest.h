@@ -0,0 +1,231 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2017 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+//
+#ifndef UME_SIMD_SPMV_BENCH_H_
+#define UME_SIMD_SPMV_BENCH_H_
+
+#include <vector>
+#include <algorithm>
+
+#include <umesimd/UMESimd.h>
+
+#include "SpmvTest.h"
+
+// CSR SpMV with each row processed by SIMD_STRIDE non-zeros at a time: 'x'
+// elements are gathered using column indices, partial sums are reduced
+// horizontally at the end of the row.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdCsrGatherTest : public SpmvTest<FLOAT_T> {
+private:
+    typedef typename SpmvTest<FLOAT_T>::INDEX_T INDEX_T;
+
+public:
+    UMESimdCsrGatherTest(int problem_size, SparsityPattern pattern, int density) :
+        SpmvTest<FLOAT_T>(problem_size, pattern, density) {}
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UME::SIMD::SIMDVec<FLOAT_T, STRIDE> acc, val_vec, x_vec;
+        UME::SIMD::SIMDVec<INDEX_T, STRIDE> idx_vec;
+
+        for (int i = 0; i < this->problem_size; i++) {
+            int start = this->row_ptr[i];
+            int end = this->row_ptr[i + 1];
+            int LOOP_PEEL_OFFSET = start + ((end - start) / STRIDE) * STRIDE;
+
+            acc = FLOAT_T(0.0f);
+            for (int j = start; j < LOOP_PEEL_OFFSET; j += STRIDE) {
+                // Rows start at arbitrary offsets, so loads are unaligned.
+                val_vec.load(&this->values[j]);
+                idx_vec.load(&this->col_idx[j]);
+                x_vec.gather(this->x, idx_vec);
+                acc = val_vec.fmuladd(x_vec, acc);
+            }
+            FLOAT_T sum = LOOP_PEEL_OFFSET > start ? acc.hadd() : FLOAT_T(0.0f);
+
+            // Use scalar code to handle the reminder of elements.
+            for (int j = LOOP_PEEL_OFFSET; j < end; j++) {
+                sum += this->values[j] * this->x[this->col_idx[j]];
+            }
+            this->y[i] = sum;
+        }
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD CSR gather, " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            this->matrix_description() +
+            ", stride " + std::to_string(STRIDE);
+        return retval;
+    }
+};
+
+// SELL-C-sigma SpMV with C equal to SIMD_STRIDE. Rows are sorted by decreasing
+// length within windows of 'sigma' rows and grouped in slices of C rows. Each
+// slice is padded to its longest row and stored column-major, so that a single
+// aligned load brings one non-zero of each of the C rows and the slice is
+// computed with vertical operations only. Results are scattered back to the
+// original row order.
+//
+// sigma = 1 keeps the original row order. Larger 'sigma' reduces the padding for
+// irregular matrices, but makes accesses to 'x' and 'y' less local.
+template<typename FLOAT_T, int STRIDE>
+class UMESimdSellTest : public SpmvTest<FLOAT_T> {
+private:
+    typedef typename SpmvTest<FLOAT_T>::INDEX_T INDEX_T;
+
+    int sigma;
+    int slice_count;
+    long long sell_nnz;
+
+    // Slice 's' occupies positions (slice_ptr[s]; slice_ptr[s+1] - 1) of 'sell_values'
+    // and 'sell_cols'. 'perm[s * STRIDE + r]' is the original index of row 'r' of slice 's'.
+    int *slice_ptr;
+    INDEX_T *sell_cols;
+    FLOAT_T *sell_values;
+    INDEX_T *perm;
+
+    // Row order and slice offsets only depend on row lengths, so they can be
+    // computed before the matrix is generated.
+    void build_slices(std::vector<int> & rows, std::vector<int> & offsets) {
+        int size = this->problem_size;
+        std::vector<int> lengths(slice_count * STRIDE, 0);
+        rows.resize(slice_count * STRIDE);
+        for (int i = 0; i < slice_count * STRIDE; i++) {
+            rows[i] = i;
+            if (i < size) lengths[i] = spmv_row_length(i, size, this->pattern, this->density);
+        }
+
+        if (sigma > 1) {
+            for (int i = 0; i < size; i += sigma) {
+                int last = std::min(i + sigma, size);
+                std::stable_sort(rows.begin() + i, rows.begin() + last,
+                    [&lengths](int a, int b) { return lengths[a] > lengths[b]; });
+            }
+        }
+
+        offsets.resize(slice_count + 1);
+        offsets[0] = 0;
+        for (int s = 0; s < slice_count; s++) {
+            int max_length = 0;
+            for (int r = 0; r < STRIDE; r++) {
+                max_length = std::max(max_length, lengths[rows[s * STRIDE + r]]);
+            }
+            offsets[s + 1] = offsets[s] + max_length * STRIDE;
+        }
+    }
+
+public:
+    UMESimdSellTest(int problem_size, SparsityPattern pattern, int density, int sigma) :
+        SpmvTest<FLOAT_T>(problem_size, pattern, density), sigma(sigma)
+    {
+        slice_count = (problem_size + STRIDE - 1) / STRIDE;
+
+        std::vector<int> rows, offsets;
+        build_slices(rows, offsets);
+        sell_nnz = offsets[slice_count];
+    }
+
+    UME_NEVER_INLINE virtual void initialize() {
+        SpmvTest<FLOAT_T>::initialize();
+
+        std::vector<int> rows, offsets;
+        build_slices(rows, offsets);
+
+        slice_ptr = (int *)UME::DynamicMemory::AlignedMalloc((slice_count + 1) * sizeof(int), this->OPTIMAL_ALIGNMENT);
+        perm = (INDEX_T *)UME::DynamicMemory::AlignedMalloc(slice_count * STRIDE * sizeof(INDEX_T), this->OPTIMAL_ALIGNMENT);
+        sell_cols = (INDEX_T *)UME::DynamicMemory::AlignedMalloc(sell_nnz * sizeof(INDEX_T), this->OPTIMAL_ALIGNMENT);
+        sell_values = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc(sell_nnz * sizeof(FLOAT_T), this->OPTIMAL_ALIGNMENT);
+
+        for (int s = 0; s <= slice_count; s++) slice_ptr[s] = offsets[s];
+
+        for (int s = 0; s < slice_count; s++) {
+            int slice_length = (slice_ptr[s + 1] - slice_ptr[s]) / STRIDE;
+            for (int r = 0; r < STRIDE; r++) {
+                int row = rows[s * STRIDE + r];
+                perm[s * STRIDE + r] = INDEX_T(row);
+
+                int start = row < this->problem_size ? this->row_ptr[row] : 0;
+                int length = row < this->problem_size ? this->row_ptr[row + 1] - start : 0;
+                for (int k = 0; k < slice_length; k++) {
+                    // Padding uses zero values and column 0, so no masking is needed.
+                    int pos = slice_ptr[s] + k * STRIDE + r;
+                    sell_values[pos] = k < length ? this->values[start + k] : FLOAT_T(0.0f);
+                    sell_cols[pos] = k < length ? this->col_idx[start + k] : INDEX_T(0);
+                }
+            }
+        }
+    }
+
+    UME_NEVER_INLINE virtual void benchmarked_code() {
+        UME::SIMD::SIMDVec<FLOAT_T, STRIDE> acc, val_vec, x_vec;
+        UME::SIMD::SIMDVec<INDEX_T, STRIDE> idx_vec, row_vec;
+
+        for (int s = 0; s < slice_count; s++) {
+            acc = FLOAT_T(0.0f);
+            for (int j = slice_ptr[s]; j < slice_ptr[s + 1]; j += STRIDE) {
+                val_vec.loada(&sell_values[j]);
+                idx_vec.loada(&sell_cols[j]);
+                x_vec.gather(this->x, idx_vec);
+                acc = val_vec.fmuladd(x_vec, acc);
+            }
+            row_vec.loada(&perm[s * STRIDE]);
+            acc.scatter(this->y, row_vec);
+        }
+    }
+
+    UME_NEVER_INLINE virtual void cleanup() {
+        UME::DynamicMemory::AlignedFree(slice_ptr);
+        UME::DynamicMemory::AlignedFree(perm);
+        UME::DynamicMemory::AlignedFree(sell_cols);
+        UME::DynamicMemory::AlignedFree(sell_values);
+        SpmvTest<FLOAT_T>::cleanup();
+    }
+
+    // Padded matrix, slice offsets and row permutation, 'x' read once and 'y' written once.
+    virtual unsigned long long bytes_moved() {
+        return (unsigned long long)sell_nnz * (sizeof(FLOAT_T) + sizeof(INDEX_T)) +
+            (unsigned long long)(slice_count + 1) * sizeof(int) +
+            (unsigned long long)slice_count * STRIDE * sizeof(INDEX_T) +
+            (unsigned long long)this->problem_size * sizeof(FLOAT_T) +
+            (unsigned long long)slice_count * STRIDE * sizeof(FLOAT_T);
+    }
+
+    UME_NEVER_INLINE virtual std::string get_test_identifier() {
+        std::string retval = "";
+        retval += "UME::SIMD SELL-" + std::to_string(STRIDE) + "-" + std::to_string(sigma) + ", " +
+            ScalarToString<FLOAT_T>::value() + " " +
+            this->matrix_description() +
+            ", padded nnz " + std::to_string(sell_nnz);
+        return retval;
+    }
+};
+
+#endif
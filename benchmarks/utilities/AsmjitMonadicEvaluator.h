@@ -1,6 +1,25 @@
 #pragma once
 
 #include "../../UME.h"
+// asmjit headers do not compile cleanly with '-pedantic -Werror' used by benchmark Makefiles
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wdeprecated-copy"
+#pragma GCC diagnostic ignored "-Wclass-memaccess"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#endif
+#include "asmjit/src/asmjit/asmjit.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 // This is a POC for a Monadic evaluator using AsmJIT as the code-generation mechanism.
 // 1. We need to traverse the tree and store pointers to all terminal symbols, so that
@@ -8,6 +27,15 @@
 // 2. We need to traverse the tree and compile the function. This should happen preferrably
 //    only once per expression evaluation (some global context needed?).
 // 3. We have to call the pre-compiled function on local data settings.
+//
+// Supported nodes: Scalar, FloatVector, ADD, SUB, MUL, DIV, MIN, MAX, SQRT, RCP, RSQRT,
+// EXP, LOG, SIN, COS, CMP{EQ,NE,LT,LE,GT,GE} and BLEND. Transcendental functions are
+// generated inline as Cephes-style polynomial kernels (same as in 'explog' and 'sincos'
+// benchmarks). Patterns 'a*b+c', 'a*b-c' and 'c-a*b' are fused into single FMA3 instructions
+// by overload resolution on the expression type, so the generated code requires AVX2 and FMA3.
+// HADD is supported only as the root of an expression evaluated into a scalar destination.
+// Before code generation, identical terminals and subtrees are merged by value numbering,
+// so every distinct value is loaded or computed only once per loop iteration.
 template<int VEC_LEN, uint32_t SIMD_STRIDE>
 class AsmjitEvaluator {
     asmjit::JitRuntime runtime;
@@ -15,219 +43,678 @@ class AsmjitEvaluator {
     asmjit::X86Compiler* cc;
 
     static const int MAX_ARG_COUNT = 128;
+    static const int MAX_OUTPUT_COUNT = 8;
+    static const int MAX_ACCUMULATOR_COUNT = 12;
+    static const int DEFAULT_ACCUMULATOR_COUNT = 8;
+    static const int DETERMINISTIC_ACCUMULATOR_COUNT = 4;
 
     int argCount;
+    // Number of elements in the terminal vectors
+    intptr_t length;
 
-    // Argument 1 is the destination, but since argument 0 is number of elements, we 
-    // dont store it here. 'arguments[0]' is then destination pointer.
+    // Base addresses of terminals. For vector destination 'arguments[0]' is the
+    // destination pointer.
     uint64_t arguments[MAX_ARG_COUNT];
     // Offset registers for each pointer argument
     asmjit::X86Gp offsetRegisters[MAX_ARG_COUNT];
-    // value registers for each scalar value
-
-    typedef void(*evaluatorFunc)(void);
+    // Number of destination vectors, mapped to the first arguments
+    int outputCount;
+
+    enum NodeKind {
+        NODE_SCALAR, NODE_VECTOR,
+        NODE_ADD, NODE_SUB, NODE_MUL, NODE_DIV, NODE_MIN, NODE_MAX,
+        NODE_SQRT, NODE_RCP, NODE_RSQRT, NODE_EXP, NODE_LOG, NODE_SIN, NODE_COS,
+        NODE_CMPEQ, NODE_CMPNE, NODE_CMPLT, NODE_CMPLE, NODE_CMPGT, NODE_CMPGE,
+        NODE_BLEND, NODE_HADD
+    };
+
+    // Value numbering (hash-consing) of expression nodes. Nodes of the same kind, with
+    // the same operands and the same payload (scalar bits or terminal index) compute the
+    // same value, so the expression trees are folded into a DAG. Values used more than
+    // once are evaluated once per loop iteration and then copied from a register.
+    struct Value {
+        NodeKind kind;
+        uint64_t payload;
+        int operands[3];
+        int useCount;
+        bool evaluated;
+        asmjit::X86Ymm simd;
+        asmjit::X86Xmm scalar;
+    };
+    std::vector<Value> values;
+
+    // Generated functions process elements [start, start + count) of all terminals.
+    typedef void(*evaluatorFunc)(intptr_t start, intptr_t count);
+    // Reductions store a partial result of the processed range.
+    typedef void(*reductionFunc)(intptr_t start, intptr_t count, float * partial);
+
+    evaluatorFunc evaluatorFn;
+    reductionFunc reductionFn;
+    float * reductionDst;
+    bool deterministicReduction;
+
+    // Chunk boundaries are aligned to a cache line. This also keeps aligned SIMD loads
+    // valid in every chunk, as long as the terminals are aligned.
+    static const int CHUNK_ALIGNMENT = 64 / sizeof(float);
+    // Deterministic reductions use chunks of fixed size, so that the order of combining
+    // partial results does not depend on the number of threads.
+    static const int DETERMINISTIC_CHUNK_SIZE = 16384;
 
 public:
+    // Compile an expression with vector destination. Unless 'execute' is cleared, the
+    // compiled function is immediately called using 'threadCount' threads. The function
+    // can then be re-evaluated with 'run()'.
     template<typename SCALAR_T, typename EXP_T>
     AsmjitEvaluator(
         UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst,
-        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP_T> & exp)
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP_T> & exp,
+        int threadCount = 1,
+        bool execute = true) :
+        evaluatorFn(nullptr), reductionFn(nullptr), reductionDst(nullptr), deterministicReduction(false)
+    {
+        compile_outputs(dst, static_cast<EXP_T &>(exp));
+        if (execute) run(threadCount);
+    }
+
+    // Compile two expressions evaluated in a single loop pass (equivalent of
+    // UME::VECTOR::DyadicEvaluator). Every distinct terminal is loaded only once per
+    // iteration and all results are computed before any of them is stored, so the
+    // destinations can also be used as sources (e.g. in plane rotation).
+    template<typename SCALAR_T, typename EXP0_T, typename EXP1_T>
+    AsmjitEvaluator(
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst0,
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP0_T> & exp0,
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst1,
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP1_T> & exp1,
+        int threadCount = 1,
+        bool execute = true) :
+        evaluatorFn(nullptr), reductionFn(nullptr), reductionDst(nullptr), deterministicReduction(false)
+    {
+        compile_outputs(dst0, static_cast<EXP0_T &>(exp0), dst1, static_cast<EXP1_T &>(exp1));
+        if (execute) run(threadCount);
+    }
+
+    // Compile three expressions evaluated in a single loop pass.
+    template<typename SCALAR_T, typename EXP0_T, typename EXP1_T, typename EXP2_T>
+    AsmjitEvaluator(
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst0,
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP0_T> & exp0,
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst1,
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP1_T> & exp1,
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst2,
+        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP2_T> & exp2,
+        int threadCount = 1,
+        bool execute = true) :
+        evaluatorFn(nullptr), reductionFn(nullptr), reductionDst(nullptr), deterministicReduction(false)
     {
-        EXP_T & reinterpret_exp = static_cast<EXP_T &>(exp);
+        compile_outputs(
+            dst0, static_cast<EXP0_T &>(exp0),
+            dst1, static_cast<EXP1_T &>(exp1),
+            dst2, static_cast<EXP2_T &>(exp2));
+        if (execute) run(threadCount);
+    }
+
+    // Compile a reduction with scalar destination. The reduced expression is accumulated
+    // in 'accumulatorCount' independent vector registers, so that the latency of the
+    // add (or FMA) instruction is hidden. Partial sums are then combined using a pairwise
+    // tree, first across accumulators and then across vector lanes. The remainder is added
+    // to the reduced value in index order.
+    //
+    // With multiple threads every thread reduces a single chunk and the partial results
+    // are combined in chunk order. The summation order then depends on the accumulator
+    // and thread counts. With 'deterministic' set, a fixed accumulator count and fixed
+    // chunk size are used instead, so that results are bitwise reproducible regardless
+    // of both settings.
+    template<typename SCALAR_T, typename E1>
+    AsmjitEvaluator(
+        SCALAR_T * dst,
+        UME::VECTOR::ArithmeticHADDExpression<SCALAR_T, SIMD_STRIDE, E1> & exp,
+        int accumulatorCount = DEFAULT_ACCUMULATOR_COUNT,
+        bool deterministic = false,
+        int threadCount = 1,
+        bool execute = true) :
+        evaluatorFn(nullptr), reductionFn(nullptr), reductionDst(dst), deterministicReduction(deterministic)
+    {
+        static_assert(std::is_same<SCALAR_T, float>::value, "AsmjitEvaluator generates single precision code only.");
+        static_assert(SIMD_STRIDE == 8, "AsmjitEvaluator reduces 8-lane YMM accumulators only.");
 
         code.init(runtime.getCodeInfo());
         asmjit::Error err;
 
         asmjit::X86Compiler compiler(&code);
+        cc = &compiler;
 
-        cc = &compiler;//= new asmjit::X86Compiler(&code);
-
-        asmjit::X86Gp cnt = cc->newInt32("cnt");
-        offsetRegisters[0] = cc->newIntPtr("Dst");
+        asmjit::X86Gp start = cc->newIntPtr("start");
+        asmjit::X86Gp cnt = cc->newIntPtr("cnt");
+        asmjit::X86Gp dstPtr = cc->newIntPtr("Dst");
 
-        // Visit all nodes and figure out the function signature.
-        argCount = 1;
-        map_arguments(reinterpret_exp);
+        // There is no destination vector, so all offset registers are used by terminals.
+        argCount = 0;
+        outputCount = 0;
+        length = 0;
+        values.clear();
+        values[map_arguments(exp._e1)].useCount++;
+        count_uses();
+
+        if (deterministic) accumulatorCount = DETERMINISTIC_ACCUMULATOR_COUNT;
+        if (accumulatorCount < 1) accumulatorCount = 1;
+        if (accumulatorCount > MAX_ACCUMULATOR_COUNT) accumulatorCount = MAX_ACCUMULATOR_COUNT;
+
+        cc->addFunc(asmjit::FuncSignature3<void, intptr_t, intptr_t, float*>());
+        cc->setArg(0, start);
+        cc->setArg(1, cnt);
+        cc->setArg(2, dstPtr);
+
+        init_arguments(start, sizeof(SCALAR_T));
+
+        asmjit::X86Ymm acc[MAX_ACCUMULATOR_COUNT];
+        for (int i = 0; i < accumulatorCount; i++) {
+            acc[i] = cc->newYmmPs();
+            cc->vxorps(acc[i], acc[i], acc[i]);
+        }
 
-        // Now when all arguments are already mapped, we can initialize parameters
-        asmjit::CCFunc* evaluator = cc->addFunc(asmjit::FuncSignature0<void>());
+        asmjit::Label unrolled_loop_begin = cc->newLabel();
+        asmjit::Label unrolled_loop_end = cc->newLabel();
+        asmjit::Label peel_loop_begin = cc->newLabel();
+        asmjit::Label peel_loop_end = cc->newLabel();
+        asmjit::Label reminder_loop_begin = cc->newLabel();
+        asmjit::Label exit = cc->newLabel();
 
-        // Initialize iteration count
-        asmjit::X86Mem t0 = cc->newInt64Const(asmjit::kConstScopeLocal, dst.LENGTH());
-        cc->mov(cnt, t0);
+        // Unrolled loop: every accumulator consumes one SIMD vector per iteration
+        err = cc->cmp(cnt, accumulatorCount*SIMD_STRIDE);
+        err = cc->jl(unrolled_loop_end);
+        err = cc->bind(unrolled_loop_begin);
+        for (int i = 0; i < accumulatorCount; i++) {
+            accumulate(exp._e1, acc[i]);
+            advance_arguments(sizeof(SCALAR_T)*SIMD_STRIDE);
+        }
+        err = cc->sub(cnt, accumulatorCount*SIMD_STRIDE);
+        err = cc->cmp(cnt, accumulatorCount*SIMD_STRIDE);
+        err = cc->jge(unrolled_loop_begin);
+        err = cc->bind(unrolled_loop_end);
 
-        // Initialize destination offset register
-        asmjit::X86Mem t1 = cc->newInt64Const(asmjit::kConstScopeLocal, (uint64_t)dst.elements);
-        cc->mov(offsetRegisters[0], t1);
+        // Remaining full SIMD vectors
+        err = cc->cmp(cnt, SIMD_STRIDE);
+        err = cc->jl(peel_loop_end);
+        err = cc->bind(peel_loop_begin);
+        accumulate(exp._e1, acc[0]);
+        advance_arguments(sizeof(SCALAR_T)*SIMD_STRIDE);
+        err = cc->sub(cnt, SIMD_STRIDE);
+        err = cc->cmp(cnt, SIMD_STRIDE);
+        err = cc->jge(peel_loop_begin);
+        err = cc->bind(peel_loop_end);
 
-        // Initialize remaining offset registers
-        for (int i = 1; i < argCount; i++) {
-            asmjit::X86Mem tX = cc->newInt64Const(asmjit::kConstScopeLocal, arguments[i]);
-            err = cc->mov(offsetRegisters[i], tX);
+        // Tree reduction of accumulators
+        for (int step = 1; step < accumulatorCount; step *= 2) {
+            for (int i = 0; i + step < accumulatorCount; i += 2 * step) {
+                cc->vaddps(acc[i], acc[i], acc[i + step]);
+            }
         }
 
-        {
-            //err = cc->setArg(0, cnt);
-            //err = cc->setArg(1, offsetRegisters[0]);
-
-            asmjit::Label peel_loop_begin = cc->newLabel();
-            asmjit::Label peel_loop_end = cc->newLabel();
-            asmjit::Label reminder_loop_begin = cc->newLabel();
-            asmjit::Label reminder_loop_end = cc->newLabel();
-            asmjit::Label exit = cc->newLabel();
-
-            err = cc->cmp(cnt, SIMD_STRIDE);
-            err = cc->jl(peel_loop_end); // skip the peel loop if element count too small
-
-            err = cc->bind(peel_loop_begin);
-            {
-                // SIMD loop
-                asmjit::X86Ymm dst = cc->newYmmPs();
-                eval_simd(reinterpret_exp, dst);
-
-                err = cc->vmovaps(asmjit::x86::yword_ptr(offsetRegisters[0]), dst);
-
-
-                // Advance loop
-                //    Advance destination register
-                err = cc->add(offsetRegisters[0], sizeof(SCALAR_T)*SIMD_STRIDE);
-                //    Advance other registers
-                for (int i = 1; i < argCount; i++)
-                {
-                    cc->add(offsetRegisters[i], sizeof(SCALAR_T)*SIMD_STRIDE);
-                }
-            }
-            err = cc->add(cnt, -(int)SIMD_STRIDE);
-            err = cc->cmp(cnt, SIMD_STRIDE);
-            err = cc->jge(peel_loop_begin);
-            err = cc->bind(peel_loop_end);
-
-            // Check if reminder present
-            err = cc->test(cnt, cnt);
-            err = cc->jz(exit);  // Exit if no reminder
-
-                                 // Scalar code to handle reminder
-            err = cc->bind(reminder_loop_begin);
-            {
-                // scalar loop
-                asmjit::X86Xmm dst = cc->newXmmPs();
-                eval_scalar(reinterpret_exp, dst);
-
-                err = cc->movss(asmjit::x86::ptr(offsetRegisters[0]), dst);
-
-                // Advance loop
-                //    Advance destination register
-                err = cc->add(offsetRegisters[0], sizeof(SCALAR_T));
-                //    Advance other registers
-                for (int i = 1; i < argCount; i++)
-                {
-                    cc->add(offsetRegisters[i], sizeof(SCALAR_T));
-                }
-            }
-            err = cc->dec(cnt);
-            err = cc->jnz(reminder_loop_begin);
+        // Tree reduction of vector lanes: 8 -> 4 -> 2 -> 1 (SIMD_STRIDE is checked in the constructor)
+        asmjit::X86Xmm sum = acc[0].xmm();
+        asmjit::X86Xmm t0 = cc->newXmmPs();
+        cc->vextractf128(t0, acc[0], 1);
+        cc->vaddps(sum, sum, t0);
+        cc->vmovhlps(t0, t0, sum);
+        cc->vaddps(sum, sum, t0);
+        cc->vshufps(t0, sum, sum, 0x1);
+        cc->vaddss(sum, sum, t0);
+
+        // Scalar code to handle reminder
+        err = cc->test(cnt, cnt);
+        err = cc->jz(exit);
+        err = cc->bind(reminder_loop_begin);
+        accumulate(exp._e1, sum);
+        advance_arguments(sizeof(SCALAR_T));
+        err = cc->dec(cnt);
+        err = cc->jnz(reminder_loop_begin);
 
-            err = cc->bind(exit);
-            cc->ret();
-        }
-        cc->endFunc(); // Close the evaluator function
+        err = cc->bind(exit);
+        err = cc->vmovss(asmjit::x86::dword_ptr(dstPtr), sum);
+        cc->ret();
+        cc->endFunc();
 
         cc->finalize();
 
-        evaluatorFunc eval;
-        //err = runtime.add(&fun, &wrapperCode);
-        err = runtime.add(&eval, &code);
+        err = runtime.add(&reductionFn, &code);
         if (err) {
             assert(false);
         }
 
-        // Call the wrapper function
-        eval();
+        if (execute) run(threadCount);
+    }
 
-        //delete cc;
+    // Evaluate the compiled function. The range of elements is split into one chunk per
+    // thread. Threads are taken from the OpenMP runtime, which keeps them alive between
+    // calls. Without OpenMP all chunks are processed by the calling thread.
+    void run(int threadCount = 1) {
+        if (threadCount < 1) threadCount = 1;
+
+        if (reductionFn != nullptr) {
+            run_reduction(threadCount);
+            return;
+        }
+
+        if (threadCount == 1) {
+            evaluatorFn(0, length);
+            return;
+        }
+
+        intptr_t chunkSize = chunk_size(threadCount);
+#if defined(_OPENMP)
+        #pragma omp parallel for num_threads(threadCount) schedule(static)
+#endif
+        for (int i = 0; i < threadCount; i++) {
+            intptr_t chunkStart = i * chunkSize;
+            if (chunkStart < length) {
+                evaluatorFn(chunkStart, std::min(chunkSize, length - chunkStart));
+            }
+        }
     }
 
-    // Evaluate with scalar destination
-    template<typename SCALAR_T, typename EXP_T>
-    AsmjitEvaluator(
-        SCALAR_T * dst,
-        UME::VECTOR::ArithmeticExpression<SCALAR_T, SIMD_STRIDE, EXP_T> & exp)
-    {
-        EXP_T & reinterpret_exp = static_cast<EXP_T &>(exp);
+private:
+    intptr_t chunk_size(int chunkCount) {
+        intptr_t size = (length + chunkCount - 1) / chunkCount;
+        return ((size + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT) * CHUNK_ALIGNMENT;
+    }
 
+    void run_reduction(int threadCount) {
+        if (threadCount == 1 && !deterministicReduction) {
+            reductionFn(0, length, reductionDst);
+            return;
+        }
+
+        intptr_t chunkSize = deterministicReduction ? DETERMINISTIC_CHUNK_SIZE : chunk_size(threadCount);
+        int chunkCount = deterministicReduction ? int((length + chunkSize - 1) / chunkSize) : threadCount;
+        std::vector<float> partials(chunkCount > 0 ? chunkCount : 1, 0.0f);
+
+#if defined(_OPENMP)
+        #pragma omp parallel for num_threads(threadCount) schedule(static)
+#endif
+        for (int i = 0; i < chunkCount; i++) {
+            intptr_t chunkStart = i * chunkSize;
+            if (chunkStart < length) {
+                reductionFn(chunkStart, std::min(chunkSize, length - chunkStart), &partials[i]);
+            }
+        }
+
+        // Combine partial results with a pairwise tree in chunk order
+        for (int step = 1; step < chunkCount; step *= 2) {
+            for (int i = 0; i + step < chunkCount; i += 2 * step) {
+                partials[i] += partials[i + step];
+            }
+        }
+        *reductionDst = partials[0];
+    }
+
+    // Generate a function evaluating any number of (destination, expression) pairs.
+    template<typename... OUTPUTS_T>
+    void compile_outputs(OUTPUTS_T & ... outputs) {
         code.init(runtime.getCodeInfo());
         asmjit::Error err;
-        cc = new asmjit::X86Compiler(&code);
 
-        // Visit all nodes and figure out the function signature.
+        asmjit::X86Compiler compiler(&code);
+        cc = &compiler;
+
+        asmjit::X86Gp start = cc->newIntPtr("start");
+        asmjit::X86Gp cnt = cc->newIntPtr("cnt");
+
+        // Destinations take the first 'outputCount' arguments, then all nodes are
+        // visited to map the terminals and to number the values.
         argCount = 0;
-        map_arguments(reinterpret_exp);
+        outputCount = 0;
+        values.clear();
+        map_destinations(outputs...);
+        map_expressions(outputs...);
+        count_uses();
 
-        // Now when all arguments are already mapped, we can initialize parameters
-        asmjit::CCFunc* evaluator = cc->addFunc(asmjit::FuncSignature0<void>());
+        cc->addFunc(asmjit::FuncSignature2<void, intptr_t, intptr_t>());
+        cc->setArg(0, start);
+        cc->setArg(1, cnt);
 
-        // Initialize destination offset register
-        asmjit::X86Xmm dstReg = cc->newXmm();
+        // Initialize offset registers with addresses of the first element in range
+        init_arguments(start, sizeof(float));
 
-        eval_scalar(reinterpret_exp, dstReg);
+        asmjit::Label peel_loop_begin = cc->newLabel();
+        asmjit::Label peel_loop_end = cc->newLabel();
+        asmjit::Label reminder_loop_begin = cc->newLabel();
+        asmjit::Label exit = cc->newLabel();
 
-        asmjit::X86Mem dstOffset = cc->newInt64Const(asmjit::kConstScopeLocal, (uint64_t)dst);
-       // cc->movss(asmjit::x86::ptr(dstOffset), dstReg);
+        err = cc->cmp(cnt, SIMD_STRIDE);
+        err = cc->jl(peel_loop_end); // skip the peel loop if element count too small
 
+        err = cc->bind(peel_loop_begin);
+        {
+            // SIMD loop: evaluate all outputs first, then store them
+            asmjit::X86Ymm results[MAX_OUTPUT_COUNT];
+            for (int i = 0; i < outputCount; i++) results[i] = cc->newYmmPs();
+            eval_outputs(results, 0, outputs...);
+
+            for (int i = 0; i < outputCount; i++) {
+                err = cc->vmovaps(asmjit::x86::yword_ptr(offsetRegisters[i]), results[i]);
+            }
 
+            advance_arguments(sizeof(float)*SIMD_STRIDE);
+        }
+        err = cc->sub(cnt, SIMD_STRIDE);
+        err = cc->cmp(cnt, SIMD_STRIDE);
+        err = cc->jge(peel_loop_begin);
+        err = cc->bind(peel_loop_end);
+
+        // Check if reminder present
+        err = cc->test(cnt, cnt);
+        err = cc->jz(exit);  // Exit if no reminder
+
+        // Scalar code to handle reminder
+        err = cc->bind(reminder_loop_begin);
+        {
+            asmjit::X86Xmm results[MAX_OUTPUT_COUNT];
+            for (int i = 0; i < outputCount; i++) results[i] = cc->newXmmPs();
+            eval_outputs(results, 0, outputs...);
+
+            for (int i = 0; i < outputCount; i++) {
+                err = cc->vmovss(asmjit::x86::dword_ptr(offsetRegisters[i]), results[i]);
+            }
+
+            advance_arguments(sizeof(float));
+        }
+        err = cc->dec(cnt);
+        err = cc->jnz(reminder_loop_begin);
+
+        err = cc->bind(exit);
+        cc->ret();
         cc->endFunc(); // Close the evaluator function
 
         cc->finalize();
 
-        evaluatorFunc eval;
-        //err = runtime.add(&fun, &wrapperCode);
-        err = runtime.add(&eval, &code);
+        err = runtime.add(&evaluatorFn, &code);
         if (err) {
             assert(false);
         }
+    }
+
+    template<typename SCALAR_T, typename EXP_T, typename... REST_T>
+    void map_destinations(
+        UME::VECTOR::Vector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & dst,
+        EXP_T &,
+        REST_T & ... rest)
+    {
+        static_assert(std::is_same<SCALAR_T, float>::value, "AsmjitEvaluator generates single precision code only.");
+        static_assert(SIMD_STRIDE == 8, "AsmjitEvaluator evaluates 8-lane YMM registers only.");
+        assert(outputCount < MAX_OUTPUT_COUNT);
+
+        arguments[argCount] = (uint64_t)dst.elements;
+        offsetRegisters[argCount] = cc->newIntPtr("Dst");
+        length = dst.LENGTH();
+        argCount++;
+        outputCount++;
+        map_destinations(rest...);
+    }
+
+    void map_destinations() {}
+
+    template<typename DST_T, typename EXP_T, typename... REST_T>
+    void map_expressions(DST_T &, EXP_T & exp, REST_T & ... rest) {
+        values[map_arguments(exp)].useCount++;
+        map_expressions(rest...);
+    }
+
+    void map_expressions() {}
+
+    template<typename REG_T, typename DST_T, typename EXP_T, typename... REST_T>
+    void eval_outputs(REG_T * results, int index, DST_T &, EXP_T & exp, REST_T & ... rest) {
+        evaluate(exp, results[index]);
+        eval_outputs(results, index + 1, rest...);
+    }
+
+    template<typename REG_T>
+    void eval_outputs(REG_T *, int) {}
+
+    // Set offset registers to the element at index 'start' of every terminal
+    void init_arguments(asmjit::X86Gp & start, int elementSize) {
+        asmjit::X86Gp startOffset = cc->newIntPtr("startOffset");
+        cc->imul(startOffset, start, elementSize);
+        for (int i = 0; i < argCount; i++) {
+            cc->mov(offsetRegisters[i], arguments[i]);
+            cc->add(offsetRegisters[i], startOffset);
+        }
+        invalidate_values();
+    }
+
+    // Return the index of the argument with given base address, or -1 if not mapped.
+    template<typename SCALAR_T>
+    int find_argument(SCALAR_T * elements) {
+        for (int i = 0; i < argCount; i++) {
+            if (arguments[i] == (uint64_t)elements) return i;
+        }
+        return -1;
+    }
 
-        // Call the wrapper function
-        eval();
+    // Return the value number of a node, creating a new value if no identical node
+    // was numbered before. Operands are value numbers of the child nodes.
+    int value_number(NodeKind kind, int op0 = -1, int op1 = -1, int op2 = -1, uint64_t payload = 0) {
+        for (size_t i = 0; i < values.size(); i++) {
+            const Value & v = values[i];
+            if (v.kind == kind && v.payload == payload &&
+                v.operands[0] == op0 && v.operands[1] == op1 && v.operands[2] == op2) {
+                return int(i);
+            }
+        }
 
-        delete cc;
+        Value v;
+        v.kind = kind;
+        v.payload = payload;
+        v.operands[0] = op0;
+        v.operands[1] = op1;
+        v.operands[2] = op2;
+        v.useCount = 0;
+        v.evaluated = false;
+        values.push_back(v);
+        return int(values.size() - 1);
     }
 
+    // Count uses of every value in the DAG. Uses by the roots are counted while
+    // mapping the expressions.
+    void count_uses() {
+        for (size_t i = 0; i < values.size(); i++) {
+            for (int j = 0; j < 3; j++) {
+                if (values[i].operands[j] >= 0) values[values[i].operands[j]].useCount++;
+            }
+        }
+    }
+
+    // Cached values are reused by all occurrences of a node in one loop iteration.
+    // They become invalid when offset registers are advanced.
+    void invalidate_values() {
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i].evaluated = false;
+        }
+    }
+
+public:
+    // Map terminals of an expression and return the value number of its root node.
+    // Structurally identical subtrees get the same value number, so the mapping can
+    // be repeated during code generation to find cached values of already evaluated nodes.
     template<typename SCALAR_T>
-    UME_FORCE_INLINE void map_arguments(UME::VECTOR::Scalar<SCALAR_T, SIMD_STRIDE> exp)
+    int map_arguments(UME::VECTOR::Scalar<SCALAR_T, SIMD_STRIDE> & exp)
     {
-        // Do nothing. The value can be bound at the moment of scalar evaluation.
+        // Scalars are not mapped to arguments. The value is bound at the moment of scalar evaluation.
+        uint32_t bits;
+        std::memcpy(&bits, &exp._e1, sizeof(bits));
+        return value_number(NODE_SCALAR, -1, -1, -1, bits);
     }
 
     template<typename SCALAR_T>
-    UME_FORCE_INLINE void map_arguments(UME::VECTOR::FloatVector<SCALAR_T, VEC_LEN, SIMD_STRIDE> exp)
+    int map_arguments(UME::VECTOR::FloatVector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & exp)
     {
-        // We have to register every terminal to get proper initial values.
-        // remember the terminal address
-        arguments[argCount] = (uint64_t)exp.elements;
-        // allocate an offset register
-        offsetRegisters[argCount] = cc->newIntPtr();
-        argCount++;
+        // Every distinct terminal address (including destinations) is registered once
+        // and gets a single offset register.
+        int id = find_argument(exp.elements);
+        if (id < 0) {
+            assert(argCount < MAX_ARG_COUNT);
+            id = argCount;
+            arguments[argCount] = (uint64_t)exp.elements;
+            length = exp.LENGTH();
+            offsetRegisters[argCount] = cc->newIntPtr();
+            argCount++;
+        }
+        return value_number(NODE_VECTOR, -1, -1, -1, id);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_ADD, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_MUL, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_SUB, e1, e2);
     }
 
     template<typename SCALAR_T, typename E1, typename E2>
-    UME_FORCE_INLINE void map_arguments(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE, E1, E2> exp)
+    int map_arguments(UME::VECTOR::ArithmeticDIVExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
     {
-        // No need to mapp an ADD node. Map children in left-to-right order.
-        map_arguments(exp._e1);
-        map_arguments(exp._e2);
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_DIV, e1, e2);
     }
 
     template<typename SCALAR_T, typename E1, typename E2>
-    UME_FORCE_INLINE void map_arguments(UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> exp)
+    int map_arguments(UME::VECTOR::ArithmeticMINExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_MIN, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::ArithmeticMAXExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_MAX, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_SQRT, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticRCPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_RCP, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticRSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_RSQRT, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticEXPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
     {
-        map_arguments(exp._e1);
-        map_arguments(exp._e2);
+        return value_number(NODE_EXP, map_arguments(exp._e1));
     }
 
     template<typename SCALAR_T, typename E1>
-    UME_FORCE_INLINE void map_arguments(UME::VECTOR::ArithmeticHADDExpression<SCALAR_T, SIMD_STRIDE, E1> exp)
+    int map_arguments(UME::VECTOR::ArithmeticLOGExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
     {
-        map_arguments(exp._e1);
+        return value_number(NODE_LOG, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticSINExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_SIN, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticCOSExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_COS, map_arguments(exp._e1));
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPEQExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPEQ, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPNEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPNE, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPLTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPLT, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPLEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPLE, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPGTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPGT, e1, e2);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    int map_arguments(UME::VECTOR::LogicalCMPGEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        return value_number(NODE_CMPGE, e1, e2);
+    }
+
+    // BLEND: '_e1' is the source, '_e2' is the mask and '_e3' is the value
+    // taken for lanes with mask set.
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    int map_arguments(UME::VECTOR::ArithmeticBLENDExpression<SCALAR_T, SIMD_STRIDE, E1, E2, E3> & exp)
+    {
+        int e1 = map_arguments(exp._e1);
+        int e2 = map_arguments(exp._e2);
+        int e3 = map_arguments(exp._e3);
+        return value_number(NODE_BLEND, e1, e2, e3);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    int map_arguments(UME::VECTOR::ArithmeticHADDExpression<SCALAR_T, SIMD_STRIDE, E1> & exp)
+    {
+        return value_number(NODE_HADD, map_arguments(exp._e1));
     }
 
     // TODO: we need a dispatch to make differentiation between SIMD strides and register mappings
@@ -250,35 +737,20 @@ public:
 
     template<typename SCALAR_T>
     UME_FORCE_INLINE void eval_simd(UME::VECTOR::FloatVector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & exp, asmjit::X86Ymm & dst) {
-        // 1. Find the offset register from mapping
-        int id = -1;
-        for (int i = 0; i < argCount; i++) {
-            if (arguments[i] == (uint64_t)exp.elements) {
-                id = i;
-                break;
-            }
-        }
+        // Find the offset register from mapping
+        int id = find_argument(exp.elements);
         assert(id >= 0);
 
-        // 2. Add a load operation to the operation list
         auto err = cc->vmovaps(dst, asmjit::x86::yword_ptr(offsetRegisters[id]));
         assert(err == 0);
     }
 
     template<typename SCALAR_T>
-    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::FloatVector<SCALAR_T, VEC_LEN, SIMD_STRIDE> exp, asmjit::X86Xmm & dst) {
-        // 1. Find the offset register from mapping
-        int id = -1;
-        for (int i = 0; i < argCount; i++) {
-            if (arguments[i] == (uint64_t)exp.elements) {
-                id = i;
-                break;
-            }
-        }
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::FloatVector<SCALAR_T, VEC_LEN, SIMD_STRIDE> & exp, asmjit::X86Xmm & dst) {
+        int id = find_argument(exp.elements);
         assert(id >= 0);
 
-        // 2. Add a load operation to the operation list
-        auto err = cc->movss(dst, asmjit::x86::ptr(offsetRegisters[id]));
+        auto err = cc->vmovss(dst, asmjit::x86::dword_ptr(offsetRegisters[id]));
         assert(err == 0);
     }
 
@@ -293,8 +765,8 @@ public:
     UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
         asmjit::X86Ymm t0 = cc->newYmmPs();
         asmjit::X86Ymm t1 = cc->newYmmPs();
-        eval_simd(exp._e1, t0);
-        eval_simd(exp._e2, t1);
+        evaluate(exp._e1, t0);
+        evaluate(exp._e2, t1);
 
         auto err = cc->vaddps(dst, t0, t1);
         assert(err == 0);
@@ -304,8 +776,8 @@ public:
     UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
         asmjit::X86Xmm t0 = cc->newXmmPs();
         asmjit::X86Xmm t1 = cc->newXmmPs();
-        eval_scalar(exp._e1, t0);
-        eval_scalar(exp._e2, t1);
+        evaluate(exp._e1, t0);
+        evaluate(exp._e2, t1);
 
         auto err = cc->vaddps(dst, t0, t1);
         assert(err == 0);
@@ -315,8 +787,8 @@ public:
     UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
         asmjit::X86Ymm t0 = cc->newYmmPs();
         asmjit::X86Ymm t1 = cc->newYmmPs();
-        eval_simd(exp._e1, t0);
-        eval_simd(exp._e2, t1);
+        evaluate(exp._e1, t0);
+        evaluate(exp._e2, t1);
 
         auto err = cc->vmulps(dst, t0, t1);
         assert(err == 0);
@@ -327,81 +799,654 @@ public:
     UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
         asmjit::X86Xmm t0 = cc->newXmmPs();
         asmjit::X86Xmm t1 = cc->newXmmPs();
-        eval_scalar(exp._e1, t0);
-        eval_scalar(exp._e2, t1);
+        evaluate(exp._e1, t0);
+        evaluate(exp._e2, t1);
 
         auto err = cc->vmulps(dst, t0, t1);
         assert(err == 0);
     }
 
+    // Basic arithmetic. Operands are evaluated into temporaries and combined with
+    // a single VEX instruction, which is identical for both YMM and XMM registers.
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVsubps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVsubps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticDIVExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVdivps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticDIVExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVdivps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticMINExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVminps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticMINExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVminps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticMAXExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVmaxps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticMAXExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_binary(asmjit::X86Inst::kIdVmaxps, exp._e1, exp._e2, dst);
+    }
+
+    // Fused multiply-add patterns. These overloads are more specialized than the
+    // generic ADD/SUB ones, so the compiler selects them whenever one of the operands
+    // is a MUL node. Both operands being MUL nodes needs a separate overload to
+    // resolve the ambiguity.
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>, E3> & exp, asmjit::X86Ymm & dst) {
+        // a*b + c
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>, E3> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        E1, UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E2, E3>> & exp, asmjit::X86Ymm & dst) {
+        // c + a*b
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e2, exp._e1, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        E1, UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E2, E3>> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e2, exp._e1, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3, typename E4>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E3, E4>> & exp, asmjit::X86Ymm & dst) {
+        // a*b + c*d: only the first product is fused.
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3, typename E4>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticADDExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E3, E4>> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfmadd231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>, E3> & exp, asmjit::X86Ymm & dst) {
+        // a*b - c
+        emit_fused(asmjit::X86Inst::kIdVfmsub231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>, E3> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfmsub231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        E1, UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E2, E3>> & exp, asmjit::X86Ymm & dst) {
+        // c - a*b
+        emit_fused(asmjit::X86Inst::kIdVfnmadd231ps, exp._e2, exp._e1, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        E1, UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E2, E3>> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfnmadd231ps, exp._e2, exp._e1, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3, typename E4>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E3, E4>> & exp, asmjit::X86Ymm & dst) {
+        // a*b - c*d
+        emit_fused(asmjit::X86Inst::kIdVfmsub231ps, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3, typename E4>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSUBExpression<SCALAR_T, SIMD_STRIDE,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2>,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E3, E4>> & exp, asmjit::X86Xmm & dst) {
+        emit_fused(asmjit::X86Inst::kIdVfmsub231ps, exp._e1, exp._e2, dst);
+    }
+
+    // Unary operations
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        evaluate(exp._e1, dst);
+        auto err = cc->vsqrtps(dst, dst);
+        assert(err == 0);
+    }
+
     template<typename SCALAR_T, typename E1>
-    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticHADDExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
-        /*
-        asmjit::X86Gp cnt = cc->newInt32("cnt");
-        asmjit::X86Gp t0 = cc->newInt64Const(asmjit::kConstScopeLocal, exp.LENGTH());
-        cc->mov(cnt, t0);
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        evaluate(exp._e1, dst);
+        auto err = cc->vsqrtps(dst, dst);
+        assert(err == 0);
+    }
 
-        asmjit::Label peel_loop_begin = cc->newLabel();
-        asmjit::Label peel_loop_end = cc->newLabel();
-        asmjit::Label reminder_loop_begin = cc->newLabel();
-        asmjit::Label reminder_loop_end = cc->newLabel();
-        asmjit::Label exit = cc->newLabel();
+    // RCP and RSQRT are computed with full precision division. 'vrcpps' and 'vrsqrtps'
+    // only give 12 bits of precision which would not match UME::VECTOR results.
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticRCPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        emit_rcp(exp._e1, dst);
+    }
 
-        asmjit::X86Ymm partial_sum_vec = cc->newYmmPs(); // Intermediate result
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticRCPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        emit_rcp(exp._e1, dst);
+    }
 
-        err = cc->cmp(cnt, SIMD_STRIDE);
-        err = cc->jl(peel_loop_end); // skip the peel loop if element count too small
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticRSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        emit_rsqrt(exp._e1, dst);
+    }
 
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticRSQRTExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        emit_rsqrt(exp._e1, dst);
+    }
 
-        err = cc->bind(peel_loop_begin);
-        {
-            // SIMD loop
-            asmjit::X86Ymm partial_vec = cc->newYmmPs();
-            eval_simd(reinterpret_exp, partial_vec);
-
-            err = cc->vaddps(partial_sum_vec, partial_sum_vec, partial_vec);
-
-            // TODO: we should advance only children sources!
-            // Advance loop
-            //    Advance destination register
-            err = cc->add(offsetRegisters[0], sizeof(SCALAR_T)*SIMD_STRIDE);
-            //    Advance other registers
-            for (int i = 1; i < argCount; i++)
-            {
-                cc->add(offsetRegisters[i], sizeof(SCALAR_T)*SIMD_STRIDE);
-            }
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticEXPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        asmjit::X86Ymm t0 = cc->newYmmPs();
+        evaluate(exp._e1, t0);
+        emit_exp(t0, dst);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticEXPExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        asmjit::X86Xmm t0 = cc->newXmmPs();
+        evaluate(exp._e1, t0);
+        emit_exp(t0, dst);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticLOGExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        asmjit::X86Ymm t0 = cc->newYmmPs();
+        evaluate(exp._e1, t0);
+        emit_log(t0, dst);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticLOGExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        asmjit::X86Xmm t0 = cc->newXmmPs();
+        evaluate(exp._e1, t0);
+        emit_log(t0, dst);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticSINExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        asmjit::X86Ymm t0 = cc->newYmmPs();
+        evaluate(exp._e1, t0);
+        emit_sincos(t0, dst, false);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticSINExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        asmjit::X86Xmm t0 = cc->newXmmPs();
+        evaluate(exp._e1, t0);
+        emit_sincos(t0, dst, false);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticCOSExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Ymm & dst) {
+        asmjit::X86Ymm t0 = cc->newYmmPs();
+        evaluate(exp._e1, t0);
+        emit_sincos(t0, dst, true);
+    }
+
+    template<typename SCALAR_T, typename E1>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticCOSExpression<SCALAR_T, SIMD_STRIDE, E1> & exp, asmjit::X86Xmm & dst) {
+        asmjit::X86Xmm t0 = cc->newXmmPs();
+        evaluate(exp._e1, t0);
+        emit_sincos(t0, dst, true);
+    }
+
+    // Comparisons produce a lane mask (all bits set or cleared) in a regular vector
+    // register. The mask can only be consumed by a BLEND node.
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPEQExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpEQ_OQ, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPEQExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpEQ_OQ, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPNEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpNEQ_UQ, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPNEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpNEQ_UQ, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPLTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpLT_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPLTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpLT_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPLEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpLE_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPLEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpLE_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPGTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpGT_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPGTExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpGT_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::LogicalCMPGEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Ymm & dst) {
+        emit_compare(asmjit::x86::kVCmpGE_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::LogicalCMPGEExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, asmjit::X86Xmm & dst) {
+        emit_compare(asmjit::x86::kVCmpGE_OS, exp._e1, exp._e2, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_simd(UME::VECTOR::ArithmeticBLENDExpression<SCALAR_T, SIMD_STRIDE, E1, E2, E3> & exp, asmjit::X86Ymm & dst) {
+        emit_blend(exp._e1, exp._e2, exp._e3, dst);
+    }
+
+    template<typename SCALAR_T, typename E1, typename E2, typename E3>
+    UME_FORCE_INLINE void eval_scalar(UME::VECTOR::ArithmeticBLENDExpression<SCALAR_T, SIMD_STRIDE, E1, E2, E3> & exp, asmjit::X86Xmm & dst) {
+        emit_blend(exp._e1, exp._e2, exp._e3, dst);
+    }
+
+    // Dispatch evaluation based on the register type. This allows code emitters
+    // below to be shared between the SIMD (YMM) and the scalar (XMM) code paths.
+    //
+    // Values with more than one use are evaluated into a register on first use and
+    // copied on every use, as emitters are allowed to clobber 'dst'. Scalars are not
+    // cached: reading the constant pool is as cheap as a copy and does not keep a
+    // register alive.
+    template<typename EXP_T>
+    UME_FORCE_INLINE void evaluate(EXP_T & exp, asmjit::X86Ymm & dst) {
+        int id = map_arguments(exp);
+        bool shared = values[id].useCount > 1 && values[id].kind != NODE_SCALAR;
+        if (shared && values[id].evaluated) {
+            auto err = cc->vmovaps(dst, values[id].simd);
+            assert(err == 0);
+            return;
         }
-        err = cc->add(cnt, -(int)SIMD_STRIDE);
-        err = cc->cmp(cnt, SIMD_STRIDE);
-        err = cc->jge(peel_loop_begin);
-        err = cc->bind(peel_loop_end);
 
-        // Check if reminder present
-        err = cc->test(cnt, cnt);
-        err = cc->jz(exit);  // Exit if no reminder
+        // Single call site, so that inlining does not duplicate the subtree.
+        asmjit::X86Ymm t0 = shared ? cc->newYmmPs() : dst;
+        eval_simd(exp, t0);
+        if (shared) {
+            values[id].simd = t0;
+            values[id].evaluated = true;
+            auto err = cc->vmovaps(dst, t0);
+            assert(err == 0);
+        }
+    }
 
-                             // Scalar code to handle reminder
-        err = cc->bind(reminder_loop_begin);
-        {
-            // scalar loop
-            asmjit::X86Xmm dst = cc->newXmmPs();
-            eval_scalar(reinterpret_exp, dst);
-
-            err = cc->movss(asmjit::x86::ptr(offsetRegisters[0]), dst);
-
-            // Advance loop
-            //    Advance destination register
-            err = cc->add(offsetRegisters[0], sizeof(SCALAR_T));
-            //    Advance other registers
-            for (int i = 1; i < argCount; i++)
-            {
-                cc->add(offsetRegisters[i], sizeof(SCALAR_T));
-            }
+    template<typename EXP_T>
+    UME_FORCE_INLINE void evaluate(EXP_T & exp, asmjit::X86Xmm & dst) {
+        int id = map_arguments(exp);
+        bool shared = values[id].useCount > 1 && values[id].kind != NODE_SCALAR;
+        if (shared && values[id].evaluated) {
+            auto err = cc->vmovaps(dst, values[id].scalar);
+            assert(err == 0);
+            return;
         }
-        err = cc->dec(cnt);
-        err = cc->jnz(reminder_loop_begin);
 
-        err = cc->bind(exit);
-        cc->ret();*/
+        // Single call site, so that inlining does not duplicate the subtree.
+        asmjit::X86Xmm t0 = shared ? cc->newXmmPs() : dst;
+        eval_scalar(exp, t0);
+        if (shared) {
+            values[id].scalar = t0;
+            values[id].evaluated = true;
+            auto err = cc->vmovaps(dst, t0);
+            assert(err == 0);
+        }
+    }
+
+    // Broadcast constants, located in the global constant pool.
+    UME_FORCE_INLINE asmjit::X86Mem float_constant(asmjit::X86Ymm &, float value) {
+        return cc->newYmmConst(asmjit::kConstScopeGlobal, asmjit::Data256::fromF32(value));
+    }
+
+    UME_FORCE_INLINE asmjit::X86Mem float_constant(asmjit::X86Xmm &, float value) {
+        return cc->newXmmConst(asmjit::kConstScopeGlobal, asmjit::Data128::fromF32(value));
+    }
+
+    UME_FORCE_INLINE asmjit::X86Mem int_constant(asmjit::X86Ymm &, int32_t value) {
+        return cc->newYmmConst(asmjit::kConstScopeGlobal, asmjit::Data256::fromI32(value));
+    }
+
+    UME_FORCE_INLINE asmjit::X86Mem int_constant(asmjit::X86Xmm &, int32_t value) {
+        return cc->newXmmConst(asmjit::kConstScopeGlobal, asmjit::Data128::fromI32(value));
+    }
+
+    template<typename E1, typename E2, typename REG_T>
+    UME_FORCE_INLINE void emit_binary(uint32_t instId, E1 & e1, E2 & e2, REG_T & dst) {
+        REG_T t0 = cc->newSimilarReg(dst);
+        REG_T t1 = cc->newSimilarReg(dst);
+        evaluate(e1, t0);
+        evaluate(e2, t1);
+
+        auto err = cc->emit(instId, dst, t0, t1);
+        assert(err == 0);
+    }
+
+    // Emit one of 'vf[n]m{add|sub}231ps' instructions: dst = +/-(a*b) +/- c
+    //
+    // A product that is also used elsewhere is not fused. It is taken from the value
+    // cache instead and combined with 'c' using a plain add or subtract. This is not
+    // force-inlined, as the two paths would otherwise duplicate the generator code.
+    template<typename SCALAR_T, typename E1, typename E2, typename E3, typename REG_T>
+    void emit_fused(uint32_t instId,
+        UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & product, E3 & c, REG_T & dst)
+    {
+        REG_T t0 = cc->newSimilarReg(dst);
+        REG_T t1 = cc->newSimilarReg(dst);
+        asmjit::Error err;
+
+        if (values[map_arguments(product)].useCount > 1) {
+            evaluate(product, t0);
+            evaluate(c, dst);
+            if (instId == asmjit::X86Inst::kIdVfmadd231ps) err = cc->vaddps(dst, dst, t0);
+            else if (instId == asmjit::X86Inst::kIdVfmsub231ps) err = cc->vsubps(dst, t0, dst);
+            else err = cc->vsubps(dst, dst, t0);
+            assert(err == 0);
+            return;
+        }
+
+        evaluate(product._e1, t0);
+        evaluate(product._e2, t1);
+        evaluate(c, dst);
+
+        err = cc->emit(instId, dst, t0, t1);
+        assert(err == 0);
+    }
+
+    template<typename E1, typename REG_T>
+    UME_FORCE_INLINE void emit_rcp(E1 & e1, REG_T & dst) {
+        REG_T t0 = cc->newSimilarReg(dst);
+        evaluate(e1, t0);
+
+        auto err = cc->vmovaps(dst, float_constant(dst, 1.0f));
+        assert(err == 0);
+        err = cc->vdivps(dst, dst, t0);
+        assert(err == 0);
+    }
+
+    template<typename E1, typename REG_T>
+    UME_FORCE_INLINE void emit_rsqrt(E1 & e1, REG_T & dst) {
+        REG_T t0 = cc->newSimilarReg(dst);
+        evaluate(e1, t0);
+
+        auto err = cc->vsqrtps(t0, t0);
+        assert(err == 0);
+        err = cc->vmovaps(dst, float_constant(dst, 1.0f));
+        assert(err == 0);
+        err = cc->vdivps(dst, dst, t0);
+        assert(err == 0);
+    }
+
+    template<typename E1, typename E2, typename REG_T>
+    UME_FORCE_INLINE void emit_compare(uint32_t predicate, E1 & e1, E2 & e2, REG_T & dst) {
+        REG_T t0 = cc->newSimilarReg(dst);
+        REG_T t1 = cc->newSimilarReg(dst);
+        evaluate(e1, t0);
+        evaluate(e2, t1);
+
+        auto err = cc->vcmpps(dst, t0, t1, predicate);
+        assert(err == 0);
+    }
+
+    template<typename E1, typename E2, typename E3, typename REG_T>
+    UME_FORCE_INLINE void emit_blend(E1 & src, E2 & mask, E3 & b, REG_T & dst) {
+        REG_T t0 = cc->newSimilarReg(dst);
+        REG_T t1 = cc->newSimilarReg(dst);
+        REG_T t2 = cc->newSimilarReg(dst);
+        evaluate(src, t0);
+        evaluate(mask, t1);
+        evaluate(b, t2);
+
+        // Lanes with mask bit set are taken from 'b'
+        auto err = cc->vblendvps(dst, t0, t2, t1);
+        assert(err == 0);
+    }
+
+    // Cephes 'expf' algorithm: exp(x) = 2^n * exp(r), where |r| <= ln(2)/2.
+    // 'x' is clobbered.
+    template<typename REG_T>
+    UME_FORCE_INLINE void emit_exp(REG_T & x, REG_T & dst) {
+        REG_T fx = cc->newSimilarReg(x);
+        REG_T z = cc->newSimilarReg(x);
+        REG_T n = cc->newSimilarReg(x);
+
+        cc->vminps(x, x, float_constant(x, 88.3762626647949f));
+        cc->vmaxps(x, x, float_constant(x, -88.3762626647949f));
+
+        // n = floor(x * log2(e) + 0.5)
+        cc->vmovaps(fx, float_constant(x, 1.44269504088896341f));
+        cc->vfmadd213ps(fx, x, float_constant(x, 0.5f));
+        cc->vroundps(fx, fx, asmjit::x86::kRoundDown | asmjit::x86::kRoundInexact);
+
+        // r = x - n * ln(2), with ln(2) split into two parts for extra precision
+        cc->vfnmadd231ps(x, fx, float_constant(x, 0.693359375f));
+        cc->vfnmadd231ps(x, fx, float_constant(x, -2.12194440e-4f));
+
+        cc->vmulps(z, x, x);
+        cc->vmovaps(dst, float_constant(x, 1.9875691500E-4f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 1.3981999507E-3f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 8.3334519073E-3f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 4.1665795894E-2f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 1.6666665459E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 5.0000001201E-1f));
+        cc->vfmadd213ps(dst, z, x);
+        cc->vaddps(dst, dst, float_constant(x, 1.0f));
+
+        // Build 2^n directly in the exponent field
+        cc->vcvttps2dq(n, fx);
+        cc->vpaddd(n, n, int_constant(x, 0x7f));
+        cc->vpslld(n, n, 23);
+        auto err = cc->vmulps(dst, dst, n);
+        assert(err == 0);
+    }
+
+    // Cephes 'logf' algorithm: log(x) = e*ln(2) + log(m), where m is in [sqrt(0.5), sqrt(2)).
+    // Negative and NaN inputs return NaN, zero returns -inf. 'x' is clobbered.
+    template<typename REG_T>
+    UME_FORCE_INLINE void emit_log(REG_T & x, REG_T & dst) {
+        REG_T invalid = cc->newSimilarReg(x);
+        REG_T zero = cc->newSimilarReg(x);
+        REG_T e = cc->newSimilarReg(x);
+        REG_T mask = cc->newSimilarReg(x);
+        REG_T t0 = cc->newSimilarReg(x);
+        REG_T z = cc->newSimilarReg(x);
+
+        cc->vxorps(zero, zero, zero);
+        cc->vcmpps(invalid, x, zero, asmjit::x86::kVCmpNGE_UQ);
+        cc->vcmpps(zero, x, zero, asmjit::x86::kVCmpEQ_OQ);
+        // Cut off denormals
+        cc->vmaxps(x, x, float_constant(x, 1.17549435e-38f));
+
+        // Split into exponent and mantissa in [0.5, 1)
+        cc->vpsrld(e, x, 23);
+        cc->vandps(x, x, int_constant(x, ~0x7f800000));
+        cc->vorps(x, x, float_constant(x, 0.5f));
+        cc->vpsubd(e, e, int_constant(x, 0x7f));
+        cc->vcvtdq2ps(e, e);
+        cc->vaddps(e, e, float_constant(x, 1.0f));
+
+        // if (m < sqrt(0.5)) { e -= 1; x = x + x - 1.0; } else { x = x - 1.0; }
+        cc->vcmpps(mask, x, float_constant(x, 0.707106781186547524f), asmjit::x86::kVCmpLT_OS);
+        cc->vandps(t0, mask, x);
+        cc->vsubps(x, x, float_constant(x, 1.0f));
+        cc->vandps(mask, mask, float_constant(x, 1.0f));
+        cc->vsubps(e, e, mask);
+        cc->vaddps(x, x, t0);
+
+        cc->vmulps(z, x, x);
+        cc->vmovaps(dst, float_constant(x, 7.0376836292E-2f));
+        cc->vfmadd213ps(dst, x, float_constant(x, -1.1514610310E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 1.1676998740E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, -1.2420140846E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 1.4249322787E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, -1.6668057665E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 2.0000714765E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, -2.4999993993E-1f));
+        cc->vfmadd213ps(dst, x, float_constant(x, 3.3333331174E-1f));
+        cc->vmulps(dst, dst, x);
+        cc->vmulps(dst, dst, z);
+
+        cc->vfmadd231ps(dst, e, float_constant(x, -2.12194440e-4f));
+        cc->vfnmadd231ps(dst, z, float_constant(x, 0.5f));
+        cc->vaddps(dst, dst, x);
+        cc->vfmadd231ps(dst, e, float_constant(x, 0.693359375f));
+
+        cc->vorps(dst, dst, invalid);
+        auto err = cc->vblendvps(dst, dst, float_constant(x, -std::numeric_limits<float>::infinity()), zero);
+        assert(err == 0);
+    }
+
+    // Cephes 'sinf'/'cosf' algorithm. The argument is reduced to [-pi/4, pi/4] using
+    // extended precision modular arithmetic, which is accurate for |x| < 8192.
+    // 'x' is clobbered.
+    template<typename REG_T>
+    UME_FORCE_INLINE void emit_sincos(REG_T & x, REG_T & dst, bool cosine) {
+        REG_T sign = cc->newSimilarReg(x);
+        REG_T y = cc->newSimilarReg(x);
+        REG_T j = cc->newSimilarReg(x);
+        REG_T polyMask = cc->newSimilarReg(x);
+        REG_T z = cc->newSimilarReg(x);
+        REG_T y2 = cc->newSimilarReg(x);
+
+        if (!cosine) {
+            // sin(-x) = -sin(x)
+            cc->vandps(sign, x, int_constant(x, int32_t(0x80000000)));
+        }
+        cc->vandps(x, x, int_constant(x, 0x7fffffff));
+
+        // j = (int(x * 4/pi) + 1) & ~1
+        cc->vmulps(y, x, float_constant(x, 1.27323954473516f));
+        cc->vcvttps2dq(j, y);
+        cc->vpaddd(j, j, int_constant(x, 1));
+        cc->vpand(j, j, int_constant(x, ~1));
+        cc->vcvtdq2ps(y, j);
+
+        if (cosine) {
+            cc->vpsubd(j, j, int_constant(x, 2));
+            // Swap sign flag: (~j & 4) << 29
+            cc->vpandn(sign, j, int_constant(x, 4));
+            cc->vpslld(sign, sign, 29);
+        }
+        else {
+            // Swap sign flag: (j & 4) << 29
+            cc->vpand(polyMask, j, int_constant(x, 4));
+            cc->vpslld(polyMask, polyMask, 29);
+            cc->vxorps(sign, sign, polyMask);
+        }
+
+        // Select the polynomial: sine for (j & 2) == 0, cosine otherwise
+        cc->vpand(polyMask, j, int_constant(x, 2));
+        cc->vpxor(z, z, z);
+        cc->vpcmpeqd(polyMask, polyMask, z);
+
+        // Extended precision modular arithmetic: x = ((x - y*DP1) - y*DP2) - y*DP3
+        cc->vfmadd231ps(x, y, float_constant(x, -0.78515625f));
+        cc->vfmadd231ps(x, y, float_constant(x, -2.4187564849853515625e-4f));
+        cc->vfmadd231ps(x, y, float_constant(x, -3.77489497744594108e-8f));
+
+        cc->vmulps(z, x, x);
+
+        // Cosine polynomial
+        cc->vmovaps(y, float_constant(x, 2.443315711809948E-005f));
+        cc->vfmadd213ps(y, z, float_constant(x, -1.388731625493765E-003f));
+        cc->vfmadd213ps(y, z, float_constant(x, 4.166664568298827E-002f));
+        cc->vmulps(y, y, z);
+        cc->vmulps(y, y, z);
+        cc->vfnmadd231ps(y, z, float_constant(x, 0.5f));
+        cc->vaddps(y, y, float_constant(x, 1.0f));
+
+        // Sine polynomial
+        cc->vmovaps(y2, float_constant(x, -1.9515295891E-4f));
+        cc->vfmadd213ps(y2, z, float_constant(x, 8.3321608736E-3f));
+        cc->vfmadd213ps(y2, z, float_constant(x, -1.6666654611E-1f));
+        cc->vmulps(y2, y2, z);
+        cc->vfmadd213ps(y2, x, x);
+
+        cc->vblendvps(dst, y, y2, polyMask);
+        auto err = cc->vxorps(dst, dst, sign);
+        assert(err == 0);
+    }
+
+    // Add value of an expression to the accumulator register.
+    template<typename EXP_T, typename REG_T>
+    UME_FORCE_INLINE void accumulate(EXP_T & exp, REG_T & acc) {
+        REG_T t0 = cc->newSimilarReg(acc);
+        evaluate(exp, t0);
+
+        auto err = cc->vaddps(acc, acc, t0);
+        assert(err == 0);
+    }
+
+    // Reduced products (e.g. dot product) are accumulated with a single FMA.
+    template<typename SCALAR_T, typename E1, typename E2, typename REG_T>
+    UME_FORCE_INLINE void accumulate(UME::VECTOR::ArithmeticMULExpression<SCALAR_T, SIMD_STRIDE, E1, E2> & exp, REG_T & acc) {
+        REG_T t0 = cc->newSimilarReg(acc);
+        REG_T t1 = cc->newSimilarReg(acc);
+        evaluate(exp._e1, t0);
+        evaluate(exp._e2, t1);
+
+        auto err = cc->vfmadd231ps(acc, t0, t1);
+        assert(err == 0);
+    }
+
+    UME_FORCE_INLINE void advance_arguments(int byteCount) {
+        for (int i = 0; i < argCount; i++) {
+            cc->add(offsetRegisters[i], byteCount);
+        }
+        invalidate_values();
     }
 };
@@ -10,6 +10,7 @@
 #include "TimingStatistics.h"
 
 #include <list>
+#include <utility>
 
 #include "../utilities/ttmath/ttmath/ttmath.h"
 #include <tclap/CmdLine.h>
@@ -70,6 +71,17 @@ public:
     // Optional Init and Cleanup are not measured with 'benchmarked code'
     UME_NEVER_INLINE virtual void optional_init() {}
     UME_NEVER_INLINE virtual void optional_cleanup() {}
+
+    // Called once before the first and after the last iteration of the test, for
+    // state kept by all iterations (e.g. thread affinity). Not measured.
+    UME_NEVER_INLINE virtual void test_init() {}
+    UME_NEVER_INLINE virtual void test_cleanup() {}
+
+    // Optional results derived from the measured time (e.g. bandwidth), reported
+    // next to it. They are kept out of the test identifier, which is also the
+    // test name in JSON output.
+    typedef std::list<std::pair<std::string, double>> TestMetrics;
+    UME_NEVER_INLINE virtual TestMetrics get_test_metrics() { return TestMetrics(); }
 };
 
 // Test category represents all tests with directly comparable results.
@@ -112,6 +124,10 @@ private:
     bool displayTestInfo;
     bool displayCategoriesInfo;
     bool outputJSON;
+    // When set, results of the last iteration of every test are verified, so that
+    // the reported error is available. Verification is not measured, but it can take
+    // much longer than the benchmarked code.
+    bool verifyResults;
 
     bool outputToFile;
     std::string outputFile;
@@ -134,6 +150,7 @@ public:
         displayTestInfo(false),
         displayCategoriesInfo(false),
         outputJSON(false),
+        verifyResults(false),
         outputToFile(false),
         outputFile(""),
         outputStream(std::cout)
@@ -147,6 +164,7 @@ public:
         displayTestInfo(false),
         displayCategoriesInfo(false),
         outputJSON(false),
+        verifyResults(false),
         outputToFile(false),
         outputFile(""),
         outputStream(std::cout)
@@ -163,6 +181,9 @@ public:
         TCLAP::SwitchArg outputJSONFlag("j", "json", "Present output in JSON format");
         cmd->add(outputJSONFlag);
 
+        TCLAP::SwitchArg verifyFlag("v", "verify", "Verify results and report the error (slow)");
+        cmd->add(verifyFlag);
+
         TCLAP::ValueArg<std::string> outputFileNameFlag("o", "output", "Set output file name.", false, "","file_name");
         cmd->add(outputFileNameFlag);
 
@@ -185,6 +206,10 @@ public:
             outputJSON = true;
         }
 
+        if (verifyFlag.getValue()) {
+            verifyResults = true;
+        }
+
         if (outputFileNameFlag.getValue() != "") {
             outputToFile = true;
             outputFile = outputFileNameFlag.getValue();
@@ -221,6 +246,8 @@ public:
 
         int iterations = test->iterationOverrider > 0 ? test->iterationOverrider : RUNS;
 
+        test->test_init();
+
         for (int i = 0; i < iterations; i++) {
 
             // Initialization phase is skipped, as the
@@ -240,10 +267,30 @@ public:
             test->optional_cleanup();
 
             //test->verify();
+            if (verifyResults && i == iterations - 1) {
+                test->verify();
+            }
             test->cleanup();
 
             test->stats.update(end - start);
         }
+
+        test->test_cleanup();
+    }
+
+    // Formats 'get_test_metrics()' as additional JSON fields or as a text suffix.
+    std::string metricsToString(Test* test, bool json) {
+        std::string retval = "";
+        Test::TestMetrics metrics = test->get_test_metrics();
+        for (auto iter = metrics.begin(); iter != metrics.end(); iter++) {
+            if (json) {
+                retval += ", \"" + iter->first + "\" : \"" + std::to_string(iter->second) + "\"";
+            }
+            else {
+                retval += ", " + iter->first + ": " + std::to_string(iter->second);
+            }
+        }
+        return retval;
     }
 
     void runAllTests(int RUNS) {
@@ -292,9 +339,11 @@ public:
                 outputString += "\n  \"tests\" : [ ";
             }
 
+            int categoryRuns = cat->iterationOverrider > 0 ? cat->iterationOverrider : RUNS;
+
             for (auto testIter = cat->tests.begin(); testIter != cat->tests.end(); testIter++)
             {
-                runSingleTest(*testIter, RUNS);
+                runSingleTest(*testIter, categoryRuns);
 
                 if (outputJSON) {
                     // Make sure tests are comma separated.
@@ -306,7 +355,8 @@ public:
                     outputString += "\n   { \"name\" : \"" + (*testIter)->get_test_identifier()
                         + "\", \"elapsed\" : \"" + std::to_string((unsigned long long) (*testIter)->stats.getAverage())
                         + "\", \"stdDev\" : \"" + std::to_string((unsigned long long) (*testIter)->stats.getStdDev())
-                        + "\", \"error\" : \"" + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + "\"}";
+                        + "\", \"error\" : \"" + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + "\""
+                        + metricsToString(*testIter, true) + "}";
                     //std::cout << std::flush;
                 }
                 else {
@@ -314,7 +364,8 @@ public:
                         outputString += (*testIter)->get_test_identifier()
                             + " Elapsed: " + std::to_string((unsigned long long) (*testIter)->stats.getAverage())
                             + " (dev: " + std::to_string((unsigned long long) (*testIter)->stats.getStdDev())
-                            + "), error: " + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + ")\n";
+                            + "), error: " + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + ")"
+                            + metricsToString(*testIter, false) + "\n";
                     }
                     else {
                         outputString += (*testIter)->get_test_identifier()
@@ -342,7 +393,8 @@ public:
                 outputString +=  (*testIter)->get_test_identifier()
                     + " Elapsed: " + std::to_string((unsigned long long) (*testIter)->stats.getAverage())
                     + " (dev: " + std::to_string((unsigned long long) (*testIter)->stats.getStdDev())
-                    + "), error: " + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + ")\n";
+                    + "), error: " + std::to_string((*testIter)->error_norm_bignum.ToDouble()) + ")"
+                    + metricsToString(*testIter, false) + "\n";
             }
             else {
                 outputString += (*testIter)->get_test_identifier()
@@ -0,0 +1,235 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_REDUCED_PRECISION_H_
+#define UME_REDUCED_PRECISION_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <umesimd/UMESimd.h>
+
+// Storage-only reduced precision types. Values are kept in memory in 16 bits and
+// are converted to 'float' before any arithmetic, so all accumulation is done
+// in single precision.
+//
+//  - float16_t: IEEE 754 binary16 (1 sign, 5 exponent, 10 mantissa bits)
+//  - bfloat16_t: upper half of IEEE 754 binary32 (1 sign, 8 exponent, 7 mantissa bits)
+struct float16_t {
+    uint16_t bits;
+};
+
+struct bfloat16_t {
+    uint16_t bits;
+};
+
+// Number of elements converted at once by the kernels working on reduced precision
+// data. Converted tiles are kept in small 'float' buffers, which stay in L1 cache.
+static const int REDUCED_PRECISION_TILE = 256;
+
+// Conversions between 'float' and STORAGE_T. Benchmarks using reduced storage
+// convert the 'float' input of their base test into STORAGE_T and keep the
+// original for verification, so the reported error is the total cost of reduced
+// storage (rounding of the inputs plus rounding of any stored result).
+template<typename STORAGE_T>
+struct ReducedPrecision;
+
+template<>
+struct ReducedPrecision<float16_t> {
+    static std::string name() { return "fp16"; }
+
+    static UME_FORCE_INLINE float to_float(float16_t h) {
+        uint32_t sign = uint32_t(h.bits & 0x8000) << 16;
+        uint32_t exponent = (h.bits >> 10) & 0x1F;
+        uint32_t mantissa = h.bits & 0x3FF;
+        uint32_t bits;
+
+        if (exponent == 0) {
+            // Zero or subnormal: value is mantissa * 2^-24, which is exact in 'float'.
+            float value = float(mantissa) * 5.9604644775390625e-8f;
+            memcpy(&bits, &value, sizeof(bits));
+            bits |= sign;
+        }
+        else if (exponent == 0x1F) {
+            // Infinity or NaN. NaNs are returned quiet, as by hardware conversion.
+            bits = sign | 0x7F800000 | (mantissa << 13) | (mantissa ? 0x00400000 : 0);
+        }
+        else {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float retval;
+        memcpy(&retval, &bits, sizeof(retval));
+        return retval;
+    }
+
+    // Round to nearest, ties to even.
+    static UME_FORCE_INLINE float16_t from_float(float f) {
+        uint32_t x;
+        memcpy(&x, &f, sizeof(x));
+        uint16_t sign = uint16_t((x >> 16) & 0x8000);
+        uint32_t abs_x = x & 0x7FFFFFFF;
+        float16_t retval;
+
+        if (abs_x >= 0x7F800000) {
+            // Infinity or NaN. NaNs are kept quiet.
+            retval.bits = sign | 0x7C00 | (abs_x > 0x7F800000 ? (0x0200 | ((abs_x >> 13) & 0x3FF)) : 0);
+        }
+        else if (abs_x >= 0x477FF000) {
+            // Values larger than the largest half, after rounding, overflow to infinity.
+            retval.bits = sign | 0x7C00;
+        }
+        else if (abs_x >= 0x38800000) {
+            // Normal half
+            uint32_t h = (abs_x >> 13) - (112 << 10);
+            uint32_t remainder = abs_x & 0x1FFF;
+            if (remainder > 0x1000 || (remainder == 0x1000 && (h & 1))) h++;
+            retval.bits = sign | uint16_t(h);
+        }
+        else if (abs_x >= 0x33000000) {
+            // Subnormal half. Rounding can produce the smallest normal, which is
+            // encoded correctly by the carry into the exponent field.
+            uint32_t mantissa = (abs_x & 0x7FFFFF) | 0x800000;
+            int shift = 126 - int(abs_x >> 23);
+            uint32_t h = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (h & 1))) h++;
+            retval.bits = sign | uint16_t(h);
+        }
+        else {
+            retval.bits = sign;
+        }
+        return retval;
+    }
+
+    static UME_FORCE_INLINE void convert_to_float(int count, float16_t const *src, float *dst) {
+        int i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= count; i += 16) {
+            _mm512_storeu_ps(&dst[i], _mm512_cvtph_ps(_mm256_loadu_si256((__m256i const *)&src[i])));
+        }
+#endif
+#if defined(__F16C__)
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(&dst[i], _mm256_cvtph_ps(_mm_loadu_si128((__m128i const *)&src[i])));
+        }
+#endif
+        for (; i < count; i++) dst[i] = to_float(src[i]);
+    }
+
+    static UME_FORCE_INLINE void convert_from_float(int count, float const *src, float16_t *dst) {
+        int i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= count; i += 16) {
+            _mm256_storeu_si256((__m256i *)&dst[i], _mm512_cvtps_ph(_mm512_loadu_ps(&src[i]), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+        }
+#endif
+#if defined(__F16C__)
+        for (; i + 8 <= count; i += 8) {
+            _mm_storeu_si128((__m128i *)&dst[i], _mm256_cvtps_ph(_mm256_loadu_ps(&src[i]), _MM_FROUND_TO_NEAREST_INT));
+        }
+#endif
+        for (; i < count; i++) dst[i] = from_float(src[i]);
+    }
+};
+
+template<>
+struct ReducedPrecision<bfloat16_t> {
+    static std::string name() { return "bf16"; }
+
+    static UME_FORCE_INLINE float to_float(bfloat16_t b) {
+        uint32_t bits = uint32_t(b.bits) << 16;
+        float retval;
+        memcpy(&retval, &bits, sizeof(retval));
+        return retval;
+    }
+
+    // Round to nearest, ties to even.
+    static UME_FORCE_INLINE bfloat16_t from_float(float f) {
+        uint32_t x;
+        memcpy(&x, &f, sizeof(x));
+        bfloat16_t retval;
+        if ((x & 0x7FFFFFFF) > 0x7F800000) {
+            // NaN: truncate and keep it quiet, rounding could turn it into infinity.
+            retval.bits = uint16_t((x >> 16) | 0x0040);
+        }
+        else {
+            retval.bits = uint16_t((x + 0x7FFF + ((x >> 16) & 1)) >> 16);
+        }
+        return retval;
+    }
+
+    static UME_FORCE_INLINE void convert_to_float(int count, bfloat16_t const *src, float *dst) {
+        int i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= count; i += 16) {
+            __m512i t0 = _mm512_cvtepu16_epi32(_mm256_loadu_si256((__m256i const *)&src[i]));
+            _mm512_storeu_si512(&dst[i], _mm512_slli_epi32(t0, 16));
+        }
+#endif
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8) {
+            __m256i t0 = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i const *)&src[i]));
+            _mm256_storeu_si256((__m256i *)&dst[i], _mm256_slli_epi32(t0, 16));
+        }
+#endif
+        for (; i < count; i++) dst[i] = to_float(src[i]);
+    }
+
+    static UME_FORCE_INLINE void convert_from_float(int count, float const *src, bfloat16_t *dst) {
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i bias = _mm256_set1_epi32(0x7FFF);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i quiet = _mm256_set1_epi32(0x00400000);
+        for (; i + 8 <= count; i += 8) {
+            __m256 v = _mm256_loadu_ps(&src[i]);
+            __m256i x = _mm256_castps_si256(v);
+            __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), one);
+            __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(x, _mm256_add_epi32(bias, lsb)), 16);
+            __m256i nan = _mm256_srli_epi32(_mm256_or_si256(x, quiet), 16);
+            __m256i nan_mask = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+            __m256i t0 = _mm256_blendv_epi8(rounded, nan, nan_mask);
+            // Pack 32-bit lanes to 16 bits. Packing works within 128-bit halves,
+            // so the 64-bit blocks have to be reordered afterwards.
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(t0, t0), 0xD8);
+            _mm_storeu_si128((__m128i *)&dst[i], _mm256_castsi256_si128(packed));
+        }
+#endif
+        for (; i < count; i++) dst[i] = from_float(src[i]);
+    }
+};
+
+#endif
@@ -0,0 +1,153 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_SIMD_FUSED_AXPY_H_
+#define UME_SIMD_FUSED_AXPY_H_
+
+#include <stdint.h>
+
+#if defined(__SSE__) || defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__)
+#include <immintrin.h>
+#define UME_FUSED_AXPY_STREAMING_STORES
+#endif
+
+#include <umesimd/UMESimd.h>
+
+// Non-temporal copy of 'count' elements. 'dst' has to be aligned to 64 bytes for the
+// streaming path to be used, otherwise regular stores are issued. Call 'fence'
+// after the last copy, before the data is consumed by other threads.
+template<typename FLOAT_T>
+struct StreamingStore {
+    static UME_FORCE_INLINE void copy(FLOAT_T *dst, FLOAT_T const *src, int count) {
+        for (int i = 0; i < count; i++) dst[i] = src[i];
+    }
+    static UME_FORCE_INLINE void fence() {}
+};
+
+#if defined(UME_FUSED_AXPY_STREAMING_STORES)
+template<>
+struct StreamingStore<float> {
+    static UME_FORCE_INLINE void copy(float *dst, float const *src, int count) {
+        int i = 0;
+        if ((reinterpret_cast<uintptr_t>(dst) & 63) == 0 && (reinterpret_cast<uintptr_t>(src) & 63) == 0) {
+#if defined(__AVX512F__)
+            for (; i + 16 <= count; i += 16) _mm512_stream_ps(&dst[i], _mm512_load_ps(&src[i]));
+#elif defined(__AVX__)
+            for (; i + 8 <= count; i += 8) _mm256_stream_ps(&dst[i], _mm256_load_ps(&src[i]));
+#else
+            for (; i + 4 <= count; i += 4) _mm_stream_ps(&dst[i], _mm_load_ps(&src[i]));
+#endif
+        }
+        for (; i < count; i++) dst[i] = src[i];
+    }
+    static UME_FORCE_INLINE void fence() { _mm_sfence(); }
+};
+
+#if defined(__SSE2__) || defined(__AVX__) || defined(__AVX512F__)
+template<>
+struct StreamingStore<double> {
+    static UME_FORCE_INLINE void copy(double *dst, double const *src, int count) {
+        int i = 0;
+        if ((reinterpret_cast<uintptr_t>(dst) & 63) == 0 && (reinterpret_cast<uintptr_t>(src) & 63) == 0) {
+#if defined(__AVX512F__)
+            for (; i + 8 <= count; i += 8) _mm512_stream_pd(&dst[i], _mm512_load_pd(&src[i]));
+#elif defined(__AVX__)
+            for (; i + 4 <= count; i += 4) _mm256_stream_pd(&dst[i], _mm256_load_pd(&src[i]));
+#else
+            for (; i + 2 <= count; i += 2) _mm_stream_pd(&dst[i], _mm_load_pd(&src[i]));
+#endif
+        }
+        for (; i < count; i++) dst[i] = src[i];
+    }
+    static UME_FORCE_INLINE void fence() { _mm_sfence(); }
+};
+#endif
+#endif
+
+// Fused, cache-tiled evaluation of a chain of AXPY updates:
+//
+//     y = y + alpha[0] * x[0] + alpha[1] * x[1] + ... + alpha[count-1] * x[count-1]
+//
+// The range is processed in tiles of TILE_BYTES bytes. A tile of 'y' is copied into an
+// L1 resident buffer, all 'count' updates are applied to that buffer, one input
+// vector at a time, and the result is written back to 'y' using non-temporal stores.
+// Only two streams (the tile and a single 'x') are active at any time, regardless of
+// the chain length, and 'y' is read and written only once.
+//
+// Updates are applied in the same order as 'count' consecutive AXPY calls.
+template<typename FLOAT_T, int STRIDE, int TILE_BYTES = 8192>
+class UMESimdFusedAxpy {
+public:
+    static const int TILE_SIZE = TILE_BYTES / sizeof(FLOAT_T);
+    static_assert(TILE_SIZE % STRIDE == 0, "Tile size has to be a multiple of STRIDE");
+
+    static UME_NEVER_INLINE void apply(int N, int count, FLOAT_T const *alpha, FLOAT_T const * const *x, FLOAT_T *y) {
+        typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> VEC_T;
+
+        alignas(64) FLOAT_T tile[TILE_SIZE];
+
+        for (int t0 = 0; t0 < N; t0 += TILE_SIZE) {
+            int length = (N - t0) < TILE_SIZE ? (N - t0) : TILE_SIZE;
+            int LOOP_PEEL_OFFSET = (length / STRIDE) * STRIDE;
+
+            for (int i = 0; i < length; i++) tile[i] = y[t0 + i];
+
+            for (int k = 0; k < count; k++) {
+                FLOAT_T const *x_tile = &x[k][t0];
+                VEC_T x_vec, y_vec;
+                for (int i = 0; i < LOOP_PEEL_OFFSET; i += STRIDE) {
+                    // Tiles are aligned only if all input vectors are aligned.
+                    x_vec.load(&x_tile[i]);
+                    y_vec.loada(&tile[i]);
+                    y_vec = x_vec.fmuladd(VEC_T(alpha[k]), y_vec);
+                    y_vec.storea(&tile[i]);
+                }
+                for (int i = LOOP_PEEL_OFFSET; i < length; i++) {
+                    tile[i] += alpha[k] * x_tile[i];
+                }
+            }
+
+            StreamingStore<FLOAT_T>::copy(&y[t0], tile, length);
+        }
+        StreamingStore<FLOAT_T>::fence();
+    }
+
+    // Memory traffic of the fused evaluation: every 'x' and 'y' read once, 'y' written once.
+    static uint64_t bytes_moved(int N, int count) {
+        return uint64_t(count + 2) * uint64_t(N) * sizeof(FLOAT_T);
+    }
+
+    // Memory traffic of 'count' separate AXPY passes over vectors not fitting in cache:
+    // every pass reads 'x' and 'y' and writes 'y' back.
+    static uint64_t naive_bytes_moved(int N, int count) {
+        return 3 * uint64_t(count) * uint64_t(N) * sizeof(FLOAT_T);
+    }
+};
+
+#endif
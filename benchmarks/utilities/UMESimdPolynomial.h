@@ -0,0 +1,275 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_SIMD_POLYNOMIAL_H_
+#define UME_SIMD_POLYNOMIAL_H_
+
+#include <umesimd/UMESimd.h>
+
+// Evaluation of polynomials of compile-time degree on any SIMDVec type:
+//
+//     y(x) = c[0] + c[1]*x + c[2]*x^2 + ... + c[DEGREE]*x^DEGREE
+//
+// Both schedules are fully unrolled at compile time.
+//
+// Horner's scheme uses DEGREE FMAs, but every one of them depends on the previous one.
+//
+// Estrin's scheme splits the coefficients at the largest power of 2, 2^k, below their
+// count: y(x) = low(x) + x^(2^k) * high(x), and evaluates both halves the same way.
+// Pairs of coefficients become independent FMAs (c[i] + c[i+1]*x) and only
+// ceil(log2(DEGREE + 1)) levels of FMAs remain, at the cost of computing
+// x^2, x^4, ..., x^(2^k) (k multiplications).
+
+enum PolynomialScheme {
+    POLYNOMIAL_HORNER,
+    POLYNOMIAL_ESTRIN,
+    // Horner for degrees below ESTRIN_MIN_DEGREE, where the dependency chain is
+    // not longer than Estrin's enough to pay for computing powers of x.
+    POLYNOMIAL_AUTO
+};
+
+static const int ESTRIN_MIN_DEGREE = 4;
+
+// Largest power of 2 lower than 'count', for 'count' > 1
+constexpr int estrin_split(int count, int half = 1) {
+    return 2 * half < count ? estrin_split(count, 2 * half) : half;
+}
+
+constexpr int estrin_log2(int value) {
+    return value <= 1 ? 0 : 1 + estrin_log2(value / 2);
+}
+
+// Sources of coefficients for the schedules: 'c[i]' returns coefficient 'i' as a vector.
+
+// Single polynomial, coefficient broadcast to all lanes
+template<typename VEC_T>
+struct SharedCoefficients {
+    typedef typename UME::SIMD::SIMDTraits<VEC_T>::SCALAR_T SCALAR_T;
+    SCALAR_T const *c;
+
+    SharedCoefficients(SCALAR_T const *c) : c(c) {}
+    UME_FORCE_INLINE VEC_T operator[] (int i) const { return VEC_T(c[i]); }
+};
+
+// Polynomial per lane, coefficients stored coefficient-major: lane 'l' of coefficient
+// 'i' at c[i * ld + l]. 'c' and 'ld' have to keep every row aligned for VEC_T.
+template<typename VEC_T>
+struct LaneCoefficients {
+    typedef typename UME::SIMD::SIMDTraits<VEC_T>::SCALAR_T SCALAR_T;
+    SCALAR_T const *c;
+    int ld;
+
+    LaneCoefficients(SCALAR_T const *c, int ld) : c(c), ld(ld) {}
+    UME_FORCE_INLINE VEC_T operator[] (int i) const {
+        VEC_T t0;
+        t0.loada(&c[i * ld]);
+        return t0;
+    }
+};
+
+// acc * x^INDEX + c[INDEX - 1] * x^(INDEX - 1) + ... + c[0]
+template<typename VEC_T, int INDEX>
+struct HornerSchedule {
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T evaluate(VEC_T const & x, VEC_T const & acc, COEFFS_T const & c) {
+        return HornerSchedule<VEC_T, INDEX - 1>::evaluate(x, acc.fmuladd(x, c[INDEX - 1]), c);
+    }
+};
+
+template<typename VEC_T>
+struct HornerSchedule<VEC_T, 0> {
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T evaluate(VEC_T const &, VEC_T const & acc, COEFFS_T const &) {
+        return acc;
+    }
+};
+
+// c[BEGIN] + c[BEGIN + 1] * x + ... + c[BEGIN + COUNT - 1] * x^(COUNT - 1),
+// with powers[k] = x^(2^k)
+template<typename VEC_T, int BEGIN, int COUNT>
+struct EstrinSchedule {
+    static const int HALF = estrin_split(COUNT);
+
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T evaluate(VEC_T const *powers, COEFFS_T const & c) {
+        VEC_T low = EstrinSchedule<VEC_T, BEGIN, HALF>::evaluate(powers, c);
+        VEC_T high = EstrinSchedule<VEC_T, BEGIN + HALF, COUNT - HALF>::evaluate(powers, c);
+        return powers[estrin_log2(HALF)].fmuladd(high, low);
+    }
+};
+
+template<typename VEC_T, int BEGIN>
+struct EstrinSchedule<VEC_T, BEGIN, 2> {
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T evaluate(VEC_T const *powers, COEFFS_T const & c) {
+        return powers[0].fmuladd(c[BEGIN + 1], c[BEGIN]);
+    }
+};
+
+template<typename VEC_T, int BEGIN>
+struct EstrinSchedule<VEC_T, BEGIN, 1> {
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T evaluate(VEC_T const *, COEFFS_T const & c) {
+        return c[BEGIN];
+    }
+};
+
+// Coefficients are stored as scalars and broadcast at use, so objects can be
+// allocated anywhere, regardless of the alignment required by VEC_T.
+template<typename VEC_T, int DEGREE, int SCHEME = POLYNOMIAL_AUTO>
+class UMESimdPolynomial {
+public:
+    typedef typename UME::SIMD::SIMDTraits<VEC_T>::SCALAR_T SCALAR_T;
+
+    static_assert(DEGREE >= 0, "Polynomial degree has to be non-negative");
+
+    static const bool USE_ESTRIN = (SCHEME == POLYNOMIAL_ESTRIN) ||
+        (SCHEME == POLYNOMIAL_AUTO && DEGREE >= ESTRIN_MIN_DEGREE);
+
+    // Number of powers x^(2^k) used by Estrin's scheme
+    static const int POWERS = DEGREE > 0 ? estrin_log2(estrin_split(DEGREE + 1)) + 1 : 1;
+
+private:
+    SCALAR_T c[DEGREE + 1];
+
+public:
+    UMESimdPolynomial(SCALAR_T const *coeffs) {
+        for (int i = 0; i <= DEGREE; i++) c[i] = coeffs[i];
+    }
+
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T horner(VEC_T const & x, COEFFS_T const & coeffs) {
+        return HornerSchedule<VEC_T, DEGREE>::evaluate(x, coeffs[DEGREE], coeffs);
+    }
+
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T estrin(VEC_T const & x, COEFFS_T const & coeffs) {
+        VEC_T powers[POWERS];
+        powers[0] = x;
+        for (int k = 1; k < POWERS; k++) powers[k] = powers[k - 1] * powers[k - 1];
+        return EstrinSchedule<VEC_T, 0, DEGREE + 1>::evaluate(powers, coeffs);
+    }
+
+    // Evaluation with the schedule selected by SCHEME, for any source of coefficients
+    template<typename COEFFS_T>
+    static UME_FORCE_INLINE VEC_T schedule(VEC_T const & x, COEFFS_T const & coeffs) {
+        return USE_ESTRIN ? estrin(x, coeffs) : horner(x, coeffs);
+    }
+
+    UME_FORCE_INLINE VEC_T evaluate(VEC_T const & x) const {
+        return schedule(x, SharedCoefficients<VEC_T>(c));
+    }
+
+    SCALAR_T coefficient(int i) const { return c[i]; }
+
+    static char const * scheme_name() {
+        return USE_ESTRIN ? "Estrin" : "Horner";
+    }
+};
+
+// Set of 'count' polynomials of the same DEGREE, e.g. calibration curves of detector
+// channels. Polynomials are evaluated STRIDE at a time, one per SIMD lane, so their
+// coefficients are stored transposed (coefficient-major): coefficient 'i' of
+// polynomial 'p' at coeffs[i * ld + p], with 'ld' padded to a multiple of STRIDE.
+// A single SIMD load then fetches the same coefficient of STRIDE polynomials.
+template<typename FLOAT_T, int STRIDE, int DEGREE, int SCHEME = POLYNOMIAL_AUTO>
+class UMESimdPolynomialBank {
+private:
+    typedef UME::SIMD::SIMDVec<FLOAT_T, STRIDE> FLOAT_VEC_T;
+    typedef UMESimdPolynomial<FLOAT_VEC_T, DEGREE, SCHEME> POLYNOMIAL_T;
+
+    int count;
+    int ld;
+    FLOAT_T *coeffs;
+
+    // Polynomials not filling a whole vector
+    UME_FORCE_INLINE FLOAT_T horner_scalar(int p, FLOAT_T x) const {
+        FLOAT_T acc = coeffs[DEGREE * ld + p];
+        for (int k = DEGREE - 1; k >= 0; k--) {
+            acc = acc * x + coeffs[k * ld + p];
+        }
+        return acc;
+    }
+
+public:
+    // 'coeffs_aos' holds DEGREE + 1 consecutive coefficients (lowest power first)
+    // of every polynomial.
+    UMESimdPolynomialBank(int count, FLOAT_T const *coeffs_aos) : count(count) {
+        ld = ((count + STRIDE - 1) / STRIDE) * STRIDE;
+        coeffs = (FLOAT_T *)UME::DynamicMemory::AlignedMalloc((DEGREE + 1) * ld * sizeof(FLOAT_T), FLOAT_VEC_T::alignment());
+        for (int k = 0; k <= DEGREE; k++) {
+            for (int p = 0; p < ld; p++) {
+                coeffs[k * ld + p] = (p < count) ? coeffs_aos[p * (DEGREE + 1) + k] : FLOAT_T(0);
+            }
+        }
+    }
+
+    ~UMESimdPolynomialBank() {
+        UME::DynamicMemory::AlignedFree(coeffs);
+    }
+
+    // y[p] = P_p(x), the same argument for all polynomials
+    void evaluate(FLOAT_T x, FLOAT_T *y) const {
+        FLOAT_VEC_T x_vec(x), y_vec;
+
+        int LOOP_PEEL_OFFSET = (count / STRIDE) * STRIDE;
+        for (int p = 0; p < LOOP_PEEL_OFFSET; p += STRIDE) {
+            y_vec = POLYNOMIAL_T::schedule(x_vec, LaneCoefficients<FLOAT_VEC_T>(&coeffs[p], ld));
+            y_vec.store(&y[p]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int p = LOOP_PEEL_OFFSET; p < count; p++) {
+            y[p] = horner_scalar(p, x);
+        }
+    }
+
+    // y[p] = P_p(x[p]), an argument per polynomial
+    void evaluate(FLOAT_T const *x, FLOAT_T *y) const {
+        FLOAT_VEC_T x_vec, y_vec;
+
+        int LOOP_PEEL_OFFSET = (count / STRIDE) * STRIDE;
+        for (int p = 0; p < LOOP_PEEL_OFFSET; p += STRIDE) {
+            x_vec.load(&x[p]);
+            y_vec = POLYNOMIAL_T::schedule(x_vec, LaneCoefficients<FLOAT_VEC_T>(&coeffs[p], ld));
+            y_vec.store(&y[p]);
+        }
+
+        // Use scalar code to handle the reminder of elements.
+        for (int p = LOOP_PEEL_OFFSET; p < count; p++) {
+            y[p] = horner_scalar(p, x[p]);
+        }
+    }
+
+    static char const * scheme_name() {
+        return POLYNOMIAL_T::scheme_name();
+    }
+};
+
+#endif
@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016 CERN
+//
+// Author: Przemyslaw Karpinski
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//
+//  This piece of code was developed as part of ICE-DIP project at CERN.
+//  "ICE-DIP is a European Industrial Doctorate project funded by the European Community's
+//  7th Framework programme Marie Curie Actions under grant PITN-GA-2012-316596".
+//
+#ifndef UME_THREAD_PINNING_H_
+#define UME_THREAD_PINNING_H_
+
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// Pins the threads of OpenMP parallel regions of 'threadCount' threads to separate
+// CPUs for the lifetime of the object, e.g. for all iterations of a test.
+//
+// CPUs are taken in order from the affinity mask of the creating thread, so that
+// restrictions set with 'taskset' or by cgroups are respected. With more threads than
+// allowed CPUs, threads wrap around. The creating thread is the master of every team,
+// so the original masks of all team threads are restored on destruction. This relies
+// on the runtime keeping the same threads for teams of the same size, as GNU and
+// Intel OpenMP runtimes do.
+//
+// Without OpenMP, outside of Linux, or when a mask cannot be read or set, threads are
+// left as they are and 'is_pinned()' returns false.
+class ThreadPinning {
+private:
+    int threadCount;
+    bool pinned;
+
+#if defined(__linux__)
+    std::vector<cpu_set_t> originalMasks;   // per thread
+    std::vector<char> saved;                // per thread, mask read successfully
+#endif
+
+    ThreadPinning(ThreadPinning const &) = delete;
+    ThreadPinning & operator= (ThreadPinning const &) = delete;
+
+public:
+    explicit ThreadPinning(int threadCount) : threadCount(threadCount), pinned(false) {
+#if defined(__linux__) && defined(_OPENMP)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (threadCount < 1 || sched_getaffinity(0, sizeof(cpu_set_t), &allowed) != 0) return;
+
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+        if (cpus.empty()) return;
+
+        originalMasks.resize(threadCount);
+        saved.resize(threadCount, 0);
+
+        int failures = 0;
+        #pragma omp parallel num_threads(threadCount) reduction(+:failures)
+        {
+            int threadId = omp_get_thread_num();
+            if (sched_getaffinity(0, sizeof(cpu_set_t), &originalMasks[threadId]) == 0) {
+                saved[threadId] = 1;
+
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                CPU_SET(cpus[threadId % cpus.size()], &cpuSet);
+                if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuSet) != 0) failures++;
+            }
+            else {
+                failures++;
+            }
+        }
+        pinned = (failures == 0);
+#endif
+    }
+
+    ~ThreadPinning() {
+#if defined(__linux__) && defined(_OPENMP)
+        if (saved.empty()) return;
+
+        #pragma omp parallel num_threads(threadCount)
+        {
+            int threadId = omp_get_thread_num();
+            if (saved[threadId]) sched_setaffinity(0, sizeof(cpu_set_t), &originalMasks[threadId]);
+        }
+#endif
+    }
+
+    bool is_pinned() const { return pinned; }
+
+    int thread_count() const { return threadCount; }
+};
+
+#endif